@@ -0,0 +1,129 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "RecursiveSharedMutex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace tools {
+
+namespace {
+
+// Shared recursion depth of the current thread, per mutex
+thread_local std::vector<std::pair<const RecursiveSharedMutex*, size_t>> sharedDepths;
+
+size_t* findSharedDepth(const RecursiveSharedMutex* mutex) {
+  auto it = std::find_if(sharedDepths.begin(), sharedDepths.end(), [mutex](const std::pair<const RecursiveSharedMutex*, size_t>& entry) {
+    return entry.first == mutex;
+  });
+
+  return it == sharedDepths.end() ? nullptr : &it->second;
+}
+
+void forgetSharedDepth(const RecursiveSharedMutex* mutex) {
+  sharedDepths.erase(std::remove_if(sharedDepths.begin(), sharedDepths.end(), [mutex](const std::pair<const RecursiveSharedMutex*, size_t>& entry) {
+    return entry.first == mutex;
+  }), sharedDepths.end());
+}
+
+}
+
+RecursiveSharedMutex::RecursiveSharedMutex() : m_exclusiveDepth(0), m_readers(0), m_waitingWriters(0) {
+}
+
+void RecursiveSharedMutex::lock() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_exclusiveDepth != 0 && m_owner == std::this_thread::get_id()) {
+    ++m_exclusiveDepth;
+    return;
+  }
+
+  if (findSharedDepth(this) != nullptr) {
+    // the thread would wait for its own shared ownership forever
+    throw std::logic_error("RecursiveSharedMutex: shared ownership can't be upgraded to exclusive ownership");
+  }
+
+  ++m_waitingWriters;
+  m_condition.wait(lock, [this] { return m_exclusiveDepth == 0 && m_readers == 0; });
+  --m_waitingWriters;
+  m_owner = std::this_thread::get_id();
+  m_exclusiveDepth = 1;
+}
+
+bool RecursiveSharedMutex::try_lock() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_exclusiveDepth != 0) {
+    if (m_owner != std::this_thread::get_id()) {
+      return false;
+    }
+
+    ++m_exclusiveDepth;
+    return true;
+  }
+
+  if (m_readers != 0) {
+    return false;
+  }
+
+  m_owner = std::this_thread::get_id();
+  m_exclusiveDepth = 1;
+  return true;
+}
+
+void RecursiveSharedMutex::unlock() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  assert(m_exclusiveDepth != 0 && m_owner == std::this_thread::get_id());
+  if (--m_exclusiveDepth == 0) {
+    m_owner = std::thread::id();
+    m_condition.notify_all();
+  }
+}
+
+void RecursiveSharedMutex::lock_shared() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_exclusiveDepth != 0 && m_owner == std::this_thread::get_id()) {
+    ++m_exclusiveDepth;
+    return;
+  }
+
+  size_t* depth = findSharedDepth(this);
+  if (depth != nullptr) {
+    ++*depth;
+    return;
+  }
+
+  m_condition.wait(lock, [this] { return m_exclusiveDepth == 0 && m_waitingWriters == 0; });
+  ++m_readers;
+  sharedDepths.emplace_back(this, 1);
+}
+
+void RecursiveSharedMutex::unlock_shared() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_exclusiveDepth != 0 && m_owner == std::this_thread::get_id()) {
+    if (--m_exclusiveDepth == 0) {
+      m_owner = std::thread::id();
+      m_condition.notify_all();
+    }
+
+    return;
+  }
+
+  size_t* depth = findSharedDepth(this);
+  assert(depth != nullptr);
+  if (--*depth != 0) {
+    return;
+  }
+
+  forgetSharedDepth(this);
+  if (--m_readers == 0) {
+    m_condition.notify_all();
+  }
+}
+
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace tools {
+
+// Shared/exclusive mutex where both sides may be re-entered by the thread that holds them.
+// The exclusive owner may also take shared ownership, which just deepens its exclusive ownership.
+// Waiting writers block new readers, but not nested shared locks of threads that already read.
+// Upgrading shared ownership to exclusive ownership is not supported, lock() throws std::logic_error instead.
+class RecursiveSharedMutex {
+public:
+  RecursiveSharedMutex();
+  RecursiveSharedMutex(const RecursiveSharedMutex&) = delete;
+  RecursiveSharedMutex& operator=(const RecursiveSharedMutex&) = delete;
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+  void lock_shared();
+  void unlock_shared();
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::thread::id m_owner;
+  size_t m_exclusiveDepth;
+  size_t m_readers;
+  size_t m_waitingWriters;
+};
+
+}
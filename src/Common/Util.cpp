@@ -17,7 +17,9 @@
 #include <shlobj.h>
 #include <strsafe.h>
 #else 
+#include <fcntl.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 #endif
 #pragma warning(disable : 4996)
 
@@ -349,6 +351,31 @@ std::string get_nix_version_display_string()
     return std::error_code(code, std::system_category());
   }
 
+  bool sync_file(const std::string& path)
+  {
+#if defined(WIN32)
+    HANDLE file = ::CreateFile(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      return false;
+    }
+
+    bool ok = ::FlushFileBuffers(file) != 0;
+    ::CloseHandle(file);
+    return ok;
+#else
+    int file = ::open(path.c_str(), O_WRONLY);
+    if (file == -1)
+    {
+      return false;
+    }
+
+    bool ok = ::fsync(file) == 0;
+    ::close(file);
+    return ok;
+#endif
+  }
+
   bool directoryExists(const std::string& path) {
     boost::system::error_code ec;
     return boost::filesystem::is_directory(path, ec);
@@ -16,5 +16,7 @@ namespace tools
   std::string get_os_version_string();
   bool create_directories_if_necessary(const std::string& path);
   std::error_code replace_file(const std::string& replacement_name, const std::string& replaced_name);
+  // Makes the written contents of the file durable, false if it can not be opened or synced
+  bool sync_file(const std::string& path);
   bool directoryExists(const std::string& path);
 }
@@ -0,0 +1,126 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "WorkerPool.h"
+
+namespace tools {
+
+WorkerPool::WorkerPool(size_t workerCount) :
+  m_job(nullptr),
+  m_count(0),
+  m_next(0),
+  m_pending(0),
+  m_stopped(false) {
+  m_workers.reserve(workerCount);
+  for (size_t i = 0; i < workerCount; ++i) {
+    m_workers.emplace_back(&WorkerPool::workerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stopped = true;
+    m_haveJobs.notify_all();
+  }
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+size_t WorkerPool::workerCount() const {
+  return m_workers.size();
+}
+
+size_t WorkerPool::defaultWorkerCount() {
+  unsigned hardwareThreads = std::thread::hardware_concurrency();
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& job) {
+  if (count == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> batchLock(m_batchMutex);
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_job = &job;
+  m_count = count;
+  m_next = 0;
+  m_pending = count;
+  m_error = nullptr;
+  m_haveJobs.notify_all();
+
+  runJobs(lock);
+  m_batchDone.wait(lock, [this] { return m_pending == 0; });
+
+  m_job = nullptr;
+  std::exception_ptr error = m_error;
+  m_error = nullptr;
+  lock.unlock();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkerPool::post(std::function<void()>&& job) {
+  if (m_workers.empty()) {
+    job();
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_queue.push(std::move(job));
+  m_haveJobs.notify_one();
+}
+
+void WorkerPool::workerLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_haveJobs.wait(lock, [this] { return m_stopped || !m_queue.empty() || (m_job != nullptr && m_next < m_count); });
+    if (!m_queue.empty()) {
+      std::function<void()> job = std::move(m_queue.front());
+      m_queue.pop();
+      lock.unlock();
+      job();
+      lock.lock();
+      continue;
+    }
+
+    if (m_stopped) {
+      return;
+    }
+
+    runJobs(lock);
+  }
+}
+
+void WorkerPool::runJobs(std::unique_lock<std::mutex>& lock) {
+  while (m_job != nullptr && m_next < m_count) {
+    const std::function<void(size_t)>& job = *m_job;
+    size_t index = m_next++;
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      job(index);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    if (error && !m_error) {
+      m_error = error;
+    }
+
+    if (--m_pending == 0) {
+      m_batchDone.notify_all();
+    }
+  }
+}
+
+}
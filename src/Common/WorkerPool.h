@@ -0,0 +1,59 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace tools {
+
+// Fixed set of threads that run batches of independent jobs and single queued jobs
+class WorkerPool {
+public:
+  explicit WorkerPool(size_t workerCount);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  size_t workerCount() const;
+
+  // Calls job(i) for every i in [0, count) on the workers and the calling thread, and returns once all calls are done.
+  // The first exception thrown by a job is rethrown here. Jobs must not call parallelFor on the same pool.
+  void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+  // Queues a job for the next free worker and returns at once. Jobs must not throw, the ones queued
+  // before destruction still run. Without workers the job runs on the calling thread.
+  void post(std::function<void()>&& job);
+
+  // One worker per hardware thread besides the caller
+  static size_t defaultWorkerCount();
+
+private:
+  void workerLoop();
+  void runJobs(std::unique_lock<std::mutex>& lock);
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_batchMutex;
+  std::mutex m_mutex;
+  std::condition_variable m_haveJobs;
+  std::condition_variable m_batchDone;
+  std::queue<std::function<void()>> m_queue;
+  const std::function<void(size_t)>* m_job;
+  size_t m_count;
+  size_t m_next;
+  size_t m_pending;
+  std::exception_ptr m_error;
+  bool m_stopped;
+};
+
+}
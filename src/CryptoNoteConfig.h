@@ -170,8 +170,13 @@ namespace cn
 
 	const size_t BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT = 10000; // by default, blocks ids count in synchronizing
 	const size_t BLOCKS_SYNCHRONIZING_DEFAULT_COUNT = 128;		 // by default, blocks count in blocks downloading
+	const size_t BLOCKS_SYNCHRONIZING_COMMIT_QUEUE_SIZE = 2;	 // parsed blocks batches of all the connections waiting to be committed
+	const size_t BLOCKS_CACHE_DEFAULT_SIZE = 1024;				 // by default, decoded blocks kept in memory by the block storage
+	const size_t RING_SIGNATURE_CACHE_SIZE = 20000;				 // transactions whose verified ring signatures are remembered
+	const uint32_t BLOCKCHAIN_CACHE_COMPACTION_INTERVAL = 10000;	 // blocks pushed or popped before the blockchain cache snapshot is rewritten
 	const size_t COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT = 1000;
     const size_t COMMAND_RPC_GET_OBJECTS_MAX_COUNT = 1000;
+	const size_t COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES_MAX_COUNT = 1000;
 
 	const int P2P_DEFAULT_PORT = 15000;
 	const int RPC_DEFAULT_PORT = 16000;
@@ -192,6 +197,14 @@ namespace cn
 	// This defines the minimum P2P version required for lite blocks propogation
 	const uint8_t P2P_LITE_BLOCKS_PROPOGATION_VERSION = 3;
 
+	// Optional features advertised in the handshake, a feature is used on a connection only when both nodes support it
+	const uint32_t P2P_SUPPORT_FLAG_TX_ANNOUNCE = 0x01;
+	const uint32_t P2P_TX_ANNOUNCE_INTERVAL = 250;    // milliseconds between announcements of accepted transaction hashes
+	const size_t P2P_TX_ANNOUNCE_MAX_COUNT = 1000;    // hashes per announcement or request
+	const uint32_t P2P_TX_REQUEST_TIMEOUT = 10;       // seconds before an announced transaction may be requested from another peer
+	const size_t P2P_TX_REQUEST_MAX_COUNT = 50000;    // announced transactions awaited at once, further announcements are dropped
+	const size_t P2P_TX_REQUEST_MAX_COUNT_PER_PEER = 5000; // announced transactions awaited at once from a single peer
+
 	const size_t P2P_LOCAL_WHITE_PEERLIST_LIMIT = 1000;
 	const size_t P2P_LOCAL_GRAY_PEERLIST_LIMIT = 5000;
 
@@ -0,0 +1,50 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "AmountOutputs.h"
+
+#include <stdexcept>
+
+#include "Serialization/SerializationOverloads.h"
+
+namespace cn
+{
+  uint32_t AmountOutputs::push(uint32_t block, uint16_t transaction, uint16_t output, const crypto::PublicKey& key, uint64_t unlockTime) {
+    m_blocks.push_back(block);
+    m_transactions.push_back(transaction);
+    m_outputs.push_back(output);
+    m_keys.push_back(key);
+    m_unlockTimes.push_back(unlockTime);
+    return static_cast<uint32_t>(m_blocks.size() - 1);
+  }
+
+  void AmountOutputs::pop() {
+    m_blocks.pop_back();
+    m_transactions.pop_back();
+    m_outputs.pop_back();
+    m_keys.pop_back();
+    m_unlockTimes.pop_back();
+  }
+
+  size_t AmountOutputs::memoryUsage() const {
+    return sizeof(*this) + m_blocks.capacity() * sizeof(uint32_t) + m_transactions.capacity() * sizeof(uint16_t) +
+      m_outputs.capacity() * sizeof(uint16_t) + m_keys.capacity() * sizeof(crypto::PublicKey) + m_unlockTimes.capacity() * sizeof(uint64_t);
+  }
+
+  void AmountOutputs::serialize(ISerializer& s) {
+    serializeAsBinary(m_blocks, "blocks", s);
+    serializeAsBinary(m_transactions, "transactions", s);
+    serializeAsBinary(m_outputs, "outputs", s);
+    serializeAsBinary(m_keys, "keys", s);
+    serializeAsBinary(m_unlockTimes, "unlock_times", s);
+
+    if (s.type() == ISerializer::INPUT) {
+      size_t count = m_blocks.size();
+      if (m_transactions.size() != count || m_outputs.size() != count || m_keys.size() != count || m_unlockTimes.size() != count) {
+        throw std::runtime_error("Inconsistent amount outputs columns");
+      }
+    }
+  }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "crypto/crypto.h"
+
+namespace cn
+{
+  class ISerializer;
+
+  // Key outputs of one amount in global index order. Every field is kept in its own packed column so
+  // resolving ring members and picking decoys reads the keys and unlock times without loading the
+  // transactions that created them.
+  class AmountOutputs {
+  public:
+    // returns the global index of the new output
+    uint32_t push(uint32_t block, uint16_t transaction, uint16_t output, const crypto::PublicKey& key, uint64_t unlockTime);
+    void pop();
+
+    size_t size() const { return m_blocks.size(); }
+    bool empty() const { return m_blocks.empty(); }
+
+    uint32_t block(size_t index) const { return m_blocks[index]; }
+    uint16_t transaction(size_t index) const { return m_transactions[index]; }
+    uint16_t output(size_t index) const { return m_outputs[index]; }
+    const crypto::PublicKey& key(size_t index) const { return m_keys[index]; }
+    uint64_t unlockTime(size_t index) const { return m_unlockTimes[index]; }
+
+    size_t memoryUsage() const;
+
+    void serialize(ISerializer& s);
+
+  private:
+    std::vector<uint32_t> m_blocks;
+    std::vector<uint16_t> m_transactions;
+    std::vector<uint16_t> m_outputs;
+    std::vector<crypto::PublicKey> m_keys;
+    std::vector<uint64_t> m_unlockTimes;
+  };
+}
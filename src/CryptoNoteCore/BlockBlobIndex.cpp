@@ -0,0 +1,93 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockBlobIndex.h"
+
+#include <stdexcept>
+
+#include "Serialization/SerializationOverloads.h"
+
+namespace cn
+{
+  void BlockBlobIndex::push(const Layout& layout) {
+    m_entrySizes.push_back(layout.entrySize);
+    m_blockSizes.push_back(layout.blockSize);
+    m_firstTransactions.push_back(static_cast<uint32_t>(m_transactionOffsets.size()));
+    for (const auto& transaction : layout.transactions) {
+      m_transactionOffsets.push_back(transaction.first);
+      m_transactionSizes.push_back(transaction.second);
+    }
+  }
+
+  void BlockBlobIndex::pop() {
+    m_transactionOffsets.resize(m_firstTransactions.back());
+    m_transactionSizes.resize(m_firstTransactions.back());
+    m_firstTransactions.pop_back();
+    m_blockSizes.pop_back();
+    m_entrySizes.pop_back();
+  }
+
+  void BlockBlobIndex::clear() {
+    m_entrySizes.clear();
+    m_blockSizes.clear();
+    m_firstTransactions.clear();
+    m_transactionOffsets.clear();
+    m_transactionSizes.clear();
+  }
+
+  void BlockBlobIndex::replace(uint32_t height, const Layout& layout) {
+    uint32_t first = m_firstTransactions[height];
+    uint32_t end = height + 1 < m_firstTransactions.size() ? m_firstTransactions[height + 1] : static_cast<uint32_t>(m_transactionOffsets.size());
+    if (end - first != layout.transactions.size()) {
+      throw std::runtime_error("BlockBlobIndex::replace");
+    }
+
+    m_entrySizes[height] = layout.entrySize;
+    m_blockSizes[height] = layout.blockSize;
+    for (uint32_t i = first; i < end; ++i) {
+      m_transactionOffsets[i] = layout.transactions[i - first].first;
+      m_transactionSizes[i] = layout.transactions[i - first].second;
+    }
+  }
+
+  bool BlockBlobIndex::split(uint32_t height, const std::string& entry, std::string& block, std::vector<std::string>& transactions) const {
+    if (height >= m_entrySizes.size() || entry.size() != m_entrySizes[height] || m_blockSizes[height] > entry.size()) {
+      return false;
+    }
+
+    uint32_t first = m_firstTransactions[height];
+    uint32_t end = height + 1 < m_firstTransactions.size() ? m_firstTransactions[height + 1] : static_cast<uint32_t>(m_transactionOffsets.size());
+    for (uint32_t i = first; i < end; ++i) {
+      if (static_cast<uint64_t>(m_transactionOffsets[i]) + m_transactionSizes[i] > entry.size()) {
+        return false;
+      }
+    }
+
+    block.assign(entry, 0, m_blockSizes[height]);
+    transactions.clear();
+    // the base transaction travels inside the block blob
+    for (uint32_t i = first + 1; i < end; ++i) {
+      transactions.emplace_back(entry, m_transactionOffsets[i], m_transactionSizes[i]);
+    }
+
+    return true;
+  }
+
+  void BlockBlobIndex::serialize(ISerializer& s) {
+    serializeAsBinary(m_entrySizes, "entry_sizes", s);
+    serializeAsBinary(m_blockSizes, "block_sizes", s);
+    serializeAsBinary(m_firstTransactions, "first_transactions", s);
+    serializeAsBinary(m_transactionOffsets, "transaction_offsets", s);
+    serializeAsBinary(m_transactionSizes, "transaction_sizes", s);
+
+    if (s.type() == ISerializer::INPUT) {
+      size_t count = m_entrySizes.size();
+      if (m_blockSizes.size() != count || m_firstTransactions.size() != count || m_transactionSizes.size() != m_transactionOffsets.size() ||
+          (count != 0 && m_firstTransactions.back() > m_transactionOffsets.size())) {
+        throw std::runtime_error("Inconsistent block blob index");
+      }
+    }
+  }
+}
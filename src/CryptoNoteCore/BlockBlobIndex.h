@@ -0,0 +1,50 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cn
+{
+  class ISerializer;
+
+  // Where the block blob and the transaction blobs lie inside each stored main chain block entry,
+  // indexed by height, so blocks can be served to peers and wallets by copying their stored bytes
+  class BlockBlobIndex {
+  public:
+    struct Layout {
+      uint32_t entrySize;
+      uint32_t blockSize;
+      // offset and size of every transaction blob, the base transaction first
+      std::vector<std::pair<uint32_t, uint32_t>> transactions;
+    };
+
+    void push(const Layout& layout);
+    void pop();
+    void clear();
+    // the entry was rewritten with the same transactions, only the offsets moved
+    void replace(uint32_t height, const Layout& layout);
+
+    size_t size() const { return m_entrySizes.size(); }
+
+    // Copies the block blob and the blobs of the transactions but the base one out of the stored
+    // entry bytes, false if they do not match the recorded layout
+    bool split(uint32_t height, const std::string& entry, std::string& block, std::vector<std::string>& transactions) const;
+
+    void serialize(ISerializer& s);
+
+  private:
+    std::vector<uint32_t> m_entrySizes;
+    std::vector<uint32_t> m_blockSizes;
+    // index of the first transaction of every block in the transaction columns
+    std::vector<uint32_t> m_firstTransactions;
+    std::vector<uint32_t> m_transactionOffsets;
+    std::vector<uint32_t> m_transactionSizes;
+  };
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockCacheJournal.h"
+
+#include "Common/Util.h"
+#include "CryptoNoteTools.h"
+#include "Serialization/ISerializer.h"
+
+namespace cn
+{
+  void BlockCacheJournal::Record::serialize(ISerializer& s) {
+    s(height, "height");
+    s(blockHash, "block_hash");
+    s.binary(block, "block");
+  }
+
+  bool BlockCacheJournal::open(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_filename = filename;
+    m_file.open(m_filename, std::ios::binary | std::ios::app);
+    return static_cast<bool>(m_file);
+  }
+
+  void BlockCacheJournal::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file.close();
+  }
+
+  bool BlockCacheJournal::append(const Record& record) {
+    BinaryArray payload;
+    if (!toBinaryArray(record, payload)) {
+      return false;
+    }
+
+    uint32_t size = static_cast<uint32_t>(payload.size());
+    crypto::Hash checksum = crypto::cn_fast_hash(payload.data(), payload.size());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.is_open()) {
+      return false;
+    }
+
+    m_file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    m_file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    m_file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    m_file.flush();
+    // a popped block is gone from the block storage, its record has to survive a crash
+    return m_file && tools::sync_file(m_filename);
+  }
+
+  bool BlockCacheJournal::load(std::vector<Record>& records) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ifstream file(m_filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+      return false;
+    }
+
+    uint64_t remaining = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+    for (;;) {
+      uint32_t size;
+      if (!file.read(reinterpret_cast<char*>(&size), sizeof(size)) || remaining < sizeof(size) + size + sizeof(crypto::Hash)) {
+        break;
+      }
+
+      remaining -= sizeof(size) + size + sizeof(crypto::Hash);
+
+      BinaryArray payload(size);
+      crypto::Hash checksum;
+      if (!file.read(reinterpret_cast<char*>(payload.data()), payload.size()) || !file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum)) ||
+          crypto::cn_fast_hash(payload.data(), payload.size()) != checksum) {
+        break;
+      }
+
+      Record record;
+      if (!fromBinaryArray(record, payload)) {
+        break;
+      }
+
+      records.push_back(std::move(record));
+    }
+
+    return true;
+  }
+
+  bool BlockCacheJournal::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file.close();
+    m_file.open(m_filename, std::ios::binary | std::ios::trunc);
+    return static_cast<bool>(m_file);
+  }
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "crypto/hash.h"
+
+namespace cn
+{
+  class ISerializer;
+
+  // Append-only log kept next to the blockchain cache snapshot. Blocks pushed since the snapshot
+  // are still in the block storage, only the blocks popped from it are lost, so the journal keeps
+  // those: replaying it undoes the snapshot blocks that left the chain before the new tail is indexed.
+  // Every record is framed and checksummed, a torn record left by a crash ends the replay.
+  class BlockCacheJournal {
+  public:
+    struct Record {
+      uint32_t height;
+      crypto::Hash blockHash;
+      std::string block;
+
+      void serialize(ISerializer& s);
+    };
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool append(const Record& record);
+    bool load(std::vector<Record>& records) const;
+    // drops every record, called once a new snapshot was written
+    bool clear();
+
+  private:
+    mutable std::mutex m_mutex;
+    std::string m_filename;
+    std::ofstream m_file;
+  };
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockHeaderColumns.h"
+
+#include <stdexcept>
+
+#include "Serialization/SerializationOverloads.h"
+
+namespace cn
+{
+  void BlockHeaderColumns::push(const Header& header) {
+    m_timestamps.push_back(header.timestamp);
+    m_cumulativeDifficulties.push_back(header.cumulativeDifficulty);
+    m_cumulativeSizes.push_back(header.cumulativeSize);
+    m_alreadyGeneratedCoins.push_back(header.alreadyGeneratedCoins);
+    m_rewards.push_back(header.reward);
+    m_nonces.push_back(header.nonce);
+    m_majorVersions.push_back(header.majorVersion);
+    m_minorVersions.push_back(header.minorVersion);
+  }
+
+  void BlockHeaderColumns::pop() {
+    m_timestamps.pop_back();
+    m_cumulativeDifficulties.pop_back();
+    m_cumulativeSizes.pop_back();
+    m_alreadyGeneratedCoins.pop_back();
+    m_rewards.pop_back();
+    m_nonces.pop_back();
+    m_majorVersions.pop_back();
+    m_minorVersions.pop_back();
+  }
+
+  void BlockHeaderColumns::clear() {
+    m_timestamps.clear();
+    m_cumulativeDifficulties.clear();
+    m_cumulativeSizes.clear();
+    m_alreadyGeneratedCoins.clear();
+    m_rewards.clear();
+    m_nonces.clear();
+    m_majorVersions.clear();
+    m_minorVersions.clear();
+  }
+
+  BlockHeaderColumns::Header BlockHeaderColumns::header(uint32_t height) const {
+    Header header;
+    header.timestamp = m_timestamps[height];
+    header.cumulativeDifficulty = m_cumulativeDifficulties[height];
+    header.cumulativeSize = m_cumulativeSizes[height];
+    header.alreadyGeneratedCoins = m_alreadyGeneratedCoins[height];
+    header.reward = m_rewards[height];
+    header.nonce = m_nonces[height];
+    header.majorVersion = m_majorVersions[height];
+    header.minorVersion = m_minorVersions[height];
+    return header;
+  }
+
+  void BlockHeaderColumns::serialize(ISerializer& s) {
+    serializeAsBinary(m_timestamps, "timestamps", s);
+    serializeAsBinary(m_cumulativeDifficulties, "cumulative_difficulties", s);
+    serializeAsBinary(m_cumulativeSizes, "cumulative_sizes", s);
+    serializeAsBinary(m_alreadyGeneratedCoins, "already_generated_coins", s);
+    serializeAsBinary(m_rewards, "rewards", s);
+    serializeAsBinary(m_nonces, "nonces", s);
+    serializeAsBinary(m_majorVersions, "major_versions", s);
+    serializeAsBinary(m_minorVersions, "minor_versions", s);
+
+    if (s.type() == ISerializer::INPUT) {
+      size_t count = m_timestamps.size();
+      if (m_cumulativeDifficulties.size() != count || m_cumulativeSizes.size() != count || m_alreadyGeneratedCoins.size() != count ||
+          m_rewards.size() != count || m_nonces.size() != count || m_majorVersions.size() != count || m_minorVersions.size() != count) {
+        throw std::runtime_error("Inconsistent block header columns");
+      }
+    }
+  }
+}
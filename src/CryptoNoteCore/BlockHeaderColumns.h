@@ -0,0 +1,60 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CryptoNoteCore/Difficulty.h"
+
+namespace cn
+{
+  class ISerializer;
+
+  // Header fields of the main chain blocks indexed by height, one packed column per field, so the
+  // difficulty, timestamp and size windows and the header queries never decode a stored block
+  class BlockHeaderColumns {
+  public:
+    struct Header {
+      uint64_t timestamp;
+      difficulty_type cumulativeDifficulty;
+      uint64_t cumulativeSize;
+      uint64_t alreadyGeneratedCoins;
+      uint64_t reward;
+      uint32_t nonce;
+      uint8_t majorVersion;
+      uint8_t minorVersion;
+    };
+
+    void push(const Header& header);
+    void pop();
+    void clear();
+
+    size_t size() const { return m_timestamps.size(); }
+    bool empty() const { return m_timestamps.empty(); }
+
+    uint64_t timestamp(uint32_t height) const { return m_timestamps[height]; }
+    difficulty_type cumulativeDifficulty(uint32_t height) const { return m_cumulativeDifficulties[height]; }
+    uint64_t cumulativeSize(uint32_t height) const { return m_cumulativeSizes[height]; }
+    uint64_t alreadyGeneratedCoins(uint32_t height) const { return m_alreadyGeneratedCoins[height]; }
+    uint8_t majorVersion(uint32_t height) const { return m_majorVersions[height]; }
+    Header header(uint32_t height) const;
+
+    void setAlreadyGeneratedCoins(uint32_t height, uint64_t coins) { m_alreadyGeneratedCoins[height] = coins; }
+
+    void serialize(ISerializer& s);
+
+  private:
+    std::vector<uint64_t> m_timestamps;
+    std::vector<difficulty_type> m_cumulativeDifficulties;
+    std::vector<uint64_t> m_cumulativeSizes;
+    std::vector<uint64_t> m_alreadyGeneratedCoins;
+    std::vector<uint64_t> m_rewards;
+    std::vector<uint32_t> m_nonces;
+    std::vector<uint8_t> m_majorVersions;
+    std::vector<uint8_t> m_minorVersions;
+  };
+}
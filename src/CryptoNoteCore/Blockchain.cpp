@@ -12,12 +12,14 @@
 #include <numeric>
 #include <cstdio>
 #include <cmath>
+#include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
 #include "Common/Math.h"
 #include "Common/int-util.h"
 #include "Common/ShuffleGenerator.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
+#include "Common/Util.h"
 #include "Rpc/CoreRpcServerCommandsDefinitions.h"
 #include "Serialization/BinarySerializationTools.h"
 #include "CryptoNoteTools.h"
@@ -43,6 +45,16 @@ namespace
     return result;
   }
 
+  // Key images outside of the prime order subgroup allow spending the same output twice
+  bool isKeyImageInMainSubgroup(const crypto::KeyImage &keyImage)
+  {
+    static const crypto::KeyImage I = {{0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
+    static const crypto::KeyImage L = {{0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10}};
+    return crypto::scalarmultKey(keyImage, L) == I;
+  }
+
+  const char TMP_SUFFIX[] = ".tmp";
+
 } // namespace
 
 namespace std
@@ -58,7 +70,7 @@ namespace std
   }
 } // namespace std
 
-#define CURRENT_BLOCKCACHE_STORAGE_ARCHIVE_VER 5
+#define CURRENT_BLOCKCACHE_STORAGE_ARCHIVE_VER 9
 #define CURRENT_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER 1
 
 namespace cn
@@ -70,35 +82,6 @@ namespace cn
 namespace cn
 {
 
-  // custom serialization to speedup cache loading
-  bool serialize(std::vector<std::pair<Blockchain::TransactionIndex, uint16_t>> &value, common::StringView name, cn::ISerializer &s)
-  {
-    const size_t elementSize = sizeof(std::pair<Blockchain::TransactionIndex, uint16_t>);
-    size_t size = value.size() * elementSize;
-
-    if (!s.beginArray(size, name))
-    {
-      return false;
-    }
-
-    if (s.type() == cn::ISerializer::INPUT)
-    {
-      if (size % elementSize != 0)
-      {
-        throw std::runtime_error("Invalid vector size");
-      }
-      value.resize(size / elementSize);
-    }
-
-    if (size)
-    {
-      s.binary(value.data(), size, "");
-    }
-
-    s.endArray();
-    return true;
-  }
-
   void serialize(Blockchain::TransactionIndex &value, ISerializer &s)
   {
     s(value.block, "block");
@@ -109,7 +92,11 @@ namespace cn
   {
 
   public:
-    BlockCacheSerializer(Blockchain &bs, const crypto::Hash& lastBlockHash, ILogger &logger) : m_bs(bs), m_lastBlockHash(lastBlockHash), logger(logger, "BlockCacheSerializer")
+    // The transaction map and the spent keys are kept in files of their own, named after sideFilePrefix.
+    // Without a prefix they are the ones of the regular cache in the data directory.
+    BlockCacheSerializer(Blockchain &bs, const crypto::Hash& lastBlockHash, ILogger &logger, const std::string &sideFilePrefix = std::string()) :
+      m_bs(bs), m_lastBlockHash(lastBlockHash), logger(logger, "BlockCacheSerializer"),
+      m_sideFilePrefix(sideFilePrefix.empty() ? appendPath(bs.m_config_folder, std::string()) : sideFilePrefix)
     {
     }
 
@@ -133,19 +120,38 @@ namespace cn
       }
     }
 
+    // Every file is written and synced aside, then renamed over the previous one. The side files start with
+    // the tail hash of the cache, one left behind by a crash between the renames is refused by load.
     bool save(const std::string &filename)
     {
+      std::string tmpFilename = filename + TMP_SUFFIX;
       try
       {
-        std::ofstream file(filename, std::ios::binary);
-        if (!file)
+        {
+          std::ofstream file(tmpFilename, std::ios::binary);
+          if (!file)
+          {
+            return false;
+          }
+
+          StdOutputStream stream(file);
+          BinaryOutputStreamSerializer s(stream);
+          cn::serialize(*this, s);
+          file.flush();
+          if (!file)
+          {
+            return false;
+          }
+        }
+
+        if (!tools::sync_file(tmpFilename) || !tools::sync_file(transactionMapFile() + TMP_SUFFIX) || !tools::sync_file(spentKeysFile() + TMP_SUFFIX))
         {
           return false;
         }
 
-        StdOutputStream stream(file);
-        BinaryOutputStreamSerializer s(stream);
-        cn::serialize(*this, s);
+        boost::filesystem::rename(tmpFilename, filename);
+        boost::filesystem::rename(transactionMapFile() + TMP_SUFFIX, transactionMapFile());
+        boost::filesystem::rename(spentKeysFile() + TMP_SUFFIX, spentKeysFile());
       }
       catch (const std::exception &)
       {
@@ -155,6 +161,13 @@ namespace cn
       return true;
     }
 
+    void remove(const std::string &filename)
+    {
+      std::remove(filename.c_str());
+      std::remove(transactionMapFile().c_str());
+      std::remove(spentKeysFile().c_str());
+    }
+
     void serialize(ISerializer &s)
     {
       auto start = std::chrono::steady_clock::now();
@@ -175,7 +188,11 @@ namespace cn
         crypto::Hash blockHash;
         s(blockHash, "last_block");
 
-        if (blockHash != m_lastBlockHash)
+        if (m_anyLastBlock)
+        {
+          m_lastBlockHash = blockHash;
+        }
+        else if (blockHash != m_lastBlockHash)
         {
           return;
         }
@@ -189,27 +206,47 @@ namespace cn
       logger(INFO) << operation << "block index";
       s(m_bs.m_blockIndex, "block_index");
 
+      logger(INFO) << operation << "block headers";
+      s(m_bs.m_headerColumns, "block_headers");
+
+      logger(INFO) << operation << "block blobs";
+      s(m_bs.m_blobIndex, "block_blobs");
+
       logger(INFO) << operation << "transaction map";
       if (s.type() == ISerializer::INPUT)
       {
-        phmap::BinaryInputArchive ar_in(appendPath(m_bs.m_config_folder, "transactionsmap.dat").c_str());
+        phmap::BinaryInputArchive ar_in(transactionMapFile().c_str());
+        if (!loadSideFileHash(ar_in))
+        {
+          logger(WARNING) << "transaction map does not belong to the cache";
+          return;
+        }
+
         m_bs.m_transactionMap.phmap_load(ar_in);
       }
       else
       {
-        phmap::BinaryOutputArchive ar_out(appendPath(m_bs.m_config_folder, "transactionsmap.dat").c_str());
+        phmap::BinaryOutputArchive ar_out((transactionMapFile() + TMP_SUFFIX).c_str());
+        ar_out.saveBinary(&m_lastBlockHash, sizeof(m_lastBlockHash));
         m_bs.m_transactionMap.phmap_dump(ar_out);
       }
 
       logger(INFO) << operation << "spent keys";
       if (s.type() == ISerializer::INPUT)
       {
-        phmap::BinaryInputArchive ar_in(appendPath(m_bs.m_config_folder, "spentkeys.dat").c_str());
+        phmap::BinaryInputArchive ar_in(spentKeysFile().c_str());
+        if (!loadSideFileHash(ar_in))
+        {
+          logger(WARNING) << "spent keys do not belong to the cache";
+          return;
+        }
+
         m_bs.m_spent_keys.phmap_load(ar_in);
       }
       else
       {
-        phmap::BinaryOutputArchive ar_out(appendPath(m_bs.m_config_folder, "spentkeys.dat").c_str());
+        phmap::BinaryOutputArchive ar_out((spentKeysFile() + TMP_SUFFIX).c_str());
+        ar_out.saveBinary(&m_lastBlockHash, sizeof(m_lastBlockHash));
         m_bs.m_spent_keys.phmap_dump(ar_out);
       }
 
@@ -234,11 +271,41 @@ namespace cn
       return m_loaded;
     }
 
+    // load a cache whatever block it ends with, lastBlockHash() tells which one
+    void acceptAnyLastBlock()
+    {
+      m_anyLastBlock = true;
+    }
+
+    const crypto::Hash &lastBlockHash() const
+    {
+      return m_lastBlockHash;
+    }
+
   private:
+    std::string transactionMapFile() const
+    {
+      return m_sideFilePrefix + "transactionsmap.dat";
+    }
+
+    std::string spentKeysFile() const
+    {
+      return m_sideFilePrefix + "spentkeys.dat";
+    }
+
+    bool loadSideFileHash(phmap::BinaryInputArchive &ar)
+    {
+      crypto::Hash blockHash = NULL_HASH;
+      ar.loadBinary(&blockHash, sizeof(blockHash));
+      return blockHash == m_lastBlockHash;
+    }
+
     Blockchain &m_bs;
     crypto::Hash m_lastBlockHash;
     LoggerRef logger;
+    std::string m_sideFilePrefix;
     bool m_loaded = false;
+    bool m_anyLastBlock = false;
   };
 
   class BlockchainIndicesSerializer
@@ -346,6 +413,8 @@ namespace cn
   Blockchain::Blockchain(const Currency &currency, tx_memory_pool &tx_pool, ILogger &logger, bool blockchainIndexesEnabled, bool blockchainAutosaveEnabled) :
     m_currency(currency),
     m_tx_pool(tx_pool),
+    m_longHashPool(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT * 4, tools::WorkerPool::defaultWorkerCount() + 1),
+    m_ringSignatureCache(RING_SIGNATURE_CACHE_SIZE),
     m_checkpoints(logger),
     m_upgradeDetectorV2(currency, m_blocks, BLOCK_MAJOR_VERSION_2, logger),
     m_upgradeDetectorV3(currency, m_blocks, BLOCK_MAJOR_VERSION_3, logger),
@@ -354,6 +423,7 @@ namespace cn
     m_upgradeDetectorV8(currency, m_blocks, BLOCK_MAJOR_VERSION_8, logger),
     m_blockchainIndexesEnabled(blockchainIndexesEnabled),
     m_blockchainAutosaveEnabled(blockchainAutosaveEnabled),
+    m_cacheJournalTail(0),
     logger(logger, "Blockchain")
 
   {
@@ -442,23 +512,23 @@ namespace cn
 
   bool Blockchain::haveTransaction(const crypto::Hash &id)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_transactionMap.find(id) != m_transactionMap.end();
   }
 
   bool Blockchain::have_tx_keyimg_as_spent(const crypto::KeyImage &key_im)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_spent_keys.find(key_im) != m_spent_keys.end();
   }
 
   uint32_t Blockchain::getCurrentBlockchainHeight()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return static_cast<uint32_t>(m_blocks.size());
   }
 
-  bool Blockchain::init(const std::string &config_folder, bool load_existing, bool testnet)
+  bool Blockchain::init(const std::string &config_folder, bool load_existing, bool testnet, bool memoryMappedBlocks, size_t blocksCacheSize)
   {
     m_testnet = testnet;
     m_checkpoints.set_testnet(testnet);
@@ -470,26 +540,41 @@ namespace cn
     }
 
     m_config_folder = config_folder;
+    m_memoryMappedBlocks = memoryMappedBlocks;
+    m_blocksCacheSize = blocksCacheSize;
+
+    if (!m_blocks.open(appendPath(config_folder, m_currency.blocksFileName()), appendPath(config_folder, m_currency.blockIndexesFileName()), m_blocksCacheSize, m_memoryMappedBlocks))
+    {
+      return false;
+    }
 
-    if (!m_blocks.open(appendPath(config_folder, m_currency.blocksFileName()), appendPath(config_folder, m_currency.blockIndexesFileName()), 1024))
+    if (!m_cacheJournal.open(appendPath(config_folder, m_currency.blocksCacheFileName() + ".journal")))
     {
+      logger(ERROR, BRIGHT_RED) << "Failed to open blockchain cache journal";
       return false;
     }
 
+    if (m_memoryMappedBlocks)
+    {
+      logger(INFO) << "Using memory mapped block storage, blocks cache size " << m_blocksCacheSize;
+    }
+
     if (load_existing && !m_blocks.empty())
     {
       logger(INFO) << "Loading blockchain";
-      BlockCacheSerializer loader(*this, get_block_hash(m_blocks.back().bl), logger.getLogger());
+      BlockCacheSerializer loader(*this, NULL_HASH, logger.getLogger());
+      loader.acceptAnyLastBlock();
       loader.load(appendPath(config_folder, m_currency.blocksCacheFileName()));
 
-      if (!loader.loaded())
+      if (!loader.loaded() || !replayCacheJournal(loader.lastBlockHash()))
       {
         logger(WARNING, BRIGHT_YELLOW) << " No actual blockchain cache found, rebuilding internal structures";
+        clearCache();
         rebuildCache();
       }
       uint64_t checkBlockHeight = 24732;
       uint64_t checkMinimum = 13000000000000;
-      if (!m_testnet && m_blocks.size() > checkBlockHeight && m_blocks[checkBlockHeight].already_generated_coins < checkMinimum)
+      if (!m_testnet && m_blocks.size() > checkBlockHeight && m_headerColumns.alreadyGeneratedCoins(checkBlockHeight) < checkMinimum)
       {
         logger(WARNING, BRIGHT_YELLOW) << "Invalid blocks cache, rebuilding internal structures";
         if (!rebuildBlocks())
@@ -577,8 +662,8 @@ namespace cn
 
     update_next_comulative_size_limit();
 
-    uint64_t timestamp_diff = time(nullptr) - m_blocks.back().bl.timestamp;
-    if (!m_blocks.back().bl.timestamp)
+    uint64_t timestamp_diff = time(nullptr) - m_headerColumns.timestamp(m_blocks.size() - 1);
+    if (!m_headerColumns.timestamp(m_blocks.size() - 1))
     {
       timestamp_diff = time(nullptr) - 1341378000;
     }
@@ -618,67 +703,227 @@ namespace cn
   {
     logger(INFO, BRIGHT_WHITE) << "Rebuilding cache";
 
-    std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
-    m_blockIndex.clear();
-    m_transactionMap.clear();
-    m_spent_keys.clear();
-    m_outputs.clear();
-    m_multisignatureOutputs.clear();
-    for (uint32_t b = 0; b < m_blocks.size(); ++b)
+    std::string progressFile = appendPath(m_config_folder, m_currency.blocksCacheFileName() + ".rebuild");
+    indexBlocks(resumeCacheRebuild(progressFile), progressFile);
+
+    // once the regular cache describes the whole chain the progress is not needed anymore
+    if (storeCache())
     {
-      if (b % 1000 == 0)
-      {
-        logger(INFO, BRIGHT_WHITE) << "Rebuilding Cache for Height " << b << " of " << m_blocks.size();
-      }
+      BlockCacheSerializer(*this, NULL_HASH, logger.getLogger(), progressFile + '.').remove(progressFile);
+    }
+  }
 
-      const BlockEntry &block = m_blocks[b];
-      crypto::Hash blockHash = get_block_hash(block.bl);
-      m_blockIndex.push(blockHash);
-      uint64_t interest = 0;
-      for (uint32_t t = 0; t < block.transactions.size(); ++t)
-      {
-        const TransactionEntry &transaction = block.transactions[t];
-        crypto::Hash transactionHash = getObjectHash(transaction.tx);
-        TransactionIndex transactionIndex = {b, static_cast<uint16_t>(t)};
-        m_transactionMap.insert(std::make_pair(transactionHash, transactionIndex));
+  // Indexes the stored blocks from startHeight on, saving the partial cache to progressFile now and then if it is not empty
+  void Blockchain::indexBlocks(uint32_t startHeight, const std::string &progressFile)
+  {
+    // blocks are decoded and hashed chunk by chunk on all cores, then merged in height order
+    const uint32_t chunkSize = 1000;
+    // progress is saved every so many blocks, an interrupted rebuild resumes from there
+    const uint32_t checkpointInterval = 100000;
+
+    struct RebuiltBlock
+    {
+      BlockEntry block;
+      crypto::Hash hash;
+      std::vector<crypto::Hash> transactionHashes;
+      uint64_t interest;
+      BlockBlobIndex::Layout layout;
+    };
 
-        // process inputs
-        for (auto &i : transaction.tx.inputs)
+    std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
+    uint32_t blockCount = static_cast<uint32_t>(m_blocks.size());
+    uint32_t lastCheckpoint = startHeight;
+    tools::WorkerPool workers(tools::WorkerPool::defaultWorkerCount());
+    std::vector<RebuiltBlock> chunk;
+    for (uint32_t first = startHeight; first < blockCount; first += chunkSize)
+    {
+      std::chrono::steady_clock::time_point chunkStart = std::chrono::steady_clock::now();
+      uint32_t count = std::min(chunkSize, blockCount - first);
+      chunk.resize(count);
+      workers.parallelFor(count, [this, first, &chunk](size_t i) {
+        uint32_t b = first + static_cast<uint32_t>(i);
+        RebuiltBlock &rebuilt = chunk[i];
+        m_blocks.load(b, rebuilt.block);
+        rebuilt.hash = get_block_hash(rebuilt.block.bl);
+        rebuilt.layout = layoutOf(rebuilt.block);
+        rebuilt.transactionHashes.clear();
+        rebuilt.interest = 0;
+        for (const TransactionEntry &transaction : rebuilt.block.transactions)
         {
-          if (i.type() == typeid(KeyInput))
-          {
-            m_spent_keys.insert(std::make_pair(boost::get<KeyInput>(i).keyImage, b));
-          }
-          else if (i.type() == typeid(MultisignatureInput))
-          {
-            const auto &out = boost::get<MultisignatureInput>(i);
-            m_multisignatureOutputs[out.amount][out.outputIndex].isUsed = true;
-          }
+          rebuilt.transactionHashes.push_back(getObjectHash(transaction.tx));
+          rebuilt.interest += m_currency.calculateTotalTransactionInterest(transaction.tx, b); //block.height shows 0 wrongly sometimes apparently
         }
+      });
 
-        // process outputs
-        for (uint32_t o = 0; o < transaction.tx.outputs.size(); ++o)
+      for (uint32_t c = 0; c < count; ++c)
+      {
+        uint32_t b = first + c;
+        const BlockEntry &block = chunk[c].block;
+        m_blockIndex.push(chunk[c].hash);
+        m_headerColumns.push(headerOf(block));
+        m_blobIndex.push(chunk[c].layout);
+        for (uint32_t t = 0; t < block.transactions.size(); ++t)
         {
-          const auto &out = transaction.tx.outputs[o];
-          if (out.target.type() == typeid(KeyOutput))
+          const TransactionEntry &transaction = block.transactions[t];
+          TransactionIndex transactionIndex = {b, static_cast<uint16_t>(t)};
+          m_transactionMap.insert(std::make_pair(chunk[c].transactionHashes[t], transactionIndex));
+
+          // process inputs
+          for (auto &i : transaction.tx.inputs)
           {
-            m_outputs[out.amount].push_back(std::make_pair<>(transactionIndex, o));
+            if (i.type() == typeid(KeyInput))
+            {
+              m_spent_keys.insert(std::make_pair(boost::get<KeyInput>(i).keyImage, b));
+            }
+            else if (i.type() == typeid(MultisignatureInput))
+            {
+              const auto &out = boost::get<MultisignatureInput>(i);
+              m_multisignatureOutputs[out.amount][out.outputIndex].isUsed = true;
+            }
           }
-          else if (out.target.type() == typeid(MultisignatureOutput))
+
+          // process outputs
+          for (uint32_t o = 0; o < transaction.tx.outputs.size(); ++o)
           {
-            MultisignatureOutputUsage usage = {transactionIndex, static_cast<uint16_t>(o), false};
-            m_multisignatureOutputs[out.amount].push_back(usage);
+            const auto &out = transaction.tx.outputs[o];
+            if (out.target.type() == typeid(KeyOutput))
+            {
+              m_outputs[out.amount].push(b, static_cast<uint16_t>(t), static_cast<uint16_t>(o), boost::get<KeyOutput>(out.target).key, transaction.tx.unlockTime);
+            }
+            else if (out.target.type() == typeid(MultisignatureOutput))
+            {
+              MultisignatureOutputUsage usage = {transactionIndex, static_cast<uint16_t>(o), false};
+              m_multisignatureOutputs[out.amount].push_back(usage);
+            }
           }
         }
 
-        interest += m_currency.calculateTotalTransactionInterest(transaction.tx, b); //block.height); //block.height shows 0 wrongly sometimes apparently
+        pushToDepositIndex(block, chunk[c].interest);
       }
 
-      pushToDepositIndex(block, interest);
+      std::chrono::duration<double> chunkDuration = std::chrono::steady_clock::now() - chunkStart;
+      logger(INFO, BRIGHT_WHITE) << "Rebuilding Cache for Height " << first + count << " of " << blockCount << ", "
+                                 << static_cast<uint64_t>(count / std::max(chunkDuration.count(), 0.001)) << " blocks/s";
+
+      if (!progressFile.empty() && first + count - lastCheckpoint >= checkpointInterval && first + count < blockCount)
+      {
+        // the progress has side files of its own, the ones of the regular cache stay untouched
+        BlockCacheSerializer progress(*this, chunk.back().hash, logger.getLogger(), progressFile + '.');
+        if (progress.save(progressFile))
+        {
+          lastCheckpoint = first + count;
+          logger(INFO, BRIGHT_WHITE) << "Cache rebuild progress saved at height " << lastCheckpoint;
+        }
+      }
     }
 
     std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
-    logger(INFO, BRIGHT_WHITE) << "Rebuilding internal structures took: " << duration.count();
+    logger(INFO, BRIGHT_WHITE) << "Rebuilding internal structures took: " << duration.count() << ", "
+                               << static_cast<uint64_t>((blockCount - startHeight) / std::max(duration.count(), 0.001)) << " blocks/s";
+  }
+
+  uint32_t Blockchain::resumeCacheRebuild(const std::string &progressFile)
+  {
+    BlockCacheSerializer progress(*this, NULL_HASH, logger.getLogger(), progressFile + '.');
+    progress.acceptAnyLastBlock();
+    progress.load(progressFile);
+    uint32_t height = m_blockIndex.size();
+    // the side files were checked against the tail hash by load, the tail itself has to be the stored block
+    if (progress.loaded() && height != 0 && height <= m_blocks.size() && m_blockIndex.getBlockId(height - 1) == progress.lastBlockHash() &&
+        get_block_hash(m_blocks[height - 1].bl) == progress.lastBlockHash())
+    {
+      logger(INFO, BRIGHT_WHITE) << "Resuming cache rebuild from height " << height;
+      return height;
+    }
+
+    clearCache();
+    return 0;
+  }
+
+  void Blockchain::clearCache()
+  {
+    m_blockIndex.clear();
+    m_headerColumns.clear();
+    m_blobIndex.clear();
+    m_transactionMap.clear();
+    m_spent_keys.clear();
+    m_outputs.clear();
+    m_multisignatureOutputs.clear();
+    m_depositIndex = DepositIndex();
+  }
+
+  // Brings a cache snapshot older than the stored chain up to date: the snapshot blocks that were popped
+  // since are undone from the journal, then the blocks stored above the fork are indexed
+  bool Blockchain::replayCacheJournal(const crypto::Hash &lastBlockHash)
+  {
+    uint32_t snapshotHeight = m_blockIndex.size();
+    if (snapshotHeight == 0 || m_headerColumns.size() != snapshotHeight || m_blockIndex.getBlockId(snapshotHeight - 1) != lastBlockHash)
+    {
+      return false;
+    }
+
+    std::vector<BlockCacheJournal::Record> records;
+    m_cacheJournal.load(records);
+
+    uint32_t forkHeight = std::min(snapshotHeight, static_cast<uint32_t>(m_blocks.size()));
+    while (forkHeight > 0 && m_blockIndex.getBlockId(forkHeight - 1) != get_block_hash(m_blocks[forkHeight - 1].bl))
+    {
+      if (snapshotHeight - forkHeight >= records.size())
+      {
+        return false;
+      }
+
+      --forkHeight;
+    }
+
+    uint32_t blockCount = static_cast<uint32_t>(m_blocks.size());
+    if (snapshotHeight != blockCount || forkHeight != snapshotHeight)
+    {
+      logger(INFO, BRIGHT_WHITE) << "Replaying blockchain cache journal, undoing " << snapshotHeight - forkHeight << " blocks and indexing " << blockCount - forkHeight << " blocks";
+    }
+
+    for (uint32_t height = snapshotHeight; height > forkHeight; --height)
+    {
+      crypto::Hash blockHash = m_blockIndex.getBlockId(height - 1);
+      auto record = std::find_if(records.rbegin(), records.rend(), [height, &blockHash](const BlockCacheJournal::Record &r) {
+        return r.height == height - 1 && r.blockHash == blockHash;
+      });
+
+      BlockEntry block;
+      if (record == records.rend() || !fromBinaryArray(block, common::asBinaryArray(record->block)))
+      {
+        logger(WARNING, BRIGHT_YELLOW) << "Blockchain cache journal misses block " << blockHash << " at height " << height - 1;
+        return false;
+      }
+
+      popTransactions(block, getObjectHash(block.bl.baseTransaction));
+      m_depositIndex.popBlock();
+      m_blockIndex.pop();
+      m_headerColumns.pop();
+      m_blobIndex.pop();
+    }
+
+    if (forkHeight < blockCount)
+    {
+      indexBlocks(forkHeight, std::string());
+    }
+
+    m_cacheJournalTail = (snapshotHeight - forkHeight) + (blockCount - forkHeight);
+    return true;
+  }
+
+  void Blockchain::journalPoppedBlock()
+  {
+    ++m_cacheJournalTail;
+
+    BlockCacheJournal::Record record;
+    record.height = static_cast<uint32_t>(m_blocks.size() - 1);
+    record.blockHash = m_blockIndex.getBlockId(record.height);
+    record.block = common::asString(toBinaryArray(m_blocks.back()));
+    if (!m_cacheJournal.append(record))
+    {
+      logger(WARNING, BRIGHT_YELLOW) << "Failed to journal popped block " << record.blockHash << ", the next start may rebuild the blockchain cache";
+    }
   }
 
   bool Blockchain::rebuildBlocks()
@@ -720,6 +965,8 @@ namespace cn
       uint64_t alreadyGeneratedCoins = alreadyGeneratedCoinsPrev + emissionChange + interest;
       block.already_generated_coins = alreadyGeneratedCoins;
       m_blocks.replace(b, block);
+      m_headerColumns.setAlreadyGeneratedCoins(b, alreadyGeneratedCoins);
+      m_blobIndex.replace(b, layoutOf(block));
       alreadyGeneratedCoinsPrev = alreadyGeneratedCoins;
     }
 
@@ -727,12 +974,15 @@ namespace cn
     logger(INFO, BRIGHT_WHITE) << "Rebuilding blocks took: " << duration.count();
     storeCache();
     m_blocks.close();
-    return m_blocks.open(appendPath(m_config_folder, m_currency.blocksFileName()), appendPath(m_config_folder, m_currency.blockIndexesFileName()), 1024);
+    return m_blocks.open(appendPath(m_config_folder, m_currency.blocksFileName()), appendPath(m_config_folder, m_currency.blockIndexesFileName()), m_blocksCacheSize, m_memoryMappedBlocks);
   }
 
   bool Blockchain::storeCache()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    // readers may go on while the cache is written, a second save waits as it would overwrite the same
+    // files and the journal state. Writers change the journal state only under the exclusive lock.
+    ReadLock lk(*this);
+    std::lock_guard<std::mutex> saveLock(m_cacheSaveMutex);
 
     logger(INFO, BRIGHT_WHITE) << "Saving blockchain...";
     BlockCacheSerializer ser(*this, getTailId(), logger.getLogger());
@@ -742,12 +992,22 @@ namespace cn
       return false;
     }
     logger(INFO, BRIGHT_GREEN) << "The Blockchain was successfully saved.";
+
+    // the snapshot covers every journaled block
+    m_cacheJournal.clear();
+    m_cacheJournalTail = 0;
     return true;
   }
 
   bool Blockchain::deinit()
   {
-    storeCache();
+    // a short journal tail is replayed on the next start instead of rewriting the whole cache
+    if (m_cacheJournalTail >= BLOCKCHAIN_CACHE_COMPACTION_INTERVAL)
+    {
+      storeCache();
+    }
+
+    m_cacheJournal.close();
     if (m_blockchainIndexesEnabled)
     {
       storeBlockchainIndices();
@@ -761,6 +1021,8 @@ namespace cn
     std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
     m_blocks.clear();
     m_blockIndex.clear();
+    m_headerColumns.clear();
+    m_blobIndex.clear();
     m_transactionMap.clear();
 
     m_spent_keys.clear();
@@ -780,27 +1042,27 @@ namespace cn
   crypto::Hash Blockchain::getTailId(uint32_t &height)
   {
     assert(!m_blocks.empty());
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     height = getCurrentBlockchainHeight() - 1;
     return getTailId();
   }
 
   crypto::Hash Blockchain::getTailId()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_blocks.empty() ? NULL_HASH : m_blockIndex.getTailId();
   }
 
   std::vector<crypto::Hash> Blockchain::buildSparseChain()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     assert(m_blockIndex.size() != 0);
     return doBuildSparseChain(m_blockIndex.getTailId());
   }
 
   std::vector<crypto::Hash> Blockchain::buildSparseChain(const crypto::Hash &startBlockId)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     assert(haveBlock(startBlockId));
     return doBuildSparseChain(startBlockId);
   }
@@ -844,14 +1106,14 @@ namespace cn
 
   crypto::Hash Blockchain::getBlockIdByHeight(uint32_t height)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     assert(height < m_blockIndex.size());
     return m_blockIndex.getBlockId(height);
   }
 
   bool Blockchain::getBlockByHash(const crypto::Hash &blockHash, Block &b)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     uint32_t height = 0;
 
@@ -875,13 +1137,13 @@ namespace cn
 
   bool Blockchain::getBlockHeight(const crypto::Hash &blockId, uint32_t &blockHeight)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lock(m_blockchain_lock);
+    ReadLock lock(*this);
     return m_blockIndex.getBlockHeight(blockId, blockHeight);
   }
 
   difficulty_type Blockchain::getDifficultyForNextBlock()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     std::vector<uint64_t> timestamps;
     std::vector<difficulty_type> commulative_difficulties;
 
@@ -895,8 +1157,8 @@ namespace cn
 
     for (; offset < m_blocks.size(); offset++)
     {
-      timestamps.push_back(m_blocks[offset].bl.timestamp);
-      commulative_difficulties.push_back(m_blocks[offset].cumulative_difficulty);
+      timestamps.push_back(m_headerColumns.timestamp(offset));
+      commulative_difficulties.push_back(m_headerColumns.cumulativeDifficulty(offset));
     }
 
     uint64_t block_index = m_blocks.size();
@@ -919,40 +1181,76 @@ namespace cn
   uint64_t Blockchain::getBlockTimestamp(uint32_t height)
   {
     assert(height < m_blocks.size());
-    return m_blocks[height].bl.timestamp;
+    return m_headerColumns.timestamp(height);
   }
 
   uint64_t Blockchain::getCoinsInCirculation()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (m_blocks.empty())
     {
       return 0;
     }
     else
     {
-      return m_blocks.back().already_generated_coins;
+      return m_headerColumns.alreadyGeneratedCoins(m_blocks.size() - 1);
     }
   }
 
   uint64_t Blockchain::coinsEmittedAtHeight(uint64_t height)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-    const auto &block = m_blocks[height];
-    return block.already_generated_coins;
+    ReadLock lk(*this);
+    return m_headerColumns.alreadyGeneratedCoins(height);
   }
 
   difficulty_type Blockchain::difficultyAtHeight(uint64_t height)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-    const auto &current = m_blocks[height];
+    ReadLock lk(*this);
     if (height < 1)
     {
-      return current.cumulative_difficulty;
+      return m_headerColumns.cumulativeDifficulty(height);
     }
 
-    const auto &previous = m_blocks[height - 1];
-    return current.cumulative_difficulty - previous.cumulative_difficulty;
+    return m_headerColumns.cumulativeDifficulty(height) - m_headerColumns.cumulativeDifficulty(height - 1);
+  }
+
+  bool Blockchain::getBlockHeader(uint32_t height, BlockHeaderColumns::Header &header)
+  {
+    ReadLock lk(*this);
+    if (height >= m_headerColumns.size())
+    {
+      return false;
+    }
+
+    header = m_headerColumns.header(height);
+    return true;
+  }
+
+  bool Blockchain::getBlockBlobs(uint32_t height, block_complete_entry &entry)
+  {
+    ReadLock lk(*this);
+    if (height >= m_blocks.size())
+    {
+      return false;
+    }
+
+    // the stored bytes are served as they are, decoding is left for entries the layout does not describe
+    std::string bytes;
+    m_blocks.loadBytes(height, bytes);
+    if (m_blobIndex.split(height, bytes, entry.block, entry.txs))
+    {
+      return true;
+    }
+
+    const BlockEntry &block = m_blocks[height];
+    entry.block = asString(toBinaryArray(block.bl));
+    entry.txs.clear();
+    for (size_t i = 1; i < block.transactions.size(); ++i)
+    {
+      entry.txs.push_back(asString(toBinaryArray(block.transactions[i].tx)));
+    }
+
+    return true;
   }
 
   uint8_t Blockchain::get_block_major_version_for_height(uint64_t height) const
@@ -1176,7 +1474,7 @@ namespace cn
 
     if (alt_chain.size() < m_currency.difficultyBlocksCountByBlockVersion(BlockMajorVersion))
     {
-      std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+      ReadLock lk(*this);
       size_t main_chain_stop_offset = alt_chain.size() ? m_alternative_chains[alt_chain.front()].height : bei.height;
       size_t main_chain_count = m_currency.difficultyBlocksCountByBlockVersion(BlockMajorVersion) - std::min(m_currency.difficultyBlocksCountByBlockVersion(BlockMajorVersion), alt_chain.size());
       main_chain_count = std::min(main_chain_count, main_chain_stop_offset);
@@ -1190,8 +1488,8 @@ namespace cn
 
       for (; main_chain_start_offset < main_chain_stop_offset; ++main_chain_start_offset)
       {
-        timestamps.push_back(m_blocks[main_chain_start_offset].bl.timestamp);
-        commulative_difficulties.push_back(m_blocks[main_chain_start_offset].cumulative_difficulty);
+        timestamps.push_back(m_headerColumns.timestamp(main_chain_start_offset));
+        commulative_difficulties.push_back(m_headerColumns.cumulativeDifficulty(main_chain_start_offset));
       }
 
       if (!((alt_chain.size() + timestamps.size()) <= m_currency.difficultyBlocksCountByBlockVersion(BlockMajorVersion)))
@@ -1336,7 +1634,7 @@ namespace cn
 
   bool Blockchain::getBackwardBlocksSize(size_t from_height, std::vector<size_t> &sz, size_t count)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (!(from_height < m_blocks.size()))
     {
       logger(ERROR, BRIGHT_RED)
@@ -1349,7 +1647,7 @@ namespace cn
     size_t start_offset = (from_height + 1) - std::min((from_height + 1), count);
     for (size_t i = start_offset; i != from_height + 1; i++)
     {
-      sz.push_back(m_blocks[i].block_cumulative_size);
+      sz.push_back(m_headerColumns.cumulativeSize(i));
     }
 
     return true;
@@ -1357,7 +1655,7 @@ namespace cn
 
   bool Blockchain::get_last_n_blocks_sizes(std::vector<size_t> &sz, size_t count)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (!m_blocks.size())
     {
       return true;
@@ -1378,7 +1676,7 @@ namespace cn
       return true;
     }
 
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     size_t need_elements = m_currency.timestampCheckWindow() - timestamps.size();
 
     if (!(start_top_height < m_blocks.size()))
@@ -1391,7 +1689,7 @@ namespace cn
 
     do
     {
-      timestamps.push_back(m_blocks[start_top_height].bl.timestamp);
+      timestamps.push_back(m_headerColumns.timestamp(start_top_height));
       if (start_top_height == 0)
       {
         break;
@@ -1540,7 +1838,7 @@ namespace cn
         return false;
       }
       crypto::Hash proof_of_work = NULL_HASH;
-      if (!m_currency.checkProofOfWork(m_cn_context, bei.bl, current_diff, proof_of_work))
+      if (!checkProofOfWork(bei.bl, id, current_diff, proof_of_work))
       {
         logger(INFO, BRIGHT_RED) << "Block with id: " << id
                                  << ENDL << " for alternative chain, have not enough proof of work: " << proof_of_work
@@ -1558,7 +1856,7 @@ namespace cn
         return false;
       }
 
-      bei.cumulative_difficulty = alt_chain.size() ? it_prev->second.cumulative_difficulty : m_blocks[mainPrevHeight].cumulative_difficulty;
+      bei.cumulative_difficulty = alt_chain.size() ? it_prev->second.cumulative_difficulty : m_headerColumns.cumulativeDifficulty(mainPrevHeight);
       bei.cumulative_difficulty += current_diff;
 
 #ifdef _DEBUG
@@ -1598,10 +1896,10 @@ namespace cn
         }
         return r;
       }
-      else if (m_blocks.back().cumulative_difficulty < bei.cumulative_difficulty) //check if difficulty bigger then in main chain
+      else if (m_headerColumns.cumulativeDifficulty(m_blocks.size() - 1) < bei.cumulative_difficulty) //check if difficulty bigger then in main chain
       {
         //do reorganize!
-        logger(INFO, BRIGHT_GREEN) << "###### REORGANIZE on height: " << m_alternative_chains[alt_chain.front()].height << " of " << m_blocks.size() - 1 << " with cum_difficulty " << m_blocks.back().cumulative_difficulty
+        logger(INFO, BRIGHT_GREEN) << "###### REORGANIZE on height: " << m_alternative_chains[alt_chain.front()].height << " of " << m_blocks.size() - 1 << " with cum_difficulty " << m_headerColumns.cumulativeDifficulty(m_blocks.size() - 1)
                                    << ENDL << " alternative blockchain size: " << alt_chain.size() << " with cum_difficulty " << bei.cumulative_difficulty;
 
         bool r = switch_to_alternative_blockchain(alt_chain, false);
@@ -1642,7 +1940,7 @@ namespace cn
 
   bool Blockchain::getBlocks(uint32_t start_offset, uint32_t count, std::list<Block> &blocks, std::list<Transaction> &txs)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (start_offset >= m_blocks.size())
     {
       return false;
@@ -1665,7 +1963,7 @@ namespace cn
 
   bool Blockchain::getBlocks(uint32_t start_offset, uint32_t count, std::list<Block> &blocks)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (start_offset >= m_blocks.size())
     {
       return false;
@@ -1681,30 +1979,19 @@ namespace cn
 
   bool Blockchain::handleGetObjects(NOTIFY_REQUEST_GET_OBJECTS::request &arg, NOTIFY_RESPONSE_GET_OBJECTS::request &rsp)
   { //Deprecated. Should be removed with CryptoNoteProtocolHandler.
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     rsp.current_blockchain_height = getCurrentBlockchainHeight();
-    std::list<Block> blocks;
-    getBlocks(arg.blocks, blocks, rsp.missed_ids);
-
-    for (const auto &bl : blocks)
+    for (const auto &blockId : arg.blocks)
     {
-      std::list<crypto::Hash> missed_tx_id;
-      std::list<Transaction> txs;
-      getTransactions(bl.transactionHashes, txs, rsp.missed_ids);
-      if (!(!missed_tx_id.size()))
-      {
-        logger(ERROR, BRIGHT_RED) << "Internal error: have missed missed_tx_id.size()=" << missed_tx_id.size() << ENDL << "for block id = " << get_block_hash(bl);
-        return false;
-      } //WTF???
-      rsp.blocks.push_back(block_complete_entry());
-      block_complete_entry &e = rsp.blocks.back();
-      //pack block
-      e.block = asString(toBinaryArray(bl));
-      //pack transactions
-      for (const Transaction &tx : txs)
+      uint32_t height;
+      if (!m_blockIndex.getBlockHeight(blockId, height))
       {
-        e.txs.push_back(asString(toBinaryArray(tx)));
+        rsp.missed_ids.push_back(blockId);
+        continue;
       }
+
+      rsp.blocks.push_back(block_complete_entry());
+      getBlockBlobs(height, rsp.blocks.back());
     }
 
     //get another transactions, if need
@@ -1720,7 +2007,7 @@ namespace cn
   }
 
   bool Blockchain::getTransactionsWithOutputGlobalIndexes(const std::vector<crypto::Hash>& txs_ids, std::list<crypto::Hash>& missed_txs, std::vector<std::pair<Transaction, std::vector<uint32_t>>>& txs) {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     for (const auto& tx_id : txs_ids) {
       auto it = m_transactionMap.find(tx_id);
@@ -1742,7 +2029,7 @@ namespace cn
 
   bool Blockchain::getAlternativeBlocks(std::list<Block> &blocks)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     for (const auto &alt_bl : m_alternative_chains)
     {
       blocks.push_back(alt_bl.second.bl);
@@ -1753,39 +2040,26 @@ namespace cn
 
   uint32_t Blockchain::getAlternativeBlocksCount()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return static_cast<uint32_t>(m_alternative_chains.size());
   }
 
-  bool Blockchain::add_out_to_get_random_outs(std::vector<std::pair<TransactionIndex, uint16_t>> &amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount &result_outs, uint64_t amount, size_t i)
+  bool Blockchain::add_out_to_get_random_outs(const AmountOutputs &amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount &result_outs, uint64_t amount, size_t i)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-    const Transaction &tx = transactionByIndex(amount_outs[i].first).tx;
-    if (!(tx.outputs.size() > amount_outs[i].second))
-    {
-      logger(ERROR, BRIGHT_RED) << "internal error: in global outs index, transaction out index="
-                                << amount_outs[i].second << " more than transaction outputs = " << tx.outputs.size() << ", for tx id = " << getObjectHash(tx);
-      return false;
-    }
-    if (!(tx.outputs[amount_outs[i].second].target.type() == typeid(KeyOutput)))
-    {
-      logger(ERROR, BRIGHT_RED) << "unknown tx out type";
-      return false;
-    }
-
+    ReadLock lk(*this);
     //check if transaction is unlocked
-    if (!is_tx_spendtime_unlocked(tx.unlockTime))
+    if (!is_tx_spendtime_unlocked(amount_outs.unlockTime(i)))
       return false;
 
     COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry &oen = *result_outs.outs.insert(result_outs.outs.end(), COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry());
     oen.global_amount_index = static_cast<uint32_t>(i);
-    oen.out_key = boost::get<KeyOutput>(tx.outputs[amount_outs[i].second].target).key;
+    oen.out_key = amount_outs.key(i);
     return true;
   }
 
-  size_t Blockchain::find_end_of_allowed_index(const std::vector<std::pair<TransactionIndex, uint16_t>> &amount_outs)
+  size_t Blockchain::find_end_of_allowed_index(const AmountOutputs &amount_outs)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (amount_outs.empty())
     {
       return 0;
@@ -1795,7 +2069,7 @@ namespace cn
     do
     {
       --i;
-      if (amount_outs[i].first.block + m_currency.minedMoneyUnlockWindow() <= getCurrentBlockchainHeight())
+      if (amount_outs.block(i) + m_currency.minedMoneyUnlockWindow() <= getCurrentBlockchainHeight())
       {
         return i + 1;
       }
@@ -1806,7 +2080,7 @@ namespace cn
 
   bool Blockchain::getRandomOutsByAmount(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request &req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response &res)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     for (uint64_t amount : req.amounts)
     {
@@ -1819,7 +2093,7 @@ namespace cn
         continue; //actually this is strange situation, wallet should use some real outs when it lookup for some mix, so, at least one out for this amount should exist
       }
 
-      std::vector<std::pair<TransactionIndex, uint16_t>> &amount_outs = it->second;
+      const AmountOutputs &amount_outs = it->second;
       //it is not good idea to use top fresh outs, because it increases possibility of transaction canceling on split
       //lets find upper bound of not fresh outs
       size_t up_index_limit = find_end_of_allowed_index(amount_outs);
@@ -1846,7 +2120,7 @@ namespace cn
     assert(!qblock_ids.empty());
     assert(qblock_ids.back() == m_blockIndex.getBlockId(0));
 
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     uint32_t blockIndex;
     // assert above guarantees that method returns true
     m_blockIndex.findSupplement(qblock_ids, blockIndex);
@@ -1855,22 +2129,22 @@ namespace cn
 
   uint64_t Blockchain::blockDifficulty(size_t i)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (!(i < m_blocks.size()))
     {
       logger(ERROR, BRIGHT_RED) << "wrong block index i = " << i << " at Blockchain::block_difficulty()";
       return false;
     }
     if (i == 0)
-      return m_blocks[i].cumulative_difficulty;
+      return m_headerColumns.cumulativeDifficulty(i);
 
-    return m_blocks[i].cumulative_difficulty - m_blocks[i - 1].cumulative_difficulty;
+    return m_headerColumns.cumulativeDifficulty(i) - m_headerColumns.cumulativeDifficulty(i - 1);
   }
 
   void Blockchain::print_blockchain(uint64_t start_index, uint64_t end_index)
   {
     std::stringstream ss;
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (start_index >= m_blocks.size())
     {
       logger(INFO, BRIGHT_WHITE) << "Wrong starter index set: " << start_index << ", expected max index " << m_blocks.size() - 1;
@@ -1890,7 +2164,7 @@ namespace cn
   void Blockchain::print_blockchain_index(bool print_all)
   {
     std::stringstream ss;
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     if (print_all == false)
     {
@@ -1915,16 +2189,16 @@ namespace cn
   void Blockchain::print_blockchain_outs(const std::string &file)
   {
     std::stringstream ss;
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     for (const outputs_container::value_type &v : m_outputs)
     {
-      const std::vector<std::pair<TransactionIndex, uint16_t>> &vals = v.second;
+      const AmountOutputs &vals = v.second;
       if (!vals.empty())
       {
         ss << "amount: " << v.first << ENDL;
         for (size_t i = 0; i != vals.size(); i++)
         {
-          ss << "\t" << getObjectHash(transactionByIndex(vals[i].first).tx) << ": " << vals[i].second << ENDL;
+          ss << "\t" << getObjectHash(transactionByIndex({vals.block(i), vals.transaction(i)}).tx) << ": " << vals.output(i) << ENDL;
         }
       }
     }
@@ -1946,7 +2220,7 @@ namespace cn
     assert(!remoteBlockIds.empty());
     assert(remoteBlockIds.back() == m_blockIndex.getBlockId(0));
 
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     totalBlockCount = getCurrentBlockchainHeight();
     startBlockIndex = findBlockchainSupplement(remoteBlockIds);
 
@@ -1955,7 +2229,7 @@ namespace cn
 
   bool Blockchain::haveBlock(const crypto::Hash &id)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     if (m_blockIndex.hasBlock(id))
       return true;
 
@@ -1967,13 +2241,13 @@ namespace cn
 
   size_t Blockchain::getTotalTransactions()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_transactionMap.size();
   }
 
   bool Blockchain::getTransactionOutputGlobalIndexes(const crypto::Hash &tx_id, std::vector<uint32_t> &indexs)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     auto it = m_transactionMap.find(tx_id);
     if (it == m_transactionMap.end())
     {
@@ -1998,7 +2272,7 @@ namespace cn
 
   bool Blockchain::get_out_by_msig_gindex(uint64_t amount, uint64_t gindex, MultisignatureOutput &out)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     auto it = m_multisignatureOutputs.find(amount);
     if (it == m_multisignatureOutputs.end())
     {
@@ -2023,7 +2297,7 @@ namespace cn
 
   bool Blockchain::checkTransactionInputs(const Transaction &tx, uint32_t &max_used_block_height, crypto::Hash &max_used_block_id, BlockInfo *tail)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     if (tail)
       tail->id = getTailId(tail->height);
@@ -2062,9 +2336,12 @@ namespace cn
     return checkTransactionInputs(tx, tx_prefix_hash, pmax_used_block_height);
   }
 
-  bool Blockchain::checkTransactionInputs(const Transaction &tx, const crypto::Hash &tx_prefix_hash, uint32_t *pmax_used_block_height)
+  bool Blockchain::checkTransactionInputs(const Transaction &tx, const crypto::Hash &tx_prefix_hash, uint32_t *pmax_used_block_height, std::vector<RingSignatureCheck> *deferredChecks)
   {
     size_t inputIndex = 0;
+    std::vector<RingSignatureCheck> transactionChecks;
+    std::vector<RingSignatureCheck> &signatureChecks = deferredChecks ? *deferredChecks : transactionChecks;
+    size_t firstCheck = signatureChecks.size();
     if (pmax_used_block_height)
     {
       *pmax_used_block_height = 0;
@@ -2091,7 +2368,7 @@ namespace cn
 
         if (!isInCheckpointZone(getCurrentBlockchainHeight()))
         {
-          if (!check_tx_input(in_to_key, tx_prefix_hash, tx.signatures[inputIndex], pmax_used_block_height))
+          if (!check_tx_input(in_to_key, tx_prefix_hash, tx.signatures[inputIndex], pmax_used_block_height, signatureChecks))
           {
             logger(INFO, BRIGHT_WHITE) << "Failed to check input in transaction " << transactionHash;
             return false;
@@ -2119,6 +2396,37 @@ namespace cn
       }
     }
 
+    if (signatureChecks.size() == firstCheck)
+    {
+      return true;
+    }
+
+    // spent key images and unlock times were checked above, only the signatures themselves are remembered
+    crypto::Hash ringsDigest = ringSignaturesDigest(signatureChecks.data() + firstCheck, signatureChecks.size() - firstCheck);
+    // deferred checks come from a block being imported, the pool lookups are not counted
+    if (m_ringSignatureCache.contains(transactionHash, ringsDigest, deferredChecks != nullptr))
+    {
+      signatureChecks.resize(firstCheck);
+      return true;
+    }
+
+    if (!transactionChecks.empty())
+    {
+      // all the key inputs of the transaction are verified as one batch
+      std::unique_ptr<bool[]> passed(new bool[transactionChecks.size()]);
+      checkRingSignatures(transactionChecks.data(), transactionChecks.size(), passed.get());
+      for (size_t i = 0; i < transactionChecks.size(); ++i)
+      {
+        if (!passed[i])
+        {
+          logger(INFO, BRIGHT_WHITE) << "Failed to check input in transaction " << transactionHash;
+          return false;
+        }
+      }
+
+      m_ringSignatureCache.insert(transactionHash, ringsDigest);
+    }
+
     return true;
   }
 
@@ -2145,52 +2453,43 @@ namespace cn
     return false;
   }
 
-  bool Blockchain::check_tx_input(const KeyInput &txin, const crypto::Hash &tx_prefix_hash, const std::vector<crypto::Signature> &sig, uint32_t *pmax_related_block_height)
+  bool Blockchain::check_tx_input(const KeyInput &txin, const crypto::Hash &tx_prefix_hash, const std::vector<crypto::Signature> &sig, uint32_t *pmax_related_block_height, std::vector<RingSignatureCheck> &signatureChecks)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
-    struct outputs_visitor
+    //check ring signature, the ring members are read from the output index without loading their transactions
+    std::vector<crypto::PublicKey> output_keys;
+    auto amountOutputs = m_outputs.find(txin.amount);
+    if (amountOutputs == m_outputs.end() || txin.outputIndexes.empty())
     {
-      std::vector<const crypto::PublicKey *> &m_results_collector;
-      Blockchain &m_bch;
-      LoggerRef logger;
-      outputs_visitor(std::vector<const crypto::PublicKey *> &results_collector, Blockchain &bch, ILogger &logger) : m_results_collector(results_collector), m_bch(bch), logger(logger, "outputs_visitor")
+      logger(INFO, BRIGHT_WHITE) << "Failed to get output keys for tx with amount = " << m_currency.formatAmount(txin.amount) << " and count indexes " << txin.outputIndexes.size();
+      return false;
+    }
+
+    const AmountOutputs &outputs = amountOutputs->second;
+    std::vector<uint32_t> absoluteOffsets = relative_output_offsets_to_absolute(txin.outputIndexes);
+    output_keys.reserve(absoluteOffsets.size());
+    for (uint32_t i : absoluteOffsets)
+    {
+      if (i >= outputs.size())
       {
+        logger(INFO, BRIGHT_WHITE) << "Wrong index in transaction inputs: " << i << ", expected maximum " << outputs.size() - 1;
+        return false;
       }
 
-      bool handle_output(const Transaction &tx, const TransactionOutput &out, size_t transactionOutputIndex)
+      //check tx unlock time
+      if (!is_tx_spendtime_unlocked(outputs.unlockTime(i)))
       {
-        //check tx unlock time
-        if (!m_bch.is_tx_spendtime_unlocked(tx.unlockTime))
-        {
-          logger(INFO, BRIGHT_WHITE) << "One of outputs for one of inputs have wrong tx.unlockTime = " << tx.unlockTime;
-          return false;
-        }
-
-        if (out.target.type() != typeid(KeyOutput))
-        {
-          logger(INFO, BRIGHT_WHITE) << "Output have wrong type id, which=" << out.target.which();
-          return false;
-        }
-
-        m_results_collector.push_back(&boost::get<KeyOutput>(out.target).key);
-        return true;
+        logger(INFO, BRIGHT_WHITE) << "One of outputs for one of inputs have wrong tx.unlockTime = " << outputs.unlockTime(i);
+        return false;
       }
-    };
 
-    //check ring signature
-    std::vector<const crypto::PublicKey *> output_keys;
-    outputs_visitor vi(output_keys, *this, logger.getLogger());
-    if (!scanOutputKeysForIndexes(txin, vi, pmax_related_block_height))
-    {
-      logger(INFO, BRIGHT_WHITE) << "Failed to get output keys for tx with amount = " << m_currency.formatAmount(txin.amount) << " and count indexes " << txin.outputIndexes.size();
-      return false;
+      output_keys.push_back(outputs.key(i));
     }
 
-    if (txin.outputIndexes.size() != output_keys.size())
+    if (pmax_related_block_height && *pmax_related_block_height < outputs.block(absoluteOffsets.back()))
     {
-      logger(INFO, BRIGHT_WHITE) << "Output keys for tx with amount = " << txin.amount << " and count indexes " << txin.outputIndexes.size() << " returned wrong keys count " << output_keys.size();
-      return false;
+      *pmax_related_block_height = outputs.block(absoluteOffsets.back());
     }
 
     if (getCurrentBlockchainHeight() > cn::parameters::UPGRADE_HEIGHT_V4 && getCurrentBlockchainHeight() < cn::parameters::UPGRADE_HEIGHT_V5 && txin.outputIndexes.size() < 3)
@@ -2209,14 +2508,127 @@ namespace cn
       return true;
     }
 
-    static const crypto::KeyImage I = {{0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
-    static const crypto::KeyImage L = {{0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10}};
-    if (!(scalarmultKey(txin.keyImage, L) == I))
+    signatureChecks.push_back(RingSignatureCheck());
+    RingSignatureCheck &check = signatureChecks.back();
+    check.prefixHash = tx_prefix_hash;
+    check.keyImage = txin.keyImage;
+    check.signatures = sig.data();
+    check.outputKeys = std::move(output_keys);
+
+    return true;
+  }
+
+  void Blockchain::checkRingSignatures(const RingSignatureCheck *checks, size_t count, bool *passed)
+  {
+    std::vector<crypto::RingSignatureBatchItem> items;
+    std::vector<size_t> itemChecks;
+    std::vector<std::vector<const crypto::PublicKey *>> outputKeys(count);
+    items.reserve(count);
+    itemChecks.reserve(count);
+    for (size_t i = 0; i < count; ++i)
     {
-      return false;
+      const RingSignatureCheck &check = checks[i];
+      passed[i] = false;
+      if (!isKeyImageInMainSubgroup(check.keyImage))
+      {
+        continue;
+      }
+
+      outputKeys[i].reserve(check.outputKeys.size());
+      for (const crypto::PublicKey &key : check.outputKeys)
+      {
+        outputKeys[i].push_back(&key);
+      }
+
+      crypto::RingSignatureBatchItem item;
+      item.prefixHash = &check.prefixHash;
+      item.image = &check.keyImage;
+      item.pubs = outputKeys[i].data();
+      item.pubsCount = outputKeys[i].size();
+      item.sig = check.signatures;
+      items.push_back(item);
+      itemChecks.push_back(i);
+    }
+
+    std::unique_ptr<bool[]> results(new bool[items.size()]);
+    crypto::check_ring_signatures(items.data(), items.size(), results.get());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+      passed[itemChecks[i]] = results[i];
+    }
+  }
+
+  void Blockchain::precomputeProofOfWork(const Block &block, const crypto::Hash &blockHash)
+  {
+    if (!m_checkpoints.is_in_checkpoint_zone(get_block_height(block)))
+    {
+      m_longHashPool.compute(block, blockHash);
+    }
+  }
+
+  bool Blockchain::checkProofOfWork(const Block &block, const crypto::Hash &blockHash, difficulty_type currentDifficulty, crypto::Hash &proofOfWork)
+  {
+    if (m_longHashPool.take(blockHash, proofOfWork))
+    {
+      return check_hash(proofOfWork, currentDifficulty);
+    }
+
+    return m_currency.checkProofOfWork(m_cn_context, block, currentDifficulty, proofOfWork);
+  }
+
+  crypto::Hash Blockchain::ringSignaturesDigest(const RingSignatureCheck *checks, size_t count)
+  {
+    std::vector<uint8_t> rings;
+    for (size_t i = 0; i < count; ++i)
+    {
+      const RingSignatureCheck &check = checks[i];
+      const uint8_t *keyImage = reinterpret_cast<const uint8_t *>(&check.keyImage);
+      const uint8_t *outputKeys = reinterpret_cast<const uint8_t *>(check.outputKeys.data());
+      rings.insert(rings.end(), keyImage, keyImage + sizeof(check.keyImage));
+      rings.insert(rings.end(), outputKeys, outputKeys + check.outputKeys.size() * sizeof(crypto::PublicKey));
+    }
+
+    return crypto::cn_fast_hash(rings.data(), rings.size());
+  }
+
+  bool Blockchain::verifyRingSignatures(const std::vector<RingSignatureCheck> &checks, size_t &failedTransaction)
+  {
+    std::unique_ptr<bool[]> passed(new bool[checks.size()]);
+    if (checks.size() > 1)
+    {
+      if (!m_signatureVerificationPool)
+      {
+        m_signatureVerificationPool.reset(new tools::WorkerPool(tools::WorkerPool::defaultWorkerCount()));
+      }
+
+      // contiguous slices keep the rings of neighbouring transactions, which often share outputs, in the same batch
+      size_t sliceCount = std::min(checks.size(), m_signatureVerificationPool->workerCount() + 1);
+      size_t sliceSize = (checks.size() + sliceCount - 1) / sliceCount;
+      m_signatureVerificationPool->parallelFor(sliceCount, [&checks, &passed, sliceSize](size_t slice) {
+        size_t begin = slice * sliceSize;
+        size_t end = std::min(checks.size(), begin + sliceSize);
+        if (begin < end)
+        {
+          checkRingSignatures(checks.data() + begin, end - begin, passed.get() + begin);
+        }
+      });
+    }
+    else if (!checks.empty())
+    {
+      checkRingSignatures(checks.data(), 1, passed.get());
+    }
+
+    // checks are in block order, so the first failed one is what a serial check would have reported
+    for (size_t i = 0; i < checks.size(); ++i)
+    {
+      if (!passed[i])
+      {
+        failedTransaction = checks[i].transaction;
+        return false;
+      }
     }
 
-    return crypto::check_ring_signature(tx_prefix_hash, txin.keyImage, output_keys, sig.data());
+    return true;
   }
 
   uint64_t Blockchain::get_adjusted_time() const
@@ -2251,7 +2663,7 @@ namespace cn
     size_t offset = m_blocks.size() <= m_currency.timestampCheckWindow() ? 0 : m_blocks.size() - m_currency.timestampCheckWindow();
     for (; offset != m_blocks.size(); ++offset)
     {
-      timestamps.push_back(m_blocks[offset].bl.timestamp);
+      timestamps.push_back(m_headerColumns.timestamp(offset));
     }
 
     return check_block_timestamp(std::move(timestamps), b);
@@ -2376,12 +2788,10 @@ namespace cn
         {
           sendMessage(BlockchainMessage(NewBlockMessage(id)));
 
-          /** Save the blockchain every 720 blocks if the option is enabled*/
-          if (m_blockchainAutosaveEnabled) {
-            if (height % 720 == 0)
-            {
-              storeCache();
-            }
+          /** Compact the cache journal into a new snapshot, every 720 blocks if autosave is enabled */
+          if (m_cacheJournalTail >= (m_blockchainAutosaveEnabled ? 720 : BLOCKCHAIN_CACHE_COMPACTION_INTERVAL))
+          {
+            storeCache();
           }
 
         }
@@ -2491,7 +2901,7 @@ namespace cn
     }
     else
     {
-      if (!m_currency.checkProofOfWork(m_cn_context, blockData, currentDifficulty, proof_of_work))
+      if (!checkProofOfWork(blockData, blockHash, currentDifficulty, proof_of_work))
       {
         logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << ", has too weak proof of work: " << common::podToHex(proof_of_work) << ", expected difficulty: " << currentDifficulty << " MajorVersion: " << std::to_string(blockData.majorVersion);
         bvc.m_verification_failed = true;
@@ -2522,6 +2932,10 @@ namespace cn
     size_t cumulative_block_size = coinbase_blob_size;
     uint64_t fee_summary = 0;
     uint64_t interestSummary = 0;
+    size_t failedTransaction = 0;
+
+    // Ring signatures are verified together on the worker pool once every other check of the block passed
+    std::vector<RingSignatureCheck> signatureChecks;
 
     for (size_t i = 0; i < transactions.size(); ++i)
     {
@@ -2539,12 +2953,19 @@ namespace cn
         logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " can't contain transaction " << tx_id << " because it has invalid version " << transactions[i].version;
       }
 
-      if (!checkTransactionInputs(transactions[i]))
+      size_t firstCheck = signatureChecks.size();
+      crypto::Hash txPrefixHash = getObjectHash(*static_cast<const TransactionPrefix *>(&transactions[i]));
+      if (!checkTransactionInputs(transactions[i], txPrefixHash, nullptr, &signatureChecks))
       {
         isTransactionValid = false;
         logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has at least one transaction with wrong inputs: " << tx_id;
       }
 
+      for (size_t j = firstCheck; j < signatureChecks.size(); ++j)
+      {
+        signatureChecks[j].transaction = i;
+      }
+
       if (!check_tx_outputs(transactions[i], block.height))
       {
         isTransactionValid = false;
@@ -2553,7 +2974,16 @@ namespace cn
 
       if (!isTransactionValid)
       {
-        logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has at least one invalid transaction: " << tx_id;
+        signatureChecks.resize(firstCheck);
+        if (!verifyRingSignatures(signatureChecks, failedTransaction))
+        {
+          logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has at least one transaction with wrong inputs: " << blockData.transactionHashes[failedTransaction];
+        }
+        else
+        {
+          logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has at least one invalid transaction: " << tx_id;
+        }
+
         bvc.m_verification_failed = true;
 
         block.transactions.pop_back();
@@ -2569,6 +2999,14 @@ namespace cn
       interestSummary += m_currency.calculateTotalTransactionInterest(transactions[i], block.height);
     }
 
+    if (!verifyRingSignatures(signatureChecks, failedTransaction))
+    {
+      logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has at least one transaction with wrong inputs: " << blockData.transactionHashes[failedTransaction];
+      bvc.m_verification_failed = true;
+      popTransactions(block, minerTransactionHash);
+      return false;
+    }
+
     if (!checkCumulativeBlockSize(blockHash, cumulative_block_size, block.height))
     {
       bvc.m_verification_failed = true;
@@ -2577,7 +3015,7 @@ namespace cn
 
     int64_t emissionChange = 0;
     uint64_t reward = 0;
-    uint64_t already_generated_coins = m_blocks.empty() ? 0 : m_blocks.back().already_generated_coins;
+    uint64_t already_generated_coins = m_blocks.empty() ? 0 : m_headerColumns.alreadyGeneratedCoins(m_blocks.size() - 1);
     if (!validate_miner_transaction(blockData, block.height, cumulative_block_size, already_generated_coins, fee_summary, reward, emissionChange))
     {
       logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has invalid miner transaction";
@@ -2592,7 +3030,7 @@ namespace cn
     block.already_generated_coins = already_generated_coins + emissionChange + interestSummary;
     if (m_blocks.size() > 0)
     {
-      block.cumulative_difficulty += m_blocks.back().cumulative_difficulty;
+      block.cumulative_difficulty += m_headerColumns.cumulativeDifficulty(m_blocks.size() - 1);
     }
 
     pushBlock(block);
@@ -2621,19 +3059,19 @@ namespace cn
 
   uint64_t Blockchain::fullDepositAmount() const
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_depositIndex.fullDepositAmount();
   }
 
   uint64_t Blockchain::depositAmountAtHeight(size_t height) const
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_depositIndex.depositAmountAtHeight(static_cast<DepositIndex::DepositHeight>(height));
   }
 
   uint64_t Blockchain::depositInterestAtHeight(size_t height) const
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_depositIndex.depositInterestAtHeight(static_cast<DepositIndex::DepositHeight>(height));
   }
 
@@ -2668,17 +3106,66 @@ namespace cn
     m_depositIndex.pushBlock(deposit, interest);
   }
 
+  BlockHeaderColumns::Header Blockchain::headerOf(const BlockEntry &block)
+  {
+    BlockHeaderColumns::Header header;
+    header.timestamp = block.bl.timestamp;
+    header.cumulativeDifficulty = block.cumulative_difficulty;
+    header.cumulativeSize = block.block_cumulative_size;
+    header.alreadyGeneratedCoins = block.already_generated_coins;
+    header.reward = getOutputAmount(block.bl.baseTransaction);
+    header.nonce = block.bl.nonce;
+    header.majorVersion = block.bl.majorVersion;
+    header.minorVersion = block.bl.minorVersion;
+    return header;
+  }
+
+  BlockBlobIndex::Layout Blockchain::layoutOf(const BlockEntry &block)
+  {
+    // writes the entry field by field the way BlockEntry::serialize stores it, noting where each blob lies
+    BlockEntry &entry = const_cast<BlockEntry &>(block);
+    BinaryArray blob;
+    common::VectorOutputStream stream(blob);
+    BinaryOutputStreamSerializer s(stream);
+
+    BlockBlobIndex::Layout layout;
+    s(entry.bl, "block");
+    layout.blockSize = static_cast<uint32_t>(blob.size());
+    s(entry.height, "height");
+    s(entry.block_cumulative_size, "block_cumulative_size");
+    s(entry.cumulative_difficulty, "cumulative_difficulty");
+    s(entry.already_generated_coins, "already_generated_coins");
+
+    size_t count = entry.transactions.size();
+    s.beginArray(count, "transactions");
+    for (TransactionEntry &transaction : entry.transactions)
+    {
+      uint32_t offset = static_cast<uint32_t>(blob.size());
+      s(transaction.tx, "tx");
+      layout.transactions.emplace_back(offset, static_cast<uint32_t>(blob.size()) - offset);
+      s(transaction.m_global_output_indexes, "indexes");
+    }
+    s.endArray();
+
+    layout.entrySize = static_cast<uint32_t>(blob.size());
+    return layout;
+  }
+
   bool Blockchain::pushBlock(const BlockEntry &block)
   {
     crypto::Hash blockHash = get_block_hash(block.bl);
 
     m_blocks.push_back(block);
     m_blockIndex.push(blockHash);
+    m_headerColumns.push(headerOf(block));
+    m_blobIndex.push(layoutOf(block));
+    ++m_cacheJournalTail;
 
     m_timestampIndex.add(block.bl.timestamp, blockHash);
     m_generatedTransactionsIndex.add(block.bl);
 
     assert(m_blockIndex.size() == m_blocks.size());
+    m_tx_pool.on_blockchain_inc(m_blocks.size(), blockHash);
 
     return true;
   }
@@ -2701,6 +3188,7 @@ namespace cn
     auto height = static_cast<uint32_t>(m_blocks.size()); //height of popped block should be same as number of blocks
     saveTransactions(transactions, height);
 
+    journalPoppedBlock();
     popTransactions(m_blocks.back(), getObjectHash(m_blocks.back().bl.baseTransaction));
 
     m_timestampIndex.remove(m_blocks.back().bl.timestamp, blockHash);
@@ -2709,6 +3197,8 @@ namespace cn
     m_depositIndex.popBlock();
     m_blocks.pop_back();
     m_blockIndex.pop();
+    m_headerColumns.pop();
+    m_blobIndex.pop();
 
     assert(m_blockIndex.size() == m_blocks.size());
 
@@ -2717,6 +3207,7 @@ namespace cn
     m_upgradeDetectorV4.blockPopped();
     m_upgradeDetectorV7.blockPopped();
     m_upgradeDetectorV8.blockPopped();
+    m_tx_pool.on_blockchain_dec(m_blocks.size(), getTailId());
   }
 
   bool Blockchain::pushTransaction(BlockEntry &block, const crypto::Hash &transactionHash, TransactionIndex transactionIndex)
@@ -2774,9 +3265,9 @@ namespace cn
     {
       if (transaction.tx.outputs[output].target.type() == typeid(KeyOutput))
       {
-        auto &amountOutputs = m_outputs[transaction.tx.outputs[output].amount];
-        transaction.m_global_output_indexes[output] = static_cast<uint32_t>(amountOutputs.size());
-        amountOutputs.push_back(std::make_pair<>(transactionIndex, output));
+        const TransactionOutput &out = transaction.tx.outputs[output];
+        transaction.m_global_output_indexes[output] = m_outputs[out.amount].push(transactionIndex.block, transactionIndex.transaction, static_cast<uint16_t>(output),
+                                                                                 boost::get<KeyOutput>(out.target).key, transaction.tx.unlockTime);
       }
       else if (transaction.tx.outputs[output].target.type() == typeid(MultisignatureOutput))
       {
@@ -2815,21 +3306,22 @@ namespace cn
           continue;
         }
 
-        if (amountOutputs->second.back().first.block != transactionIndex.block || amountOutputs->second.back().first.transaction != transactionIndex.transaction)
+        size_t last = amountOutputs->second.size() - 1;
+        if (amountOutputs->second.block(last) != transactionIndex.block || amountOutputs->second.transaction(last) != transactionIndex.transaction)
         {
           logger(ERROR, BRIGHT_RED) << "Blockchain consistency broken - invalid transaction index.";
 
           continue;
         }
 
-        if (amountOutputs->second.back().second != transaction.outputs.size() - 1 - outputIndex)
+        if (amountOutputs->second.output(last) != transaction.outputs.size() - 1 - outputIndex)
         {
           logger(ERROR, BRIGHT_RED) << "Blockchain consistency broken - invalid output index.";
 
           continue;
         }
 
-        amountOutputs->second.pop_back();
+        amountOutputs->second.pop();
         if (amountOutputs->second.empty())
         {
           m_outputs.erase(amountOutputs);
@@ -3021,6 +3513,7 @@ namespace cn
     }
 
     logger(DEBUGGING) << "Removing last block with height " << m_blocks.back().height;
+    journalPoppedBlock();
     popTransactions(m_blocks.back(), getObjectHash(m_blocks.back().bl.baseTransaction));
 
     crypto::Hash blockHash = getBlockIdByHeight(m_blocks.back().height);
@@ -3029,14 +3522,17 @@ namespace cn
 
     m_blocks.pop_back();
     m_blockIndex.pop();
+    m_headerColumns.pop();
+    m_blobIndex.pop();
 
     assert(m_blockIndex.size() == m_blocks.size());
+    m_tx_pool.on_blockchain_dec(m_blocks.size(), getTailId());
     return true;
   }
 
   bool Blockchain::getLowerBound(uint64_t timestamp, uint64_t startOffset, uint32_t &height)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     assert(startOffset < m_blocks.size());
 
@@ -3054,13 +3550,13 @@ namespace cn
 
   std::vector<crypto::Hash> Blockchain::getBlockIds(uint32_t startHeight, uint32_t maxCount)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_blockIndex.getBlockIds(startHeight, maxCount);
   }
 
   bool Blockchain::getBlockContainingTransaction(const crypto::Hash &txId, crypto::Hash &blockId, uint32_t &blockHeight)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     auto it = m_transactionMap.find(txId);
     if (it == m_transactionMap.end())
     {
@@ -3076,13 +3572,13 @@ namespace cn
 
   bool Blockchain::getAlreadyGeneratedCoins(const crypto::Hash &hash, uint64_t &generatedCoins)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     // try to find block in main chain
     uint32_t height = 0;
     if (m_blockIndex.getBlockHeight(hash, height))
     {
-      generatedCoins = m_blocks[height].already_generated_coins;
+      generatedCoins = m_headerColumns.alreadyGeneratedCoins(height);
       return true;
     }
 
@@ -3100,13 +3596,13 @@ namespace cn
 
   bool Blockchain::getBlockSize(const crypto::Hash &hash, size_t &size)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     // try to find block in main chain
     uint32_t height = 0;
     if (m_blockIndex.getBlockHeight(hash, height))
     {
-      size = m_blocks[height].block_cumulative_size;
+      size = m_headerColumns.cumulativeSize(height);
       return true;
     }
 
@@ -3124,7 +3620,7 @@ namespace cn
 
   bool Blockchain::getMultisigOutputReference(const MultisignatureInput &txInMultisig, std::pair<crypto::Hash, size_t> &outputReference)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     MultisignatureOutputsContainer::const_iterator amountIter = m_multisignatureOutputs.find(txInMultisig.amount);
     if (amountIter == m_multisignatureOutputs.end())
     {
@@ -3145,7 +3641,7 @@ namespace cn
 
   bool Blockchain::storeBlockchainIndices()
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
 
     logger(INFO, BRIGHT_WHITE) << "Saving blockchain indices";
     BlockchainIndicesSerializer ser(*this, getTailId(), logger.getLogger());
@@ -3201,25 +3697,25 @@ namespace cn
 
   bool Blockchain::getGeneratedTransactionsNumber(uint32_t height, uint64_t &generatedTransactions)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_generatedTransactionsIndex.find(height, generatedTransactions);
   }
 
   bool Blockchain::getOrphanBlockIdsByHeight(uint32_t height, std::vector<crypto::Hash> &blockHashes)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_orthanBlocksIndex.find(height, blockHashes);
   }
 
   bool Blockchain::getBlockIdsByTimestamp(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t blocksNumberLimit, std::vector<crypto::Hash> &hashes, uint32_t &blocksNumberWithinTimestamps)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_timestampIndex.find(timestampBegin, timestampEnd, blocksNumberLimit, hashes, blocksNumberWithinTimestamps);
   }
 
   bool Blockchain::getTransactionIdsByPaymentId(const crypto::Hash &paymentId, std::vector<crypto::Hash> &transactionHashes)
   {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     return m_paymentIdIndex.find(paymentId, transactionHashes);
   }
 
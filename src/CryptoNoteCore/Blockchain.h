@@ -13,7 +13,13 @@
 #include <parallel_hashmap/phmap.h>
 
 #include "Common/ObserverManager.h"
+#include "Common/RecursiveSharedMutex.h"
+#include "Common/WorkerPool.h"
 #include "Common/Util.h"
+#include "CryptoNoteCore/AmountOutputs.h"
+#include "CryptoNoteCore/BlockBlobIndex.h"
+#include "CryptoNoteCore/BlockCacheJournal.h"
+#include "CryptoNoteCore/BlockHeaderColumns.h"
 #include "CryptoNoteCore/BlockIndex.h"
 #include "CryptoNoteCore/Checkpoints.h"
 #include "CryptoNoteCore/Currency.h"
@@ -29,6 +35,8 @@
 #include "CryptoNoteCore/MessageQueue.h"
 #include "CryptoNoteCore/BlockchainMessages.h"
 #include "CryptoNoteCore/IntrusiveLinkedList.h"
+#include "CryptoNoteCore/LongHashPool.h"
+#include "CryptoNoteCore/RingSignatureCache.h"
 
 #include <Logging/LoggerRef.h>
 
@@ -36,6 +44,7 @@
 using phmap::parallel_flat_hash_map;
 namespace cn
 {
+  struct block_complete_entry;
   struct NOTIFY_REQUEST_GET_OBJECTS_request;
   struct NOTIFY_RESPONSE_GET_OBJECTS_request;
   struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_request;
@@ -62,7 +71,7 @@ namespace cn
     bool checkTransactionSize(size_t blobSize) override;
 
     bool init() { return init(tools::getDefaultDataDirectory(), true, m_testnet); }
-    bool init(const std::string &config_folder, bool load_existing, bool testnet);
+    bool init(const std::string &config_folder, bool load_existing, bool testnet, bool memoryMappedBlocks = false, size_t blocksCacheSize = BLOCKS_CACHE_DEFAULT_SIZE);
     bool deinit();
 
     bool getLowerBound(uint64_t timestamp, uint64_t startOffset, uint32_t &height);
@@ -120,10 +129,14 @@ namespace cn
     bool getTransactionIdsByPaymentId(const crypto::Hash &paymentId, std::vector<crypto::Hash> &transactionHashes);
     bool isBlockInMainChain(const crypto::Hash &blockId) const;
     uint64_t fullDepositAmount() const;
+    const RingSignatureCache &getRingSignatureCache() const { return m_ringSignatureCache; }
+    void precomputeProofOfWork(const Block &block, const crypto::Hash &blockHash);
     uint64_t depositAmountAtHeight(size_t height) const;
     uint64_t depositInterestAtHeight(size_t height) const;
     uint64_t coinsEmittedAtHeight(uint64_t height);
     uint64_t difficultyAtHeight(uint64_t height);
+    bool getBlockHeader(uint32_t height, BlockHeaderColumns::Header &header);
+    bool getBlockBlobs(uint32_t height, block_complete_entry &entry);
     bool isInCheckpointZone(const uint32_t height) const;
 
     template <class visitor_t>
@@ -137,7 +150,7 @@ namespace cn
     template <class t_ids_container, class t_blocks_container, class t_missed_container>
     bool getBlocks(const t_ids_container &block_ids, t_blocks_container &blocks, t_missed_container &missed_bs)
     {
-      std::lock_guard<std::recursive_mutex> lk(m_blockchain_lock);
+      ReadLock lk(*this);
 
       for (const auto &bl_id : block_ids)
       {
@@ -164,7 +177,7 @@ namespace cn
     template <class t_ids_container, class t_tx_container, class t_missed_container>
     void getBlockchainTransactions(const t_ids_container &txs_ids, t_tx_container &txs, t_missed_container &missed_txs)
     {
-      std::lock_guard<decltype(m_blockchain_lock)> bcLock(m_blockchain_lock);
+      ReadLock bcLock(*this);
 
       for (const auto &tx_id : txs_ids)
       {
@@ -220,6 +233,31 @@ namespace cn
     bool have_tx_keyimg_as_spent(const crypto::KeyImage &key_im);
 
   private:
+    // Shared ownership of the chain state for read-only queries. Block entries evicted from the
+    // blocks cache meanwhile stay alive until the last concurrent query is done with them.
+    class ReadLock
+    {
+    public:
+      explicit ReadLock(const Blockchain &bc) : m_bc(bc)
+      {
+        m_bc.m_blockchain_lock.lock_shared();
+        m_blocksEpoch = m_bc.m_blocks.addReader();
+      }
+
+      ~ReadLock()
+      {
+        m_bc.m_blocks.removeReader(m_blocksEpoch);
+        m_bc.m_blockchain_lock.unlock_shared();
+      }
+
+      ReadLock(const ReadLock &) = delete;
+      ReadLock &operator=(const ReadLock &) = delete;
+
+    private:
+      const Blockchain &m_bc;
+      uint64_t m_blocksEpoch;
+    };
+
     bool m_testnet = false;
     struct MultisignatureOutputUsage
     {
@@ -267,15 +305,28 @@ namespace cn
       }
     };
 
+    // Ring signature of one key input, verified after the rest of the block
+    struct RingSignatureCheck
+    {
+      size_t transaction;
+      crypto::Hash prefixHash;
+      crypto::KeyImage keyImage;
+      std::vector<crypto::PublicKey> outputKeys;
+      const crypto::Signature *signatures;
+    };
+
     using key_images_container = parallel_flat_hash_map<crypto::KeyImage, uint32_t>;
     using blocks_ext_by_hash = parallel_flat_hash_map<crypto::Hash, BlockEntry>;
-    using outputs_container = parallel_flat_hash_map<uint64_t, std::vector<std::pair<TransactionIndex, uint16_t>>>; //crypto::Hash - tx hash, size_t - index of out in transaction
+    using outputs_container = parallel_flat_hash_map<uint64_t, AmountOutputs>;
     using MultisignatureOutputsContainer = parallel_flat_hash_map<uint64_t, std::vector<MultisignatureOutputUsage>>;
 
     const Currency &m_currency;
     tx_memory_pool &m_tx_pool;
-    mutable std::recursive_mutex m_blockchain_lock; // TODO: add here reader/writer lock
+    mutable tools::RecursiveSharedMutex m_blockchain_lock; // exclusive for chain updates, shared for queries
     crypto::cn_context m_cn_context;
+    LongHashPool m_longHashPool; // proof of work of blocks hashed before their commit
+    std::unique_ptr<tools::WorkerPool> m_signatureVerificationPool;
+    RingSignatureCache m_ringSignatureCache;
     tools::ObserverManager<IBlockchainStorageObserver> m_observerManager;
 
     key_images_container m_spent_keys;
@@ -284,6 +335,8 @@ namespace cn
     outputs_container m_outputs;
 
     std::string m_config_folder;
+    bool m_memoryMappedBlocks = false;
+    size_t m_blocksCacheSize = BLOCKS_CACHE_DEFAULT_SIZE;
     Checkpoints m_checkpoints;
     std::atomic<bool> m_is_in_checkpoint_zone;
 
@@ -297,6 +350,8 @@ namespace cn
 
     Blocks m_blocks;
     cn::BlockIndex m_blockIndex;
+    BlockHeaderColumns m_headerColumns; // header fields of m_blocks, kept in step with m_blockIndex
+    BlockBlobIndex m_blobIndex;         // blob layout of m_blocks, kept in step with m_blockIndex
     cn::DepositIndex m_depositIndex;
     TransactionMap m_transactionMap;
     MultisignatureOutputsContainer m_multisignatureOutputs;
@@ -308,6 +363,9 @@ namespace cn
 
     bool m_blockchainIndexesEnabled;
     bool m_blockchainAutosaveEnabled;
+    BlockCacheJournal m_cacheJournal; // popped blocks the cache snapshot still indexes
+    uint32_t m_cacheJournalTail;      // blocks pushed or popped since the cache snapshot
+    std::mutex m_cacheSaveMutex;      // storeCache runs under the shared lock, saves are serialized by this
     PaymentIdIndex m_paymentIdIndex;
     TimestampBlocksIndex m_timestampIndex;
     GeneratedTransactionsIndex m_generatedTransactionsIndex;
@@ -322,13 +380,20 @@ namespace cn
     bool handle_alternative_block(const Block &b, const crypto::Hash &id, block_verification_context &bvc, bool sendNewAlternativeBlockMessage = true);
     difficulty_type get_next_difficulty_for_alternative_chain(const std::list<crypto::Hash> &alt_chain, const BlockEntry &bei);
     void pushToDepositIndex(const BlockEntry &block, uint64_t interest);
+    static BlockHeaderColumns::Header headerOf(const BlockEntry &block);
+    static BlockBlobIndex::Layout layoutOf(const BlockEntry &block);
     bool prevalidate_miner_transaction(const Block &b, uint32_t height) const;
+    uint32_t resumeCacheRebuild(const std::string &progressFile);
+    void indexBlocks(uint32_t startHeight, const std::string &progressFile);
+    void clearCache();
+    bool replayCacheJournal(const crypto::Hash &lastBlockHash);
+    void journalPoppedBlock();
     bool validate_miner_transaction(const Block &b, uint32_t height, size_t cumulativeBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee, uint64_t &reward, int64_t &emissionChange);
     bool rollback_blockchain_switching(const std::list<Block> &original_chain, size_t rollback_height);
     bool get_last_n_blocks_sizes(std::vector<size_t> &sz, size_t count);
-    bool add_out_to_get_random_outs(std::vector<std::pair<TransactionIndex, uint16_t>> &amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_outs_for_amount &result_outs, uint64_t amount, size_t i);
+    bool add_out_to_get_random_outs(const AmountOutputs &amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_outs_for_amount &result_outs, uint64_t amount, size_t i);
     bool is_tx_spendtime_unlocked(uint64_t unlock_time);
-    size_t find_end_of_allowed_index(const std::vector<std::pair<TransactionIndex, uint16_t>> &amount_outs);
+    size_t find_end_of_allowed_index(const AmountOutputs &amount_outs);
     bool check_block_timestamp_main(const Block &b);
     bool check_block_timestamp(std::vector<uint64_t> timestamps, const Block &b);
     uint64_t get_adjusted_time() const;
@@ -338,8 +403,12 @@ namespace cn
     std::vector<crypto::Hash> doBuildSparseChain(const crypto::Hash &startBlockId) const;
     bool getBlockCumulativeSize(const Block &block, size_t &cumulativeSize);
     bool update_next_comulative_size_limit();
-    bool check_tx_input(const KeyInput &txin, const crypto::Hash &tx_prefix_hash, const std::vector<crypto::Signature> &sig, uint32_t *pmax_related_block_height = nullptr);
-    bool checkTransactionInputs(const Transaction &tx, const crypto::Hash &tx_prefix_hash, uint32_t *pmax_used_block_height = nullptr);
+    bool check_tx_input(const KeyInput &txin, const crypto::Hash &tx_prefix_hash, const std::vector<crypto::Signature> &sig, uint32_t *pmax_related_block_height, std::vector<RingSignatureCheck> &signatureChecks);
+    bool checkTransactionInputs(const Transaction &tx, const crypto::Hash &tx_prefix_hash, uint32_t *pmax_used_block_height = nullptr, std::vector<RingSignatureCheck> *deferredChecks = nullptr);
+    static void checkRingSignatures(const RingSignatureCheck *checks, size_t count, bool *passed);
+    static crypto::Hash ringSignaturesDigest(const RingSignatureCheck *checks, size_t count);
+    bool checkProofOfWork(const Block &block, const crypto::Hash &blockHash, difficulty_type currentDifficulty, crypto::Hash &proofOfWork);
+    bool verifyRingSignatures(const std::vector<RingSignatureCheck> &checks, size_t &failedTransaction);
     bool checkTransactionInputs(const Transaction &tx, uint32_t *pmax_used_block_height = nullptr);
 
     const TransactionEntry &transactionByIndex(TransactionIndex index);
@@ -362,6 +431,7 @@ namespace cn
     void sendMessage(const BlockchainMessage &message);
 
     friend class LockedBlockchainStorage;
+    friend class ReadLockedBlockchainStorage;
   };
 
   class LockedBlockchainStorage : private boost::noncopyable
@@ -377,19 +447,36 @@ namespace cn
 
   private:
     Blockchain &m_bc;
-    std::lock_guard<std::recursive_mutex> m_lock;
+    std::lock_guard<tools::RecursiveSharedMutex> m_lock;
+  };
+
+  // Same as LockedBlockchainStorage, but only for read-only access, which may run concurrently
+  class ReadLockedBlockchainStorage : private boost::noncopyable
+  {
+  public:
+    explicit ReadLockedBlockchainStorage(Blockchain &bc)
+        : m_bc(bc), m_lock(bc) {}
+
+    Blockchain *operator->()
+    {
+      return &m_bc;
+    }
+
+  private:
+    Blockchain &m_bc;
+    Blockchain::ReadLock m_lock;
   };
 
   template <class visitor_t>
   bool Blockchain::scanOutputKeysForIndexes(const KeyInput &tx_in_to_key, visitor_t &vis, uint32_t *pmax_related_block_height)
   {
-    std::lock_guard<std::recursive_mutex> lk(m_blockchain_lock);
+    ReadLock lk(*this);
     auto it = m_outputs.find(tx_in_to_key.amount);
     if (it == m_outputs.end() || !tx_in_to_key.outputIndexes.size())
       return false;
 
     std::vector<uint32_t> absolute_offsets = relative_output_offsets_to_absolute(tx_in_to_key.outputIndexes);
-    std::vector<std::pair<TransactionIndex, uint16_t>> &amount_outs_vec = it->second;
+    const AmountOutputs &amount_outs_vec = it->second;
     size_t count = 0;
     for (uint64_t i : absolute_offsets)
     {
@@ -399,26 +486,26 @@ namespace cn
         return false;
       }
 
-      const TransactionEntry &tx = transactionByIndex(amount_outs_vec[i].first);
+      const TransactionEntry &tx = transactionByIndex({amount_outs_vec.block(i), amount_outs_vec.transaction(i)});
 
-      if (!(amount_outs_vec[i].second < tx.tx.outputs.size()))
+      if (!(amount_outs_vec.output(i) < tx.tx.outputs.size()))
       {
         logger(logging::ERROR, logging::BRIGHT_RED)
             << "Wrong index in transaction outputs: "
-            << amount_outs_vec[i].second << ", expected less then "
+            << amount_outs_vec.output(i) << ", expected less then "
             << tx.tx.outputs.size();
         return false;
       }
 
-      if (!vis.handle_output(tx.tx, tx.tx.outputs[amount_outs_vec[i].second], amount_outs_vec[i].second))
+      if (!vis.handle_output(tx.tx, tx.tx.outputs[amount_outs_vec.output(i)], amount_outs_vec.output(i)))
       {
         logger(logging::INFO) << "Failed to handle_output for output no = " << count << ", with absolute offset " << i;
         return false;
       }
 
-      if (count++ == absolute_offsets.size() - 1 && pmax_related_block_height && *pmax_related_block_height < amount_outs_vec[i].first.block)
+      if (count++ == absolute_offsets.size() - 1 && pmax_related_block_height && *pmax_related_block_height < amount_outs_vec.block(i))
       {
-        *pmax_related_block_height = amount_outs_vec[i].first.block;
+        *pmax_related_block_height = amount_outs_vec.block(i);
       }
     }
 
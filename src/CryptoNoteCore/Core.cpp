@@ -161,7 +161,7 @@ bool core::init(const CoreConfig& config, const MinerConfig& minerConfig, bool l
     return false;
   }
   
-  r = m_blockchain.init(m_config_folder, load_existing, config.testnet);
+  r = m_blockchain.init(m_config_folder, load_existing, config.testnet, config.memoryMappedBlocks, config.blocksCacheSize);
   if (!(r)) {
     logger(ERROR, BRIGHT_RED) << "Failed to initialize blockchain storage";
     return false;
@@ -581,6 +581,10 @@ bool core::handle_incoming_block_blob(const BinaryArray& block_blob, block_verif
   return handle_incoming_block(b, bvc, control_miner, relay_block);
 }
 
+void core::precomputeProofOfWork(const Block& b, const crypto::Hash& blockHash) {
+  m_blockchain.precomputeProofOfWork(b, blockHash);
+}
+
 bool core::handle_incoming_block(const Block& b, block_verification_context& bvc, bool control_miner, bool relay_block) {
   if (control_miner) {
     pause_mining();
@@ -664,7 +668,7 @@ std::vector<crypto::Hash> core::buildSparseChain() {
 }
 
 std::vector<crypto::Hash> core::buildSparseChain(const crypto::Hash& startBlockId) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  ReadLockedBlockchainStorage lbs(m_blockchain);
   assert(m_blockchain.haveBlock(startBlockId));
   return m_blockchain.buildSparseChain(startBlockId);
 }
@@ -674,7 +678,7 @@ bool core::handle_get_objects(NOTIFY_REQUEST_GET_OBJECTS::request& arg, NOTIFY_R
 }
 
 crypto::Hash core::getBlockIdByHeight(uint32_t height) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  ReadLockedBlockchainStorage lbs(m_blockchain);
   if (height < m_blockchain.getCurrentBlockchainHeight()) {
     return m_blockchain.getBlockIdByHeight(height);
   } else {
@@ -698,6 +702,16 @@ uint64_t core::difficultyAtHeight(uint64_t height) {
   return m_blockchain.difficultyAtHeight(height);
 }
 
+bool core::getBlockHeader(uint32_t height, BlockHeaderColumns::Header& header) {
+  return m_blockchain.getBlockHeader(height, header);
+}
+
+bool core::getBlockBlobs(const crypto::Hash& blockId, block_complete_entry& entry) {
+  ReadLockedBlockchainStorage lbs(m_blockchain);
+  uint32_t height;
+  return lbs->getBlockHeight(blockId, height) && lbs->getBlockBlobs(height, entry);
+}
+
 //void core::get_all_known_block_ids(std::list<crypto::Hash> &main, std::list<crypto::Hash> &alt, std::list<crypto::Hash> &invalid) {
 //  m_blockchain.get_all_known_block_ids(main, alt, invalid);
 //}
@@ -750,7 +764,7 @@ void core::poolUpdated() {
 bool core::queryBlocks(const std::vector<crypto::Hash>& knownBlockIds, uint64_t timestamp,
   uint32_t& resStartHeight, uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<BlockFullInfo>& entries) {
 
-  LockedBlockchainStorage lbs(m_blockchain);
+  ReadLockedBlockchainStorage lbs(m_blockchain);
 
   uint32_t currentHeight = lbs->getCurrentBlockchainHeight();
   uint32_t startOffset = 0;
@@ -778,26 +792,15 @@ bool core::queryBlocks(const std::vector<crypto::Hash>& knownBlockIds, uint64_t
     return true;
   }
 
-  std::list<Block> blocks;
-  lbs->getBlocks(startFullOffset, blocksLeft, blocks);
-
-  for (auto& b : blocks) {
+  // ids and timestamps come from the index and the blobs are copied as stored, nothing is decoded
+  uint32_t endHeight = std::min(startFullOffset + blocksLeft, currentHeight);
+  for (uint32_t height = startFullOffset; height < endHeight; ++height) {
     BlockFullInfo item;
 
-    item.block_id = get_block_hash(b);
+    item.block_id = lbs->getBlockIdByHeight(height);
 
-    if (b.timestamp >= timestamp) {
-      // query transactions
-      std::list<Transaction> txs;
-      std::list<crypto::Hash> missedTxs;
-      lbs->getTransactions(b.transactionHashes, txs, missedTxs);
-
-      // fill data
-      block_complete_entry& completeEntry = item;
-      completeEntry.block = asString(toBinaryArray(b));
-      for (auto& tx : txs) {
-        completeEntry.txs.push_back(asString(toBinaryArray(tx)));
-      }
+    if (lbs->getBlockTimestamp(height) >= timestamp) {
+      lbs->getBlockBlobs(height, item);
     }
 
     entries.push_back(std::move(item));
@@ -807,7 +810,7 @@ bool core::queryBlocks(const std::vector<crypto::Hash>& knownBlockIds, uint64_t
 }
 
 bool core::findStartAndFullOffsets(const std::vector<crypto::Hash>& knownBlockIds, uint64_t timestamp, uint32_t& startOffset, uint32_t& startFullOffset) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  ReadLockedBlockchainStorage lbs(m_blockchain);
 
   if (knownBlockIds.empty()) {
     logger(ERROR, BRIGHT_RED) << "knownBlockIds is empty";
@@ -830,7 +833,7 @@ bool core::findStartAndFullOffsets(const std::vector<crypto::Hash>& knownBlockId
 std::vector<crypto::Hash> core::findIdsForShortBlocks(uint32_t startOffset, uint32_t startFullOffset) {
   assert(startOffset <= startFullOffset);
 
-  LockedBlockchainStorage lbs(m_blockchain);
+  ReadLockedBlockchainStorage lbs(m_blockchain);
 
   std::vector<crypto::Hash> result;
   if (startOffset < startFullOffset) {
@@ -842,7 +845,7 @@ std::vector<crypto::Hash> core::findIdsForShortBlocks(uint32_t startOffset, uint
 
 bool core::queryBlocksLite(const std::vector<crypto::Hash>& knownBlockIds, uint64_t timestamp, uint32_t& resStartHeight,
   uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<BlockShortInfo>& entries) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  ReadLockedBlockchainStorage lbs(m_blockchain);
 
   resCurrentHeight = lbs->getCurrentBlockchainHeight();
   resStartHeight = 0;
@@ -1060,6 +1063,14 @@ uint64_t core::fullDepositAmount() const {
   return m_blockchain.fullDepositAmount();
 }
 
+uint64_t core::ringSignatureCacheHits() const {
+  return m_blockchain.getRingSignatureCache().hits();
+}
+
+uint64_t core::ringSignatureCacheMisses() const {
+  return m_blockchain.getRingSignatureCache().misses();
+}
+
 uint64_t core::depositAmountAtHeight(size_t height) const {
   return m_blockchain.depositAmountAtHeight(height);
 }
@@ -1101,10 +1112,27 @@ bool core::handleIncomingTransaction(const Transaction& tx, const crypto::Hash&
 }
 
 std::unique_ptr<IBlock> core::getBlock(const crypto::Hash& blockId) {
+  std::unique_ptr<BlockWithTransactions> blockPtr(new BlockWithTransactions());
+
+  {
+    // Main chain blocks have all their transactions in the blockchain, so they don't need the pool
+    ReadLockedBlockchainStorage lbs(m_blockchain);
+    if (lbs->isBlockInMainChain(blockId) && lbs->getBlockByHash(blockId, blockPtr->block)) {
+      blockPtr->transactions.reserve(blockPtr->block.transactionHashes.size());
+      std::vector<crypto::Hash> missedTxs;
+      lbs->getTransactions(blockPtr->block.transactionHashes, blockPtr->transactions, missedTxs);
+      if (!missedTxs.empty()) {
+        logger(ERROR, BRIGHT_RED) << "Can't find transactions for main chain block: " << blockId;
+        return std::unique_ptr<BlockWithTransactions>(nullptr);
+      }
+
+      return blockPtr;
+    }
+  }
+
   std::lock_guard<decltype(m_mempool)> lk(m_mempool);
   LockedBlockchainStorage lbs(m_blockchain);
 
-  std::unique_ptr<BlockWithTransactions> blockPtr(new BlockWithTransactions());
   if (!lbs->getBlockByHash(blockId, blockPtr->block)) {
     logger(DEBUGGING) << "Can't find block: " << blockId;
     return std::unique_ptr<BlockWithTransactions>(nullptr);
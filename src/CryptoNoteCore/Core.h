@@ -41,6 +41,7 @@ namespace cn {
      bool on_idle() override;
      virtual bool handle_incoming_tx(const BinaryArray& tx_blob, tx_verification_context& tvc, bool keeped_by_block) override; //Deprecated. Should be removed with CryptoNoteProtocolHandler.
      bool handle_incoming_block_blob(const BinaryArray& block_blob, block_verification_context& bvc, bool control_miner, bool relay_block) override;
+     void precomputeProofOfWork(const Block& b, const crypto::Hash& blockHash) override;
      virtual i_cryptonote_protocol* get_protocol() override {return m_pprotocol;}
      virtual const Currency& currency() const override { return m_currency; }
 
@@ -115,6 +116,8 @@ namespace cn {
     size_t get_alternative_blocks_count();
     uint64_t coinsEmittedAtHeight(uint64_t height);
     uint64_t difficultyAtHeight(uint64_t height);
+    bool getBlockHeader(uint32_t height, BlockHeaderColumns::Header& header);
+    bool getBlockBlobs(const crypto::Hash& blockId, block_complete_entry& entry);
 
     void set_cryptonote_protocol(i_cryptonote_protocol *pprotocol);
     void set_checkpoints(Checkpoints &&chk_pts);
@@ -150,6 +153,8 @@ namespace cn {
     uint64_t getNextBlockDifficulty();
     uint64_t getTotalGeneratedAmount();
     uint64_t fullDepositAmount() const;
+    uint64_t ringSignatureCacheHits() const;
+    uint64_t ringSignatureCacheMisses() const;
     uint64_t depositAmountAtHeight(size_t height) const;
     uint64_t investmentAmountAtHeight(size_t height) const;
     uint64_t depositInterestAtHeight(size_t height) const;
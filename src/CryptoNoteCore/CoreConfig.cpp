@@ -9,10 +9,16 @@
 
 #include "Common/Util.h"
 #include "Common/CommandLine.h"
+#include "CryptoNoteConfig.h"
 
 namespace cn {
 
-CoreConfig::CoreConfig() {
+namespace {
+  const command_line::arg_descriptor<std::string> arg_block_storage = {"block-storage", "Block storage backend: 'stream' reads blocks through the file stream, 'mmap' decodes them from a memory mapped blocks file", "stream"};
+  const command_line::arg_descriptor<size_t> arg_blocks_cache_size = {"blocks-cache-size", "Number of decoded blocks kept in memory", BLOCKS_CACHE_DEFAULT_SIZE};
+}
+
+CoreConfig::CoreConfig() : blocksCacheSize(BLOCKS_CACHE_DEFAULT_SIZE) {
   configFolder = tools::getDefaultDataDirectory();
 }
 
@@ -30,8 +36,26 @@ void CoreConfig::init(const boost::program_options::variables_map &options)
     configFolder = tools::getDefaultDataDirectory(testnet);
     configFolderDefaulted = true;
   }
+
+  if (options.count(arg_block_storage.name) != 0)
+  {
+    const std::string blockStorage = command_line::get_arg(options, arg_block_storage);
+    if (blockStorage != "stream" && blockStorage != "mmap")
+    {
+      throw std::runtime_error("Unknown block storage backend: " + blockStorage);
+    }
+
+    memoryMappedBlocks = blockStorage == "mmap";
+  }
+
+  if (options.count(arg_blocks_cache_size.name) != 0)
+  {
+    blocksCacheSize = command_line::get_arg(options, arg_blocks_cache_size);
+  }
 }
 
-void CoreConfig::initOptions(const boost::program_options::options_description& desc) {
+void CoreConfig::initOptions(boost::program_options::options_description& desc) {
+  command_line::add_arg(desc, arg_block_storage);
+  command_line::add_arg(desc, arg_blocks_cache_size);
 }
 } //namespace cn
@@ -17,12 +17,14 @@ class CoreConfig {
 public:
   CoreConfig();
 
-  static void initOptions(const boost::program_options::options_description& desc);
+  static void initOptions(boost::program_options::options_description& desc);
   void init(const boost::program_options::variables_map& options);
 
   std::string configFolder;
   bool configFolderDefaulted = true;
   bool testnet = false;
+  bool memoryMappedBlocks = false;
+  size_t blocksCacheSize;
 };
 
 } //namespace cn
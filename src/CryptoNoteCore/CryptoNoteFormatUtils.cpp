@@ -475,10 +475,17 @@ bool lookup_acc_outs(const AccountKeys& acc, const Transaction& tx, const Public
 }
 
 bool get_block_hashing_blob(const Block& b, BinaryArray& ba) {
+  size_t nonceOffset;
+  return get_block_hashing_blob(b, ba, nonceOffset);
+}
+
+bool get_block_hashing_blob(const Block& b, BinaryArray& ba, size_t& nonceOffset) {
   if (!toBinaryArray(static_cast<const BlockHeader&>(b), ba)) {
     return false;
   }
 
+  // the nonce closes the serialized header
+  nonceOffset = ba.size() - sizeof(b.nonce);
   Hash treeRootHash = get_tx_tree_hash(b);
   ba.insert(ba.end(), treeRootHash.data, treeRootHash.data + 32);
   auto transactionCount = asBinaryArray(tools::get_varint_data(b.transactionHashes.size() + 1));
@@ -516,18 +523,20 @@ bool get_block_longhash(cn_context &context, const Block& b, Hash& res) {
     return false;
   }
 
-  if (b.majorVersion >= 8) {
+  get_block_longhash(context, b.majorVersion, bd, res);
+  return true;
+}
+
+void get_block_longhash(cn_context &context, uint8_t majorVersion, const BinaryArray& bd, Hash& res) {
+  if (majorVersion >= 8) {
     cn_gpu_hash_v0(context, bd.data(), bd.size(), res);
-  } else if (b.majorVersion >= 7) {
+  } else if (majorVersion >= 7) {
     cn_conceal_slow_hash_v0(context, bd.data(), bd.size(), res);
-  } else if (b.majorVersion >= 3) {
+  } else if (majorVersion >= 3) {
     cn_fast_slow_hash_v1(context, bd.data(), bd.size(), res);
   } else {
     cn_slow_hash_v0(context, bd.data(), bd.size(), res);
   }
-  
-
-  return true;
 }
 
 std::vector<uint32_t> relative_output_offsets_to_absolute(const std::vector<uint32_t>& off) {
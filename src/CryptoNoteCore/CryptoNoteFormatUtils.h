@@ -75,10 +75,13 @@ bool generate_key_image_helper(const AccountKeys& ack, const crypto::PublicKey&
 std::string short_hash_str(const crypto::Hash& h);
 
 bool get_block_hashing_blob(const Block& b, BinaryArray& blob);
+// nonceOffset is where the 4 nonce bytes lie in blob, miners patch them there instead of serializing the block again
+bool get_block_hashing_blob(const Block& b, BinaryArray& blob, size_t& nonceOffset);
 bool get_aux_block_header_hash(const Block& b, crypto::Hash& res);
 bool get_block_hash(const Block& b, crypto::Hash& res);
 crypto::Hash get_block_hash(const Block& b);
 bool get_block_longhash(crypto::cn_context &context, const Block& b, crypto::Hash& res);
+void get_block_longhash(crypto::cn_context &context, uint8_t majorVersion, const BinaryArray& hashingBlob, crypto::Hash& res);
 bool get_inputs_money_amount(const Transaction& tx, uint64_t& money);
 uint64_t get_outs_money_amount(const Transaction& tx);
 bool check_inputs_types_supported(const TransactionPrefix& tx);
@@ -0,0 +1,80 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "LongHashPool.h"
+
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+
+namespace cn
+{
+  LongHashPool::LongHashPool(size_t capacity, size_t maxIdleContexts) : m_capacity(capacity), m_maxIdleContexts(maxIdleContexts) {
+  }
+
+  void LongHashPool::compute(const Block& block, const crypto::Hash& blockHash) {
+    std::unique_ptr<crypto::cn_context> context = acquireContext();
+    crypto::Hash longHash;
+    bool hashed = get_block_longhash(*context, block, longHash);
+    releaseContext(std::move(context));
+    if (!hashed) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(blockHash);
+    if (it != m_index.end()) {
+      it->second->second = longHash;
+      return;
+    }
+
+    // the oldest hashes belong to blocks that were never committed, the batches being committed stay
+    while (!m_longHashes.empty() && m_longHashes.size() >= m_capacity) {
+      m_index.erase(m_longHashes.back().first);
+      m_longHashes.pop_back();
+    }
+
+    m_longHashes.emplace_front(blockHash, longHash);
+    m_index.emplace(blockHash, m_longHashes.begin());
+  }
+
+  bool LongHashPool::take(const crypto::Hash& blockHash, crypto::Hash& longHash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(blockHash);
+    if (it == m_index.end()) {
+      return false;
+    }
+
+    longHash = it->second->second;
+    m_longHashes.erase(it->second);
+    m_index.erase(it);
+    return true;
+  }
+
+  void LongHashPool::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_longHashes.clear();
+    m_index.clear();
+    m_contexts.clear();
+  }
+
+  std::unique_ptr<crypto::cn_context> LongHashPool::acquireContext() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_contexts.empty()) {
+        std::unique_ptr<crypto::cn_context> context = std::move(m_contexts.back());
+        m_contexts.pop_back();
+        return context;
+      }
+    }
+
+    return std::unique_ptr<crypto::cn_context>(new crypto::cn_context());
+  }
+
+  void LongHashPool::releaseContext(std::unique_ptr<crypto::cn_context> context) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_contexts.size() < m_maxIdleContexts) {
+      m_contexts.push_back(std::move(context));
+    }
+  }
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+#include "crypto/hash.h"
+
+namespace cn
+{
+  // Proof of work hashes of blocks computed ahead of their commit. compute() may be called from
+  // any number of threads at once, each caller hashes with a scratchpad of its own from the pool.
+  class LongHashPool {
+  public:
+    // keeps the hashes of at most capacity blocks and at most maxIdleContexts scratchpads between calls
+    LongHashPool(size_t capacity, size_t maxIdleContexts);
+
+    void compute(const Block& block, const crypto::Hash& blockHash);
+    // returns and forgets the long hash computed for the block, if any
+    bool take(const crypto::Hash& blockHash, crypto::Hash& longHash);
+    void clear();
+
+  private:
+    std::unique_ptr<crypto::cn_context> acquireContext();
+    void releaseContext(std::unique_ptr<crypto::cn_context> context);
+
+    typedef std::list<std::pair<crypto::Hash, crypto::Hash>> EntryList;
+
+    const size_t m_capacity;
+    const size_t m_maxIdleContexts;
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<crypto::cn_context>> m_contexts; // idle scratchpads
+    EntryList m_longHashes; // most recently computed first, evicted from the back without regard to lookups
+    std::unordered_map<crypto::Hash, EntryList::iterator> m_index;
+  };
+}
@@ -267,14 +267,15 @@ namespace cn
           crypto::cn_context localctx;
           crypto::Hash h;
 
-          Block lb(bl); // copy to local block
+          BinaryArray blob;
+          size_t nonceOffset;
+          if (!get_block_hashing_blob(bl, blob, nonceOffset)) {
+            return;
+          }
 
           for (uint32_t nonce = startNonce + i; !found; nonce += nthreads) {
-            lb.nonce = nonce;
-
-            if (!get_block_longhash(localctx, lb, h)) {
-              return;
-            }
+            memcpy(blob.data() + nonceOffset, &nonce, sizeof(nonce));
+            get_block_longhash(localctx, bl.majorVersion, blob, h);
 
             if (check_hash(h, diffic)) {
               foundNonce = nonce;
@@ -295,11 +296,16 @@ namespace cn
 
       return found;
     } else {
+      BinaryArray blob;
+      size_t nonceOffset;
+      if (!get_block_hashing_blob(bl, blob, nonceOffset)) {
+        return false;
+      }
+
       for (; bl.nonce != std::numeric_limits<uint32_t>::max(); bl.nonce++) {
         crypto::Hash h;
-        if (!get_block_longhash(context, bl, h)) {
-          return false;
-        }
+        memcpy(blob.data() + nonceOffset, &bl.nonce, sizeof(bl.nonce));
+        get_block_longhash(context, bl.majorVersion, blob, h);
 
         if (check_hash(h, diffic)) {
           return true;
@@ -346,6 +352,9 @@ namespace cn
     uint32_t local_template_ver = 0;
     crypto::cn_context context;
     Block b;
+    // hashing blob of the template, only its nonce changes between attempts
+    BinaryArray blob;
+    size_t nonceOffset = 0;
 
     while(!m_stop)
     {
@@ -363,6 +372,12 @@ namespace cn
 
         local_template_ver = m_template_no;
         nonce = m_starter_nonce + th_local_index;
+
+        if (!get_block_hashing_blob(b, blob, nonceOffset)) {
+          logger(ERROR) << "Failed to get block hashing blob";
+          m_stop = true;
+          continue;
+        }
       }
 
       if(!local_template_ver)//no any set_block_template call
@@ -373,11 +388,9 @@ namespace cn
       }
 
       b.nonce = nonce;
+      memcpy(blob.data() + nonceOffset, &nonce, sizeof(nonce));
       crypto::Hash h;
-      if (!m_stop && !get_block_longhash(context, b, h)) {
-        logger(ERROR) << "Failed to get block long hash";
-        m_stop = true;
-      }
+      get_block_longhash(context, b.majorVersion, blob, h);
 
       if (!m_stop && check_hash(h, local_diff))
       {
@@ -0,0 +1,74 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "RingSignatureCache.h"
+
+namespace cn
+{
+  RingSignatureCache::RingSignatureCache(size_t capacity) : m_capacity(capacity), m_hits(0), m_misses(0) {
+  }
+
+  bool RingSignatureCache::contains(const crypto::Hash& transactionHash, const crypto::Hash& ringsDigest, bool countLookup) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(transactionHash);
+    if (it == m_index.end() || it->second->second != ringsDigest) {
+      if (countLookup) {
+        ++m_misses;
+      }
+
+      return false;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    if (countLookup) {
+      ++m_hits;
+    }
+
+    return true;
+  }
+
+  void RingSignatureCache::insert(const crypto::Hash& transactionHash, const crypto::Hash& ringsDigest) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_capacity == 0) {
+      return;
+    }
+
+    auto it = m_index.find(transactionHash);
+    if (it != m_index.end()) {
+      it->second->second = ringsDigest;
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      return;
+    }
+
+    if (m_entries.size() >= m_capacity) {
+      m_index.erase(m_entries.back().first);
+      m_entries.pop_back();
+    }
+
+    m_entries.emplace_front(transactionHash, ringsDigest);
+    m_index.emplace(transactionHash, m_entries.begin());
+  }
+
+  void RingSignatureCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+  }
+
+  uint64_t RingSignatureCache::hits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+  }
+
+  uint64_t RingSignatureCache::misses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+  }
+
+  size_t RingSignatureCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+}
@@ -0,0 +1,44 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "crypto/hash.h"
+
+namespace cn
+{
+  // Transactions whose ring signatures were verified, so a block carrying a transaction already
+  // accepted by the pool does not check its signatures again. The digest covers the key images and
+  // the ring members the signatures were checked against, a reorganization that changes them misses.
+  class RingSignatureCache {
+  public:
+    explicit RingSignatureCache(size_t capacity);
+
+    // only the lookups made while importing blocks are counted, pool checks would inflate the hits
+    bool contains(const crypto::Hash& transactionHash, const crypto::Hash& ringsDigest, bool countLookup = false);
+    void insert(const crypto::Hash& transactionHash, const crypto::Hash& ringsDigest);
+    void clear();
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+    size_t size() const;
+
+  private:
+    typedef std::list<std::pair<crypto::Hash, crypto::Hash>> EntryList;
+
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    EntryList m_entries; // most recently used first
+    std::unordered_map<crypto::Hash, EntryList::iterator> m_index;
+    uint64_t m_hits;
+    uint64_t m_misses;
+  };
+}
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
 #include <fstream>
@@ -14,13 +15,18 @@
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <deque>
+#include "Common/MemoryInputStream.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
 #include "Serialization/BinaryOutputStreamSerializer.h"
+#include "System/MemoryMappedFile.h"
 
 template<class T> class SwappedVector {
 public:
@@ -137,7 +143,11 @@ public:
   ~SwappedVector();
   SwappedVector& operator=(const SwappedVector&) = delete;
 
-  bool open(const std::string& itemFileName, const std::string& indexFileName, size_t poolSize);
+  // With memoryMapped set, cache misses are decoded straight from a read only view of the items file
+  // instead of seeking and reading through the fstream. Writes always go through the fstream. The view
+  // saves the read calls and the stream buffer copy, items are still decoded once into the cache since
+  // callers hold typed references.
+  bool open(const std::string& itemFileName, const std::string& indexFileName, size_t poolSize, bool memoryMapped = false);
   void close();
 
   bool empty() const;
@@ -145,6 +155,9 @@ public:
   const_iterator begin();
   const_iterator end();
   const T& operator[](uint64_t index);
+  // Decodes an item without caching it, only the read of its bytes is serialized between callers
+  void load(uint64_t index, T& item);
+  void loadBytes(uint64_t index, std::string& itemBytes);
   const T& front();
   const T& back();
   void clear();
@@ -152,13 +165,20 @@ public:
   void push_back(const T& item);
   void replace(uint64_t index, const T &item);
 
+  // References returned by operator[] normally live until the next access evicts them. While
+  // readers are registered, evicted items are retired instead of destroyed. A retired item is freed
+  // once every reader registered before its eviction has left, later readers can not have seen it.
+  // addReader returns the epoch to pass to removeReader.
+  uint64_t addReader() const;
+  void removeReader(uint64_t epoch) const;
+
 private:
   struct ItemEntry;
   struct CacheEntry;
 
   struct ItemEntry {
   public:
-    T item;
+    std::unique_ptr<T> item;
     typename std::list<CacheEntry>::iterator cacheIter;
   };
 
@@ -169,6 +189,9 @@ private:
 
   std::fstream m_itemsFile;
   std::fstream m_indexesFile;
+  std::string m_itemsFileName;
+  bool m_memoryMapped = false;
+  platform_system::MemoryMappedFile m_itemsMapping;
   size_t m_poolSize;
   std::vector<uint64_t> m_offsets;
   uint64_t m_itemsFileSize;
@@ -176,8 +199,15 @@ private:
   std::list<CacheEntry> m_cache;
   uint64_t m_cacheHits;
   uint64_t m_cacheMisses;
+  mutable std::mutex m_mutex;
+  // registered readers by the epoch they entered in, retired items by the epoch they left the cache in
+  mutable std::map<uint64_t, size_t> m_readers;
+  mutable std::deque<std::pair<uint64_t, std::unique_ptr<T>>> m_retired;
+  mutable uint64_t m_epoch = 0;
 
   T* prepare(uint64_t index);
+  void retire(std::unique_ptr<T>&& item);
+  bool mapItems(uint64_t requiredSize);
 };
 
 template<class T> SwappedVector<T>::SwappedVector() = default;
@@ -186,11 +216,14 @@ template<class T> SwappedVector<T>::~SwappedVector() {
   close();
 }
 
-template<class T> bool SwappedVector<T>::open(const std::string& itemFileName, const std::string& indexFileName, size_t poolSize) {
+template<class T> bool SwappedVector<T>::open(const std::string& itemFileName, const std::string& indexFileName, size_t poolSize, bool memoryMapped) {
   if (poolSize == 0) {
     return false;
   }
 
+  m_itemsFileName = itemFileName;
+  m_memoryMapped = memoryMapped;
+
   m_itemsFile.open(itemFileName, std::ios::in | std::ios::out | std::ios::binary);
   m_indexesFile.open(indexFileName, std::ios::in | std::ios::out | std::ios::binary);
   if (m_itemsFile && m_indexesFile) {
@@ -241,6 +274,11 @@ template<class T> bool SwappedVector<T>::open(const std::string& itemFileName, c
 }
 
 template<class T> void SwappedVector<T>::close() {
+  if (m_itemsMapping.isOpened())
+  {
+    std::error_code ignore;
+    m_itemsMapping.close(ignore);
+  }
   if (m_indexesFile.is_open())
   {
     m_indexesFile.close();
@@ -269,6 +307,7 @@ template<class T> typename SwappedVector<T>::const_iterator SwappedVector<T>::en
 }
 
 template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
+  std::lock_guard<std::mutex> lock(m_mutex);
   auto itemIter = m_items.find(index);
   if (itemIter != m_items.end()) {
     if (itemIter->second.cacheIter != --m_cache.end()) {
@@ -276,7 +315,7 @@ template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
     }
 
     ++m_cacheHits;
-    return itemIter->second.item;
+    return *itemIter->second.item;
   }
 
   if (index >= m_offsets.size()) {
@@ -287,19 +326,60 @@ template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
     throw std::runtime_error("SwappedVector::operator[]");
   }
 
-  m_itemsFile.seekg(m_offsets[index]);
-  T tempItem;
-  
-  common::StdInputStream stream(m_itemsFile);
-  cn::BinaryInputStreamSerializer archive(stream);
-  serialize(tempItem, archive);
-
+  // the item is decoded in its cache slot, which is dropped again if decoding fails
   T* item = prepare(index);
-  std::swap(tempItem, *item);
+  try {
+    uint64_t itemEnd = index + 1 < m_offsets.size() ? m_offsets[index + 1] : m_itemsFileSize;
+    if (m_memoryMapped && mapItems(itemEnd)) {
+      common::MemoryInputStream stream(m_itemsMapping.data() + m_offsets[index], static_cast<size_t>(itemEnd - m_offsets[index]));
+      cn::BinaryInputStreamSerializer archive(stream);
+      serialize(*item, archive);
+    } else {
+      m_itemsFile.seekg(m_offsets[index]);
+      common::StdInputStream stream(m_itemsFile);
+      cn::BinaryInputStreamSerializer archive(stream);
+      serialize(*item, archive);
+    }
+  } catch (...) {
+    m_cache.pop_back();
+    m_items.erase(index);
+    throw;
+  }
+
   ++m_cacheMisses;
   return *item;
 }
 
+template<class T> void SwappedVector<T>::load(uint64_t index, T& item) {
+  std::string itemBytes;
+  loadBytes(index, itemBytes);
+
+  common::MemoryInputStream stream(itemBytes.data(), itemBytes.size());
+  cn::BinaryInputStreamSerializer archive(stream);
+  serialize(item, archive);
+}
+
+// Copies the stored bytes of an item without decoding it
+template<class T> void SwappedVector<T>::loadBytes(uint64_t index, std::string& itemBytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (index >= m_offsets.size() || !m_itemsFile) {
+    throw std::runtime_error("SwappedVector::loadBytes");
+  }
+
+  uint64_t itemEnd = index + 1 < m_offsets.size() ? m_offsets[index + 1] : m_itemsFileSize;
+  size_t itemSize = static_cast<size_t>(itemEnd - m_offsets[index]);
+  if (m_memoryMapped && mapItems(itemEnd)) {
+    itemBytes.assign(reinterpret_cast<const char*>(m_itemsMapping.data() + m_offsets[index]), itemSize);
+  } else {
+    itemBytes.resize(itemSize);
+    m_itemsFile.seekg(m_offsets[index]);
+    m_itemsFile.read(&itemBytes[0], itemSize);
+    if (!m_itemsFile) {
+      throw std::runtime_error("SwappedVector::loadBytes");
+    }
+  }
+}
+
 template<class T> const T& SwappedVector<T>::front() {
   return operator[](0);
 }
@@ -309,6 +389,7 @@ template<class T> const T& SwappedVector<T>::back() {
 }
 
 template<class T> void SwappedVector<T>::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (!m_indexesFile) {
     throw std::runtime_error("SwappedVector::clear");
   }
@@ -324,9 +405,11 @@ template<class T> void SwappedVector<T>::clear() {
   m_itemsFileSize = 0;
   m_items.clear();
   m_cache.clear();
+  m_retired.clear();
 }
 
 template<class T> void SwappedVector<T>::pop_back() {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (!m_indexesFile) {
     throw std::runtime_error("SwappedVector::pop_back");
   }
@@ -343,11 +426,13 @@ template<class T> void SwappedVector<T>::pop_back() {
   auto itemIter = m_items.find(m_offsets.size());
   if (itemIter != m_items.end()) {
     m_cache.erase(itemIter->second.cacheIter);
+    retire(std::move(itemIter->second.item));
     m_items.erase(itemIter);
   }
 }
 
 template<class T> void SwappedVector<T>::push_back(const T& item) {
+  std::lock_guard<std::mutex> lock(m_mutex);
   uint64_t itemsFileSize;
 
   {
@@ -362,6 +447,10 @@ template<class T> void SwappedVector<T>::push_back(const T& item) {
     serialize(const_cast<T&>(item), archive);
 
     itemsFileSize = m_itemsFile.tellp();
+    if (m_memoryMapped) {
+      // the mapping only sees what has reached the file
+      m_itemsFile.flush();
+    }
   }
 
   {
@@ -392,6 +481,7 @@ template<class T> void SwappedVector<T>::push_back(const T& item) {
 }
 
 template<class T> void SwappedVector<T>::replace(uint64_t index, const T& item) {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (!m_itemsFile)
   {
     throw std::runtime_error("SwappedVector::replace");
@@ -402,18 +492,73 @@ template<class T> void SwappedVector<T>::replace(uint64_t index, const T& item)
   common::StdOutputStream stream(m_itemsFile);
   cn::BinaryOutputStreamSerializer archive(stream);
   serialize(const_cast<T &>(item), archive);
+  if (m_memoryMapped) {
+    m_itemsFile.flush();
+  }
 }
 
 template<class T> T* SwappedVector<T>::prepare(uint64_t index) {
   if (m_items.size() == m_poolSize) {
     auto cacheIter = m_cache.begin();
+    retire(std::move(cacheIter->itemIter->second.item));
     m_items.erase(cacheIter->itemIter);
     m_cache.erase(cacheIter);
   }
 
   auto itemIter = m_items.insert(std::make_pair(index, ItemEntry()));
+  itemIter.first->second.item.reset(new T());
   CacheEntry cacheEntry = { itemIter.first };
   auto cacheIter = m_cache.insert(m_cache.end(), cacheEntry);
   itemIter.first->second.cacheIter = cacheIter;
-  return &itemIter.first->second.item;
+  return itemIter.first->second.item.get();
+}
+
+template<class T> uint64_t SwappedVector<T>::addReader() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_readers[m_epoch];
+  return m_epoch;
+}
+
+template<class T> void SwappedVector<T>::removeReader(uint64_t epoch) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto reader = m_readers.find(epoch);
+  if (--reader->second == 0) {
+    m_readers.erase(reader);
+  }
+
+  // items retired before the oldest remaining reader entered are not referenced anymore
+  while (!m_retired.empty() && (m_readers.empty() || m_retired.front().first < m_readers.begin()->first)) {
+    m_retired.pop_front();
+  }
+}
+
+template<class T> void SwappedVector<T>::retire(std::unique_ptr<T>&& item) {
+  if (!m_readers.empty()) {
+    m_retired.emplace_back(m_epoch, std::move(item));
+    ++m_epoch;
+  }
+}
+
+template<class T> bool SwappedVector<T>::mapItems(uint64_t requiredSize) {
+  // The view is reserved past the end of the file where the platform allows it, items appended later are
+  // read through it and it is only remapped, twice as large, once an item lies beyond it
+  if (m_itemsMapping.isOpened() && m_itemsMapping.size() >= requiredSize) {
+    return true;
+  }
+
+  uint64_t mappedSize = std::max(requiredSize, m_itemsFileSize) * 2;
+  m_itemsFile.flush();
+  std::error_code ec;
+  m_itemsMapping.openReadOnly(m_itemsFileName, mappedSize, ec);
+  if (ec || m_itemsMapping.size() < requiredSize) {
+    // the platform refused the mapping, keep serving misses through the fstream
+    if (!ec) {
+      m_itemsMapping.close(ec);
+    }
+
+    m_memoryMapped = false;
+    return false;
+  }
+
+  return true;
 }
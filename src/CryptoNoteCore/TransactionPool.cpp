@@ -115,8 +115,13 @@ namespace cn
                                m_txCheckInterval(60, timeProvider),
                                m_validator(validator),
                                m_fee_index(boost::get<1>(m_transactions)),
-                               logger(log, "txpool")
+                               logger(log, "txpool"),
+                               m_readyValid(false),
+                               m_readyTail(NULL_HASH),
+                               m_readyHeight(0),
+                               m_chainChanged(false)
   {
+    m_templateCache.valid = false;
   }
 
   bool tx_memory_pool::add_tx(const Transaction &tx, /*const crypto::Hash& tx_prefix_hash,*/ const crypto::Hash &id, size_t blobSize, tx_verification_context &tvc, bool keptByBlock, uint32_t height)
@@ -265,6 +270,12 @@ namespace cn
         m_ttlIndex.emplace(std::make_pair(id, ttl.ttl));
       }
 
+      m_templateCache.valid = false;
+      if (m_readyValid && !m_chainChanged && isReadyForBlock(txd_p.first, m_readyHeight))
+      {
+        m_readyTransactions.insert(&*txd_p.first);
+      }
+
       logger(DEBUGGING) << "Transaction " << txd.id << " added to pool";
     }
 
@@ -382,11 +393,14 @@ namespace cn
   //---------------------------------------------------------------------------------
   bool tx_memory_pool::on_blockchain_inc(uint64_t new_block_height, const crypto::Hash &top_block_id)
   {
+    // called with the blockchain locked, the ready set is rebuilt by the next template request
+    m_chainChanged = true;
     return true;
   }
   //---------------------------------------------------------------------------------
   bool tx_memory_pool::on_blockchain_dec(uint64_t new_block_height, const crypto::Hash &top_block_id)
   {
+    m_chainChanged = true;
     return true;
   }
   //---------------------------------------------------------------------------------
@@ -471,6 +485,21 @@ namespace cn
       uint32_t &height)
   {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    const crypto::Hash &tail = bl.previousBlockHash;
+    bool chainChanged = m_chainChanged.exchange(false);
+    if (chainChanged || !m_readyValid || tail != m_readyTail || height != m_readyHeight)
+    {
+      refreshReadyTransactions(tail, height);
+    }
+
+    if (m_templateCache.valid && m_templateCache.tail == tail && m_templateCache.medianSize == median_size && m_templateCache.maxCumulativeSize == maxCumulativeSize)
+    {
+      bl.transactionHashes = m_templateCache.transactions;
+      total_size = m_templateCache.totalSize;
+      fee = m_templateCache.fee;
+      return true;
+    }
+
     total_size = 0;
     fee = 0;
     size_t max_total_size = (125 * median_size) / 100 - m_currency.minerTxBlobReservedSize();
@@ -478,48 +507,85 @@ namespace cn
 
     BlockTemplate blockTemplate;
 
-    for (auto it = m_fee_index.begin(); it != m_fee_index.end(); ++it)
+    for (const TransactionDetails *txd : m_readyTransactions)
     {
-      const auto &txd = *it;
-
-      if (m_ttlIndex.count(txd.id) > 0)
+      size_t blockSizeLimit = (txd->fee == 0) ? median_size : max_total_size;
+      if (blockSizeLimit < total_size + txd->blobSize)
       {
         continue;
       }
 
-      uint64_t inputs_amount = m_currency.getTransactionAllInputsAmount(txd.tx, height);
-      uint64_t outputs_amount = get_outs_money_amount(txd.tx);
-
-      if (outputs_amount > inputs_amount)
+      if (blockTemplate.addTransaction(txd->id, txd->tx))
       {
-        logger(WARNING, BRIGHT_YELLOW) << "Transaction, with id " << txd.id << " uses more money than it has: uses " << m_currency.formatAmount(outputs_amount) << ", has " << m_currency.formatAmount(inputs_amount)
-                                       << " and will not be included in the block template";
-        continue;
+        total_size += txd->blobSize;
+        fee += txd->fee;
+        logger(DEBUGGING) << "Transaction " << txd->id << " included in the block template";
       }
-
-      size_t blockSizeLimit = (txd.fee == 0) ? median_size : max_total_size;
-      if (blockSizeLimit < total_size + txd.blobSize)
+      else
       {
-        continue;
+        logger(DEBUGGING) << "Transaction " << txd->id << " was not included in the block template";
       }
+    }
 
-      TransactionCheckInfo checkInfo(txd);
-      bool ready = is_transaction_ready_to_go(txd.tx, checkInfo);
+    bl.transactionHashes = blockTemplate.getTransactions();
 
-      if (ready && blockTemplate.addTransaction(txd.id, txd.tx))
-      {
-        total_size += txd.blobSize;
-        fee += txd.fee;
-        logger(DEBUGGING) << "Transaction " << txd.id << " included in the block template";
-      }
-      else
+    m_templateCache.valid = true;
+    m_templateCache.tail = tail;
+    m_templateCache.medianSize = median_size;
+    m_templateCache.maxCumulativeSize = maxCumulativeSize;
+    m_templateCache.transactions = bl.transactionHashes;
+    m_templateCache.totalSize = total_size;
+    m_templateCache.fee = fee;
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  bool tx_memory_pool::isReadyForBlock(tx_container_t::iterator it, uint32_t height)
+  {
+    const auto &txd = *it;
+    if (m_ttlIndex.count(txd.id) > 0)
+    {
+      return false;
+    }
+
+    uint64_t inputs_amount = m_currency.getTransactionAllInputsAmount(txd.tx, height);
+    uint64_t outputs_amount = get_outs_money_amount(txd.tx);
+
+    if (outputs_amount > inputs_amount)
+    {
+      logger(WARNING, BRIGHT_YELLOW) << "Transaction, with id " << txd.id << " uses more money than it has: uses " << m_currency.formatAmount(outputs_amount) << ", has " << m_currency.formatAmount(inputs_amount)
+                                     << " and will not be included in the block template";
+      return false;
+    }
+
+    // the outcome is kept with the transaction, later checks on the same chain skip the ring signatures
+    TransactionCheckInfo checkInfo(txd);
+    bool ready = is_transaction_ready_to_go(txd.tx, checkInfo);
+    m_transactions.modify(it, [&checkInfo](TransactionDetails &details) { static_cast<TransactionCheckInfo &>(details) = checkInfo; });
+    return ready;
+  }
+  //---------------------------------------------------------------------------------
+  void tx_memory_pool::refreshReadyTransactions(const crypto::Hash &tail, uint32_t height)
+  {
+    clearReadyTransactions();
+    // walk in fee order so equal priority transactions keep the order of the fee index
+    for (auto it = m_fee_index.begin(); it != m_fee_index.end(); ++it)
+    {
+      if (isReadyForBlock(m_transactions.project<0>(it), height))
       {
-        logger(DEBUGGING) << "Transaction " << txd.id << " was not included in the block template";
+        m_readyTransactions.insert(m_readyTransactions.end(), &*it);
       }
     }
 
-    bl.transactionHashes = blockTemplate.getTransactions();
-    return true;
+    m_readyValid = true;
+    m_readyTail = tail;
+    m_readyHeight = height;
+  }
+  //---------------------------------------------------------------------------------
+  void tx_memory_pool::clearReadyTransactions()
+  {
+    m_readyTransactions.clear();
+    m_readyValid = false;
+    m_templateCache.valid = false;
   }
   //---------------------------------------------------------------------------------
   bool tx_memory_pool::init(const std::string &config_folder)
@@ -538,6 +604,7 @@ namespace cn
     {
       logger(ERROR) << "Failed to load memory pool from file " << state_file_path;
 
+      clearReadyTransactions();
       m_transactions.clear();
       m_spent_key_images.clear();
       m_spentOutputs.clear();
@@ -611,6 +678,7 @@ namespace cn
 
     if (s.type() == ISerializer::INPUT)
     {
+      clearReadyTransactions();
       m_transactions.clear();
       readSequence<TransactionDetails>(std::inserter(m_transactions, m_transactions.end()), "transactions", s);
     }
@@ -696,6 +764,18 @@ namespace cn
     m_paymentIdIndex.remove(i->tx);
     m_timestampIndex.remove(i->receiveTime, i->id);
     m_ttlIndex.erase(i->id);
+
+    auto ready = m_readyTransactions.equal_range(&*i);
+    for (auto it = ready.first; it != ready.second; ++it)
+    {
+      if (*it == &*i)
+      {
+        m_readyTransactions.erase(it);
+        break;
+      }
+    }
+
+    m_templateCache.valid = false;
     return m_transactions.erase(i);
   }
 
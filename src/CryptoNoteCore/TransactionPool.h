@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <set>
 #include <unordered_map>
@@ -174,6 +175,25 @@ namespace cn {
       indexed_by<main_index_t, fee_index_t>
     > tx_container_t;
 
+    struct ReadyTransactionComparator {
+      bool operator()(const TransactionDetails* lhs, const TransactionDetails* rhs) const {
+        return TransactionPriorityComparator()(*lhs, *rhs);
+      }
+    };
+
+    // pool transactions a block on top of m_readyTail may include, best fee density first
+    typedef std::multiset<const TransactionDetails*, ReadyTransactionComparator> ready_container_t;
+
+    struct BlockTemplateCache {
+      bool valid;
+      crypto::Hash tail;
+      size_t medianSize;
+      size_t maxCumulativeSize;
+      std::vector<crypto::Hash> transactions;
+      size_t totalSize;
+      uint64_t fee;
+    };
+
     typedef std::pair<uint64_t, uint64_t> GlobalOutput;
     typedef std::set<GlobalOutput> GlobalOutputsContainer;
     typedef std::unordered_map<crypto::KeyImage, std::unordered_set<crypto::Hash> > key_images_container;
@@ -187,6 +207,9 @@ namespace cn {
     tx_container_t::iterator removeTransaction(tx_container_t::iterator i);
     bool removeExpiredTransactions();
     bool is_transaction_ready_to_go(const Transaction& tx, TransactionCheckInfo& txd) const;
+    bool isReadyForBlock(tx_container_t::iterator it, uint32_t height);
+    void refreshReadyTransactions(const crypto::Hash& tail, uint32_t height);
+    void clearReadyTransactions();
     void buildIndices();
 
     tools::ObserverManager<ITxPoolObserver> m_observerManager;
@@ -209,5 +232,14 @@ namespace cn {
     PaymentIdIndex m_paymentIdIndex;
     TimestampTransactionsIndex m_timestampIndex;
     std::unordered_map<crypto::Hash, uint64_t> m_ttlIndex;
+
+    // Readiness is checked once per chain tail instead of on every template request, new
+    // transactions join the ready set as they arrive and templates are reused until the pool changes
+    ready_container_t m_readyTransactions;
+    bool m_readyValid;
+    crypto::Hash m_readyTail;
+    uint32_t m_readyHeight;
+    std::atomic<bool> m_chainChanged;
+    BlockTemplateCache m_templateCache;
   };
 }
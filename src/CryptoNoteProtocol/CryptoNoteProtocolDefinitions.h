@@ -244,5 +244,42 @@ namespace cn
     const static int ID = BC_COMMANDS_POOL_BASE + 10;
     typedef NOTIFY_MISSING_TXS_request request;
   };
+
+  /************************************************************************/
+  /*                                                                      */
+  /************************************************************************/
+  // hashes of transactions accepted to the pool, sent only to peers that negotiated P2P_SUPPORT_FLAG_TX_ANNOUNCE
+  struct NOTIFY_TX_ANNOUNCE_request
+  {
+    std::vector<crypto::Hash> txs;
+
+    void serialize(ISerializer &s)
+    {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_TX_ANNOUNCE
+  {
+    const static int ID = BC_COMMANDS_POOL_BASE + 11;
+    typedef NOTIFY_TX_ANNOUNCE_request request;
+  };
+
+  // answered with NOTIFY_NEW_TRANSACTIONS carrying the requested transactions still in the pool
+  struct NOTIFY_REQUEST_TXS_request
+  {
+    std::vector<crypto::Hash> txs;
+
+    void serialize(ISerializer &s)
+    {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_REQUEST_TXS
+  {
+    const static int ID = BC_COMMANDS_POOL_BASE + 12;
+    typedef NOTIFY_REQUEST_TXS_request request;
+  };
 } // namespace cn
 
@@ -9,10 +9,11 @@
 
 #include "CryptoNoteProtocolHandler.h"
 
-#include <future>
+#include <sstream>
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <System/Dispatcher.h>
+#include <System/InterruptedException.h>
 #include <boost/optional.hpp>
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
@@ -36,6 +37,13 @@ bool post_notify(IP2pEndpoint &p2p, typename t_parametr::request &arg, const Cry
   return p2p.invoke_notify_to_peer(t_parametr::ID, LevinProtocol::encode(arg), context);
 }
 
+enum class ParsedBlockStatus
+{
+  ok,
+  too_big,
+  invalid
+};
+
 template <class t_parametr>
 void relay_post_notify(IP2pEndpoint &p2p, typename t_parametr::request &arg, const net_connection_id *excludeConnection = nullptr)
 {
@@ -53,7 +61,12 @@ CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(const Currency &currency, p
   m_observedHeight(0),
   m_peersCount(0),
   logger(log, "protocol"),
-  m_dispatcher(dispatcher)
+  m_dispatcher(dispatcher),
+  m_committing(false),
+  m_commitQueueSpace(dispatcher),
+  // each stage has a worker of its own even without spare hardware threads
+  m_syncWorkers(std::max<size_t>(tools::WorkerPool::defaultWorkerCount(), 1)),
+  m_commitWorkers(std::max<size_t>(tools::WorkerPool::defaultWorkerCount(), 1))
   {
     if (!m_p2p)
       m_p2p = &m_p2p_stub;
@@ -78,6 +91,8 @@ void CryptoNoteProtocolHandler::onConnectionOpened(CryptoNoteConnectionContext &
 
 void CryptoNoteProtocolHandler::onConnectionClosed(CryptoNoteConnectionContext &context)
 {
+  m_pendingCommits.erase(context.m_connection_id);
+
   bool updated = false;
   {
     std::lock_guard<std::mutex> lock(m_observedHeightMutex);
@@ -264,6 +279,8 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const
     HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, &CryptoNoteProtocolHandler::handle_request_tx_pool)
     HANDLE_NOTIFY(NOTIFY_NEW_LITE_BLOCK, &CryptoNoteProtocolHandler::handle_notify_new_lite_block)
     HANDLE_NOTIFY(NOTIFY_MISSING_TXS, &CryptoNoteProtocolHandler::handle_notify_missing_txs)
+    HANDLE_NOTIFY(NOTIFY_TX_ANNOUNCE, &CryptoNoteProtocolHandler::handle_notify_tx_announce)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_TXS, &CryptoNoteProtocolHandler::handle_request_txs)
 
   default:
     handled = false;
@@ -362,6 +379,12 @@ int CryptoNoteProtocolHandler::handle_notify_new_transactions(int command, NOTIF
       auto transactionBinary = asBinaryArray(*tx_blob_it);
       crypto::Hash transactionHash = crypto::cn_fast_hash(transactionBinary.data(), transactionBinary.size());
       logger(DEBUGGING) << "transaction " << transactionHash << " came in NOTIFY_NEW_TRANSACTIONS";
+      auto requested = m_requestedTxs.find(transactionHash);
+      if (requested != m_requestedTxs.end())
+      {
+        releaseTransactionRequest(requested->second);
+        m_requestedTxs.erase(requested);
+      }
 
       cn::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
       m_core.handle_incoming_tx(transactionBinary, tvc, false);
@@ -381,8 +404,7 @@ int CryptoNoteProtocolHandler::handle_notify_new_transactions(int command, NOTIF
 
     if (arg.txs.size())
     {
-      //TODO: add announce usage here
-      relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
+      relayTransactions(arg, &context.m_connection_id);
     }
   }
 
@@ -415,6 +437,12 @@ int CryptoNoteProtocolHandler::handle_request_get_objects(int command, NOTIFY_RE
 int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_RESPONSE_GET_OBJECTS::request& arg, CryptoNoteConnectionContext& context) {
   logger(logging::TRACE) << context << "NOTIFY_RESPONSE_GET_OBJECTS";
 
+  if (context.m_state != CryptoNoteConnectionContext::state_synchronizing && context.m_requested_objects.empty()) {
+    // the batch requested ahead arrived after the connection stopped synchronizing
+    logger(DEBUGGING) << context << "Ignoring NOTIFY_RESPONSE_GET_OBJECTS received out of synchronization";
+    return 1;
+  }
+
   if (context.m_last_response_height > arg.current_blockchain_height) {
     logger(logging::ERROR) << context << "sent wrong NOTIFY_HAVE_OBJECTS: arg.m_current_blockchain_height=" << arg.current_blockchain_height
       << " < m_last_response_height=" << context.m_last_response_height << ", dropping connection";
@@ -426,30 +454,64 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
 
   context.m_remote_blockchain_height = arg.current_blockchain_height;
 
-  size_t count = 0;
+  // blocks are parsed and hashed on the sync workers while the previous batch of the connection is committed,
+  // the dispatcher serves the other connections meanwhile
+  std::vector<parsed_block_entry> parsed_blocks(arg.blocks.size());
+  std::vector<ParsedBlockStatus> statuses(arg.blocks.size(), ParsedBlockStatus::ok);
+  runOnSyncWorkers([this, &arg, &parsed_blocks, &statuses] {
+    m_syncWorkers.parallelFor(arg.blocks.size(), [this, &arg, &parsed_blocks, &statuses](size_t i) {
+      const block_complete_entry& block_entry = arg.blocks[i];
+      parsed_block_entry& parsedBlock = parsed_blocks[i];
+      BinaryArray block_blob = asBinaryArray(block_entry.block);
+      if (block_blob.size() > m_currency.maxBlockBlobSize()) {
+        statuses[i] = ParsedBlockStatus::too_big;
+        return;
+      }
+      if (!fromBinaryArray(parsedBlock.block, block_blob)) {
+        statuses[i] = ParsedBlockStatus::invalid;
+        return;
+      }
+
+      parsedBlock.hash = get_block_hash(parsedBlock.block);
+      parsedBlock.txs.reserve(block_entry.txs.size());
+      parsedBlock.txHashes.reserve(block_entry.txs.size());
+      for (auto& tx_blob : block_entry.txs) {
+        parsedBlock.txs.push_back(asBinaryArray(tx_blob));
+        parsedBlock.txHashes.push_back(crypto::cn_fast_hash(parsedBlock.txs.back().data(), parsedBlock.txs.back().size()));
+      }
+    });
+  });
+
+  auto pending = m_pendingCommits.find(context.m_connection_id);
+  if (pending != m_pendingCommits.end()) {
+    std::shared_ptr<SyncBatch> previous = pending->second;
+    m_pendingCommits.erase(pending);
+    waitCommit(*previous);
+    if (!applyCommitResult(context, previous->result)) {
+      return 1;
+    }
+  }
+
   std::vector<crypto::Hash> block_hashes;
   block_hashes.reserve(arg.blocks.size());
-  std::vector<parsed_block_entry> parsed_blocks;
-  parsed_blocks.reserve(arg.blocks.size());
-  for (const block_complete_entry& block_entry : arg.blocks) {
-    ++count;
-    Block b;
-    BinaryArray block_blob = asBinaryArray(block_entry.block);
-    if (block_blob.size() > m_currency.maxBlockBlobSize()) {
-      logger(logging::ERROR) << context << "sent wrong block: too big size " << block_blob.size() << ", dropping connection";
+  for (size_t i = 0; i < parsed_blocks.size(); ++i) {
+    const block_complete_entry& block_entry = arg.blocks[i];
+    const parsed_block_entry& parsedBlock = parsed_blocks[i];
+    if (statuses[i] == ParsedBlockStatus::too_big) {
+      logger(logging::ERROR) << context << "sent wrong block: too big size " << block_entry.block.size() << ", dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
-    if (!fromBinaryArray(b, block_blob)) {
+    if (statuses[i] == ParsedBlockStatus::invalid) {
       logger(logging::ERROR) << context << "sent wrong block: failed to parse and validate block: \r\n"
-        << toHex(block_blob) << "\r\n dropping connection";
+        << toHex(asBinaryArray(block_entry.block)) << "\r\n dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
 
     //to avoid concurrency in core between connections, suspend connections which delivered block later then first one
-    auto blockHash = get_block_hash(b);
-    if (count == 2) {
+    const crypto::Hash& blockHash = parsedBlock.hash;
+    if (i == 1) {
       if (m_core.have_block(blockHash)) {
         context.m_state = CryptoNoteConnectionContext::state_idle;
         context.m_needed_objects.clear();
@@ -466,9 +528,9 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
-    if (b.transactionHashes.size() != block_entry.txs.size()) {
+    if (parsedBlock.block.transactionHashes.size() != block_entry.txs.size()) {
       logger(logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << common::podToHex(blockHash)
-        << ", transactionHashes.size()=" << b.transactionHashes.size() << " mismatch with block_complete_entry.m_txs.size()=" << block_entry.txs.size() << ", dropping connection";
+        << ", transactionHashes.size()=" << parsedBlock.block.transactionHashes.size() << " mismatch with block_complete_entry.m_txs.size()=" << block_entry.txs.size() << ", dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
@@ -476,14 +538,6 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     context.m_requested_objects.erase(req_it);
 
     block_hashes.push_back(blockHash);
-
-    parsed_block_entry parsedBlock;
-    parsedBlock.block = std::move(b);
-    for (auto& tx_blob : block_entry.txs) {
-      auto transactionBinary = asBinaryArray(tx_blob);
-      parsedBlock.txs.push_back(transactionBinary);
-    }
-    parsed_blocks.push_back(parsedBlock);
   }
 
   if (context.m_requested_objects.size()) {
@@ -494,28 +548,156 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     return 1;
   }
 
+  std::shared_ptr<SyncBatch> batch = std::make_shared<SyncBatch>(m_dispatcher);
+  std::ostringstream peer;
+  peer << context;
+  batch->peer = peer.str();
+  batch->blocks = std::move(parsed_blocks);
+  queueCommit(batch);
+
+  // the next batch is requested before this one is committed, so the peer sends it and it gets parsed while the core is busy;
+  // a connection has at most one batch in the commit stage, its result is collected with the next response
+  if (!m_stop && context.m_state == CryptoNoteConnectionContext::state_synchronizing && !context.m_needed_objects.empty()) {
+    m_pendingCommits[context.m_connection_id] = batch;
+    request_missing_objects(context, true);
+    return 1;
+  }
+
+  // the chain is requested from the new top, once the last batch is committed
+  waitCommit(*batch);
+  if (!applyCommitResult(context, batch->result)) {
+    return 1;
+  }
+
+  if (!m_stop && context.m_state == CryptoNoteConnectionContext::state_synchronizing) {
+    request_missing_objects(context, true);
+  }
+
+  return 1;
+}
+
+void CryptoNoteProtocolHandler::runOnSyncWorkers(const std::function<void()>& job) {
+  // the job references the stack of the caller, it is waited for even if the context gets interrupted
+  platform_system::Event done(m_dispatcher);
+  platform_system::Event* donePointer = &done;
+  std::exception_ptr error;
+  m_syncWorkers.post([this, &job, &error, donePointer] {
+    try {
+      job();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    m_dispatcher.remoteSpawn([donePointer] { donePointer->set(); });
+  });
+
+  bool interrupted = false;
+  while (!done.get()) {
+    try {
+      done.wait();
+    } catch (platform_system::InterruptedException&) {
+      interrupted = true;
+    }
+  }
+
+  if (interrupted) {
+    m_dispatcher.interrupt();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void CryptoNoteProtocolHandler::queueCommit(const std::shared_ptr<SyncBatch>& batch) {
+  // a connection whose batch does not fit waits here, and reads and requests nothing more meanwhile
+  while (m_commitQueue.size() >= BLOCKS_SYNCHRONIZING_COMMIT_QUEUE_SIZE) {
+    m_commitQueueSpace.clear();
+    m_commitQueueSpace.wait();
+  }
+
+  m_commitQueue.push_back(batch);
+  if (!m_committing) {
+    startCommit();
+  }
+}
+
+void CryptoNoteProtocolHandler::startCommit() {
+  m_committing = !m_commitQueue.empty();
+  if (!m_committing) {
+    return;
+  }
+
+  std::shared_ptr<SyncBatch> batch = m_commitQueue.front();
+  m_commitQueue.pop_front();
+  m_commitQueueSpace.set();
+
+  m_commitWorkers.post([this, batch] {
+    try {
+      batch->result = commitBatch(*batch);
+    } catch (std::exception& e) {
+      logger(ERROR, BRIGHT_RED) << batch->peer << "Failed to commit blocks: " << e.what() << ", dropping connection";
+      batch->result = CommitResult::shutdown;
+    }
+
+    m_dispatcher.remoteSpawn([this, batch] {
+      batch->done.set();
+      startCommit();
+    });
+  });
+}
+
+void CryptoNoteProtocolHandler::waitCommit(SyncBatch& batch) {
+  while (!batch.done.get()) {
+    batch.done.wait();
+  }
+}
+
+bool CryptoNoteProtocolHandler::applyCommitResult(CryptoNoteConnectionContext& context, CommitResult result) {
+  if (result == CommitResult::shutdown) {
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return false;
+  }
+
+  if (result == CommitResult::idle) {
+    context.m_state = CryptoNoteConnectionContext::state_idle;
+    context.m_needed_objects.clear();
+    context.m_requested_objects.clear();
+    return false;
+  }
+
+  return true;
+}
+
+CryptoNoteProtocolHandler::CommitResult CryptoNoteProtocolHandler::commitBatch(SyncBatch& batch) {
+  // the proof of work of the whole batch is hashed concurrently, the serial commit only compares it with the difficulty
+  std::vector<const parsed_block_entry*> unknown_blocks;
+  for (const parsed_block_entry& parsedBlock : batch.blocks) {
+    if (!m_core.have_block(parsedBlock.hash)) {
+      unknown_blocks.push_back(&parsedBlock);
+    }
+  }
+  m_commitWorkers.parallelFor(unknown_blocks.size(), [this, &unknown_blocks](size_t i) {
+    m_core.precomputeProofOfWork(unknown_blocks[i]->block, unknown_blocks[i]->hash);
+  });
+
   uint32_t height;
   crypto::Hash top;
+  CommitResult result;
   {
     m_core.pause_mining();
 
-    // we lock all the rest to avoid having multiple connections redo a lot
-    // of the same work, and one of them doing it for nothing: subsequent
-    // connections will wait until the current one's added its blocks, then
-    // will add any extra it has, if any
-    std::lock_guard<std::recursive_mutex> lk(m_sync_lock);
+    // the batches of all the connections are committed one at a time: subsequent
+    // connections add any extra blocks they have once the current one is done
 
     // dismiss what another connection might already have done (likely everything)
     m_core.get_blockchain_top(height, top);
     uint64_t dismiss = 1;
-    for (const auto &h : block_hashes) {
-      if (top == h) {
+    for (const parsed_block_entry& parsedBlock : batch.blocks) {
+      if (top == parsedBlock.hash) {
         logger(DEBUGGING) << "Found current top block in synced blocks, dismissing "
-          << dismiss << "/" << arg.blocks.size() << " blocks";
-        while (dismiss--) {
-          arg.blocks.erase(arg.blocks.begin());
-          parsed_blocks.erase(parsed_blocks.begin());
-        }
+          << dismiss << "/" << batch.blocks.size() << " blocks";
+        batch.blocks.erase(batch.blocks.begin(), batch.blocks.begin() + dismiss);
         break;
       }
       ++dismiss;
@@ -523,23 +705,18 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
 
     BOOST_SCOPE_EXIT_ALL(this) { m_core.update_block_template_and_resume_mining(); };
 
-    int result = processObjects(context, parsed_blocks);
-    if (result != 0) {
-      return result;
-    }
+    result = processObjects(batch.peer, batch.blocks);
   }
 
-  m_core.get_blockchain_top(height, top);
-  logger(DEBUGGING, BRIGHT_GREEN) << "Local blockchain updated, new height = " << height;
-
-  if (!m_stop && context.m_state == CryptoNoteConnectionContext::state_synchronizing) {
-    request_missing_objects(context, true);
+  if (result == CommitResult::ok) {
+    m_core.get_blockchain_top(height, top);
+    logger(DEBUGGING, BRIGHT_GREEN) << "Local blockchain updated, new height = " << height;
   }
 
-  return 1;
+  return result;
 }
 
-int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& context, const std::vector<parsed_block_entry>& blocks) {
+CryptoNoteProtocolHandler::CommitResult CryptoNoteProtocolHandler::processObjects(const std::string& peer, const std::vector<parsed_block_entry>& blocks) {
 
   for (const parsed_block_entry& block_entry : blocks) {
     if (m_stop) {
@@ -548,25 +725,23 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
 
     //process transactions
     for (size_t i = 0; i < block_entry.txs.size(); ++i) {
-      auto transactionBinary = block_entry.txs[i];
-      crypto::Hash transactionHash = crypto::cn_fast_hash(transactionBinary.data(), transactionBinary.size());
+      const BinaryArray& transactionBinary = block_entry.txs[i];
+      const crypto::Hash& transactionHash = block_entry.txHashes[i];
       logger(DEBUGGING) << "transaction " << transactionHash << " came in processObjects";
 
       // check if tx hashes match
       if (transactionHash != block_entry.block.transactionHashes[i]) {
-        logger(DEBUGGING) << context << "transaction mismatch on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
+        logger(DEBUGGING) << peer << "transaction mismatch on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
           << common::podToHex(transactionHash) << ", dropping connection";
-        context.m_state = CryptoNoteConnectionContext::state_shutdown;
-        return 1;
+        return CommitResult::shutdown;
       }
 
       tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
       m_core.handle_incoming_tx(transactionBinary, tvc, true);
       if (tvc.m_verification_failed) {
-        logger(DEBUGGING) << context << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
+        logger(DEBUGGING) << peer << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
           << common::podToHex(transactionHash) << ", dropping connection";
-        context.m_state = CryptoNoteConnectionContext::state_shutdown;
-        return 1;
+        return CommitResult::shutdown;
       }
     }
 
@@ -575,25 +750,18 @@ int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& conte
     m_core.handle_incoming_block(block_entry.block, bvc, false, false);
 
     if (bvc.m_verification_failed) {
-      logger(DEBUGGING) << context << "Block verification failed, dropping connection";
-      context.m_state = CryptoNoteConnectionContext::state_shutdown;
-      return 1;
+      logger(DEBUGGING) << peer << "Block verification failed, dropping connection";
+      return CommitResult::shutdown;
     } else if (bvc.m_marked_as_orphaned) {
-      logger(logging::INFO) << context << "Block received at sync phase was marked as orphaned, dropping connection";
-      context.m_state = CryptoNoteConnectionContext::state_shutdown;
-      return 1;
+      logger(logging::INFO) << peer << "Block received at sync phase was marked as orphaned, dropping connection";
+      return CommitResult::shutdown;
     } else if (bvc.m_already_exists) {
-      logger(DEBUGGING) << context << "Block already exists, switching to idle state";
-      context.m_state = CryptoNoteConnectionContext::state_idle;
-      context.m_needed_objects.clear();
-      context.m_requested_objects.clear();
-      return 1;
+      logger(DEBUGGING) << peer << "Block already exists, switching to idle state";
+      return CommitResult::idle;
     }
-
-    m_dispatcher.yield();
   }
 
-  return 0;
+  return CommitResult::ok;
 
 }
 
@@ -805,6 +973,103 @@ int CryptoNoteProtocolHandler::handle_notify_missing_txs(int command, NOTIFY_MIS
   return 1;
 }
 
+int CryptoNoteProtocolHandler::handle_notify_tx_announce(int command, NOTIFY_TX_ANNOUNCE::request &arg,
+                                                         CryptoNoteConnectionContext &context)
+{
+  logger(logging::TRACE) << context << "NOTIFY_TX_ANNOUNCE: txs.size() = " << arg.txs.size();
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal)
+    return 1;
+
+  if (arg.txs.size() > P2P_TX_ANNOUNCE_MAX_COUNT)
+  {
+    logger(logging::DEBUGGING) << context << "NOTIFY_TX_ANNOUNCE with too many hashes, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  // the answer would be taken for the missing transactions of the lite block
+  if (context.m_pending_lite_block)
+    return 1;
+
+  std::list<Transaction> txs;
+  std::list<crypto::Hash> missedHashes;
+  m_core.getTransactions(arg.txs, txs, missedHashes, true);
+
+  auto now = std::chrono::steady_clock::now();
+  NOTIFY_REQUEST_TXS::request req;
+  size_t dropped = 0;
+  for (const auto &hash : missedHashes)
+  {
+    auto requested = m_requestedTxs.find(hash);
+    if (requested == m_requestedTxs.end())
+    {
+      auto awaited = m_requestedTxsPerPeer.find(context.m_connection_id);
+      if (m_requestedTxs.size() >= P2P_TX_REQUEST_MAX_COUNT ||
+          (awaited != m_requestedTxsPerPeer.end() && awaited->second >= P2P_TX_REQUEST_MAX_COUNT_PER_PEER))
+      {
+        // the transaction still arrives with the block or through the announcement of another peer
+        ++dropped;
+        continue;
+      }
+
+      RequestedTx &request = m_requestedTxs[hash];
+      request.requestTime = now;
+      awaitTransactionFrom(request, context.m_connection_id);
+      req.txs.push_back(hash);
+    }
+    else if (requested->second.requestedFrom != context.m_connection_id &&
+             std::find(requested->second.announcers.begin(), requested->second.announcers.end(), context.m_connection_id) == requested->second.announcers.end())
+    {
+      // another peer announced it first and is still expected to answer, this one is asked if it does not
+      requested->second.announcers.push_back(context.m_connection_id);
+    }
+  }
+
+  if (dropped != 0)
+  {
+    logger(logging::DEBUGGING) << context << "NOTIFY_TX_ANNOUNCE: " << dropped << " hashes dropped, too many transactions requested";
+  }
+
+  if (!req.txs.empty())
+  {
+    post_notify<NOTIFY_REQUEST_TXS>(*m_p2p, req, context);
+  }
+
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_request_txs(int command, NOTIFY_REQUEST_TXS::request &arg,
+                                                  CryptoNoteConnectionContext &context)
+{
+  logger(logging::TRACE) << context << "NOTIFY_REQUEST_TXS: txs.size() = " << arg.txs.size();
+
+  if (arg.txs.size() > P2P_TX_ANNOUNCE_MAX_COUNT)
+  {
+    logger(logging::DEBUGGING) << context << "NOTIFY_REQUEST_TXS with too many hashes, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  // transactions which left the pool in the meantime are skipped, the peer gets them with the block
+  std::list<Transaction> txs;
+  std::list<crypto::Hash> missedHashes;
+  m_core.getTransactions(arg.txs, txs, missedHashes, true);
+
+  if (!txs.empty())
+  {
+    NOTIFY_NEW_TRANSACTIONS::request notification;
+    for (auto &tx : txs)
+    {
+      notification.txs.push_back(asString(toBinaryArray(tx)));
+    }
+
+    post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+  }
+
+  return 1;
+}
+
 int CryptoNoteProtocolHandler::handle_request_tx_pool(int command, NOTIFY_REQUEST_TX_POOL::request &arg,
                                                       CryptoNoteConnectionContext &context)
 {
@@ -880,8 +1145,165 @@ void CryptoNoteProtocolHandler::relay_block(NOTIFY_NEW_BLOCK::request &arg)
 
 void CryptoNoteProtocolHandler::relay_transactions(NOTIFY_NEW_TRANSACTIONS::request &arg)
 {
-  auto buf = LevinProtocol::encode(arg);
-  m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf, nullptr);
+  // the announce queue and the connections are only touched on the dispatcher thread
+  m_dispatcher.remoteSpawn([this, arg]() mutable { relayTransactions(arg, nullptr); });
+}
+
+void CryptoNoteProtocolHandler::relayTransactions(NOTIFY_NEW_TRANSACTIONS::request &arg, const net_connection_id *excludeConnection)
+{
+  net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
+  std::list<boost::uuids::uuid> legacyConnections;
+  bool haveAnnounceConnections = false;
+
+  // sort the peers into their support categories
+  m_p2p->for_each_connection([&](const CryptoNoteConnectionContext &ctx, PeerIdType peerId) {
+    if (peerId == 0 || ctx.m_connection_id == excludeId)
+    {
+      return;
+    }
+
+    if (ctx.m_support_flags & P2P_SUPPORT_FLAG_TX_ANNOUNCE)
+    {
+      haveAnnounceConnections = true;
+    }
+    else
+    {
+      legacyConnections.push_back(ctx.m_connection_id);
+    }
+  });
+
+  if (!legacyConnections.empty())
+  {
+    m_p2p->externalRelayNotifyToList(NOTIFY_NEW_TRANSACTIONS::ID, LevinProtocol::encode(arg), legacyConnections);
+  }
+
+  if (haveAnnounceConnections)
+  {
+    for (const auto &tx : arg.txs)
+    {
+      m_txAnnounceQueue.emplace_back(crypto::cn_fast_hash(tx.data(), tx.size()), excludeId);
+    }
+  }
+}
+
+void CryptoNoteProtocolHandler::awaitTransactionFrom(RequestedTx &request, const net_connection_id &peer)
+{
+  request.requestedFrom = peer;
+  ++m_requestedTxsPerPeer[peer];
+}
+
+void CryptoNoteProtocolHandler::releaseTransactionRequest(const RequestedTx &request)
+{
+  auto awaited = m_requestedTxsPerPeer.find(request.requestedFrom);
+  if (awaited != m_requestedTxsPerPeer.end() && --awaited->second == 0)
+  {
+    m_requestedTxsPerPeer.erase(awaited);
+  }
+}
+
+void CryptoNoteProtocolHandler::announceTransactions(std::chrono::steady_clock::time_point now)
+{
+  std::map<net_connection_id, NOTIFY_REQUEST_TXS::request> retries;
+  for (auto it = m_requestedTxs.begin(); it != m_requestedTxs.end();)
+  {
+    RequestedTx &request = it->second;
+    if (now - request.requestTime < std::chrono::seconds(P2P_TX_REQUEST_TIMEOUT))
+    {
+      ++it;
+    }
+    else if (request.announcers.empty())
+    {
+      releaseTransactionRequest(request);
+      it = m_requestedTxs.erase(it);
+    }
+    else
+    {
+      // the requested peer stayed silent, the next one that announced the transaction is asked
+      releaseTransactionRequest(request);
+      request.requestTime = now;
+      awaitTransactionFrom(request, request.announcers.front());
+      request.announcers.pop_front();
+      retries[request.requestedFrom].txs.push_back(it->first);
+      ++it;
+    }
+  }
+
+  if (!retries.empty())
+  {
+    std::vector<std::pair<CryptoNoteConnectionContext *, NOTIFY_REQUEST_TXS::request>> requests;
+    m_p2p->for_each_connection([&](CryptoNoteConnectionContext &ctx, PeerIdType peerId) {
+      auto retry = retries.find(ctx.m_connection_id);
+      // the answer of a connection waiting for lite block transactions would be taken for them
+      if (retry != retries.end() && ctx.m_state == CryptoNoteConnectionContext::state_normal && !ctx.m_pending_lite_block)
+      {
+        requests.emplace_back(&ctx, std::move(retry->second));
+        retries.erase(retry);
+      }
+    });
+
+    for (auto &request : requests)
+    {
+      auto &txs = request.second.txs;
+      for (size_t offset = 0; offset < txs.size(); offset += P2P_TX_ANNOUNCE_MAX_COUNT)
+      {
+        NOTIFY_REQUEST_TXS::request chunk;
+        chunk.txs.assign(txs.begin() + offset, txs.begin() + std::min(txs.size(), offset + P2P_TX_ANNOUNCE_MAX_COUNT));
+        post_notify<NOTIFY_REQUEST_TXS>(*m_p2p, chunk, *request.first);
+      }
+    }
+
+    // the peers that could not be asked are passed over on the next call
+    for (const auto &retry : retries)
+    {
+      for (const auto &hash : retry.second.txs)
+      {
+        m_requestedTxs[hash].requestTime = now - std::chrono::seconds(P2P_TX_REQUEST_TIMEOUT);
+      }
+    }
+  }
+
+  if (m_txAnnounceQueue.empty())
+  {
+    return;
+  }
+
+  std::vector<std::pair<crypto::Hash, net_connection_id>> queue;
+  queue.swap(m_txAnnounceQueue);
+
+  std::vector<std::pair<CryptoNoteConnectionContext *, NOTIFY_TX_ANNOUNCE::request>> announcements;
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext &ctx, PeerIdType peerId) {
+    if (peerId == 0 || !(ctx.m_support_flags & P2P_SUPPORT_FLAG_TX_ANNOUNCE) ||
+        (ctx.m_state != CryptoNoteConnectionContext::state_normal && ctx.m_state != CryptoNoteConnectionContext::state_synchronizing))
+    {
+      return;
+    }
+
+    NOTIFY_TX_ANNOUNCE::request announcement;
+    for (const auto &entry : queue)
+    {
+      // the peer we got the transaction from already has it
+      if (entry.second != ctx.m_connection_id)
+      {
+        announcement.txs.push_back(entry.first);
+      }
+    }
+
+    if (!announcement.txs.empty())
+    {
+      announcements.emplace_back(&ctx, std::move(announcement));
+    }
+  });
+
+  for (auto &announcement : announcements)
+  {
+    auto &txs = announcement.second.txs;
+    for (size_t offset = 0; offset < txs.size(); offset += P2P_TX_ANNOUNCE_MAX_COUNT)
+    {
+      NOTIFY_TX_ANNOUNCE::request chunk;
+      chunk.txs.assign(txs.begin() + offset, txs.begin() + std::min(txs.size(), offset + P2P_TX_ANNOUNCE_MAX_COUNT));
+      post_notify<NOTIFY_TX_ANNOUNCE>(*m_p2p, chunk, *announcement.first);
+    }
+  }
 }
 
 void CryptoNoteProtocolHandler::requestMissingPoolTransactions(const CryptoNoteConnectionContext &context)
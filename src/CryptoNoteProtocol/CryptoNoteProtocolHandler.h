@@ -8,8 +8,15 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 #include <Common/ObserverManager.h>
+#include <Common/WorkerPool.h>
+#include <System/Event.h>
 
 #include "CryptoNoteCore/ICore.h"
 
@@ -42,6 +49,9 @@ namespace cn
     {
       Block block;
       std::vector<BinaryArray> txs;
+      // computed while parsing, not serialized
+      crypto::Hash hash;
+      std::vector<crypto::Hash> txHashes;
 
       void serialize(ISerializer& s) {
         KV_MEMBER(block);
@@ -73,6 +83,9 @@ namespace cn
     virtual size_t getPeerCount() const override;
     virtual uint32_t getObservedHeight() const override;
     void requestMissingPoolTransactions(const CryptoNoteConnectionContext& context);
+    // sends the hashes of the transactions accepted since the last call to the peers supporting P2P_SUPPORT_FLAG_TX_ANNOUNCE,
+    // announced transactions not delivered within P2P_TX_REQUEST_TIMEOUT are requested from the next peer that announced them
+    void announceTransactions(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
 
   private:
     //----------------- commands handlers ----------------------------------------------
@@ -85,6 +98,8 @@ namespace cn
     int handle_request_tx_pool(int command, NOTIFY_REQUEST_TX_POOL::request &arg, CryptoNoteConnectionContext &context);
     int handle_notify_new_lite_block(int command, NOTIFY_NEW_LITE_BLOCK::request &arg, CryptoNoteConnectionContext &context);
     int handle_notify_missing_txs(int command, NOTIFY_MISSING_TXS::request &arg, CryptoNoteConnectionContext &context);
+    int handle_notify_tx_announce(int command, NOTIFY_TX_ANNOUNCE::request &arg, CryptoNoteConnectionContext &context);
+    int handle_request_txs(int command, NOTIFY_REQUEST_TXS::request &arg, CryptoNoteConnectionContext &context);
 
 
     //----------------- i_cryptonote_protocol ----------------------------------
@@ -97,10 +112,46 @@ namespace cn
     bool on_connection_synchronized();
     void updateObservedHeight(uint32_t peerHeight, const CryptoNoteConnectionContext& context);
     void recalculateMaxObservedHeight(const CryptoNoteConnectionContext& context);
-    int processObjects(CryptoNoteConnectionContext& context, const std::vector<parsed_block_entry>& blocks);
     logging::LoggerRef logger;
 
   private:
+    enum class CommitResult
+    {
+      ok,
+      idle,
+      shutdown
+    };
+
+    // the blocks of a NOTIFY_RESPONSE_GET_OBJECTS, parsed and waiting for or going through the commit stage
+    struct SyncBatch
+    {
+      explicit SyncBatch(platform_system::Dispatcher& dispatcher) : result(CommitResult::ok), done(dispatcher) {}
+
+      std::string peer; // the connection the blocks came from, for the log
+      std::vector<parsed_block_entry> blocks;
+      CommitResult result;
+      platform_system::Event done; // set on the dispatcher thread once the blocks are committed
+    };
+
+    // a transaction announced by hash and requested from one of the peers that announced it
+    struct RequestedTx
+    {
+      std::chrono::steady_clock::time_point requestTime;
+      net_connection_id requestedFrom;
+      std::deque<net_connection_id> announcers; // asked in turn when the requested peer does not answer
+    };
+
+    void runOnSyncWorkers(const std::function<void()>& job);
+    void queueCommit(const std::shared_ptr<SyncBatch>& batch);
+    void startCommit();
+    void waitCommit(SyncBatch& batch);
+    bool applyCommitResult(CryptoNoteConnectionContext& context, CommitResult result);
+    CommitResult commitBatch(SyncBatch& batch);
+    CommitResult processObjects(const std::string& peer, const std::vector<parsed_block_entry>& blocks);
+
+    void relayTransactions(NOTIFY_NEW_TRANSACTIONS::request& arg, const net_connection_id* excludeConnection);
+    void awaitTransactionFrom(RequestedTx& request, const net_connection_id& peer);
+    void releaseTransactionRequest(const RequestedTx& request);
     int doPushLiteBlock(NOTIFY_NEW_LITE_BLOCK::request block, CryptoNoteConnectionContext &context, std::vector<BinaryArray> missingTxs);
 
     platform_system::Dispatcher& m_dispatcher;
@@ -111,12 +162,25 @@ namespace cn
     IP2pEndpoint* m_p2p;
     std::atomic<bool> m_synchronized;
     std::atomic<bool> m_stop;
-    std::recursive_mutex m_sync_lock;    
 
     mutable std::mutex m_observedHeightMutex;
     uint32_t m_observedHeight;
 
     std::atomic<size_t> m_peersCount;
     tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
+
+    // sync responses are parsed on m_syncWorkers, then committed one batch at a time on m_commitWorkers,
+    // so parsing never waits for the proof of work hashing of a commit; touched on the dispatcher thread only
+    std::deque<std::shared_ptr<SyncBatch>> m_commitQueue; // at most BLOCKS_SYNCHRONIZING_COMMIT_QUEUE_SIZE batches
+    bool m_committing;
+    platform_system::Event m_commitQueueSpace;
+    std::map<net_connection_id, std::shared_ptr<SyncBatch>> m_pendingCommits; // collected with the next response of the connection
+    tools::WorkerPool m_syncWorkers;
+    tools::WorkerPool m_commitWorkers;
+
+    // touched on the dispatcher thread only
+    std::vector<std::pair<crypto::Hash, net_connection_id>> m_txAnnounceQueue; // accepted transactions and the connection they came from
+    std::unordered_map<crypto::Hash, RequestedTx> m_requestedTxs; // at most P2P_TX_REQUEST_MAX_COUNT transactions
+    std::map<net_connection_id, size_t> m_requestedTxsPerPeer; // at most P2P_TX_REQUEST_MAX_COUNT_PER_PEER requests awaited from each peer
   };
 }
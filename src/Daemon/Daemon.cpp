@@ -8,6 +8,8 @@
 
 #include "version.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
@@ -53,6 +55,7 @@ namespace
   const command_line::arg_descriptor<int>         arg_log_level   = {"log-level", "", 2};
   const command_line::arg_descriptor<bool>        arg_console     = {"no-console", "Disable daemon console commands"};
   const command_line::arg_descriptor<bool>        arg_print_genesis_tx = { "print-genesis-tx", "Prints genesis' block tx hex to insert it to config and exits" };
+  const command_line::arg_descriptor<std::string> arg_dispatcher  = {"dispatcher", "Event loop of the network and RPC threads: epoll or io_uring (Linux 5.7 and later)", "epoll"};
 }
 
 void print_genesis_tx_hex() {
@@ -118,7 +121,9 @@ int main(int argc, char* argv[])
     command_line::add_arg(desc_cmd_sett, arg_set_view_key);
     command_line::add_arg(desc_cmd_sett, command_line::arg_testnet_on);
     command_line::add_arg(desc_cmd_sett, arg_print_genesis_tx);
+    command_line::add_arg(desc_cmd_sett, arg_dispatcher);
 
+    CoreConfig::initOptions(desc_cmd_sett);
     RpcServerConfig::initOptions(desc_cmd_sett);
     NetNodeConfig::initOptions(desc_cmd_sett);
     MinerConfig::initOptions(desc_cmd_sett);
@@ -173,6 +178,7 @@ int main(int argc, char* argv[])
       }
 
       po::notify(vm);
+      coreConfig.init(vm);
       return true;
     });
 
@@ -252,8 +258,29 @@ int main(int argc, char* argv[])
         throw std::runtime_error("Can't create directory: " + coreConfig.configFolder);
     }
 
+    std::string dispatcherBackend = command_line::get_arg(vm, arg_dispatcher);
+    if (dispatcherBackend != "epoll" && dispatcherBackend != "io_uring")
+      throw std::runtime_error("Unknown dispatcher: " + dispatcherBackend);
+
+#ifdef __linux__
+    // every dispatcher of the daemon, the ones of the RPC threads included, picks its backend from the environment
+    if (command_line::has_arg_2(vm, arg_dispatcher))
+      setenv("CONCEAL_DISPATCHER", dispatcherBackend.c_str(), 1);
+#endif
+
     platform_system::Dispatcher dispatcher;
 
+#ifdef __linux__
+    const char* requestedBackend = getenv("CONCEAL_DISPATCHER");
+    if (dispatcher.getIoUring() != nullptr)
+      logger(INFO) << "Using the io_uring dispatcher";
+    else if (requestedBackend != nullptr && strcmp(requestedBackend, "io_uring") == 0)
+      logger(WARNING, BRIGHT_YELLOW) << "io_uring is not supported by this kernel, falling back to the epoll dispatcher";
+#else
+    if (dispatcherBackend == "io_uring")
+      logger(WARNING, BRIGHT_YELLOW) << "io_uring is only available on Linux, using the default dispatcher";
+#endif
+
     cn::CryptoNoteProtocolHandler cprotocol(currency, dispatcher, ccore, nullptr, logManager);
     cn::NodeServer p2psrv(dispatcher, cprotocol, logManager);
     cn::RpcServer rpcServer(dispatcher, logManager, ccore, p2psrv, cprotocol);
@@ -329,6 +356,10 @@ int main(int argc, char* argv[])
       }
     }
  
+    rpcServer.setWorkerThreads(rpcConfig.threads);
+    rpcServer.setMaxConcurrentRequests(rpcConfig.maxConcurrentRequests);
+    rpcServer.setMaxRequestBodySize(rpcConfig.maxRequestSize * 1024 * 1024);
+    rpcServer.setResponseCacheSize(rpcConfig.cacheSize * 1024 * 1024);
     rpcServer.start(rpcConfig.bindIp, rpcConfig.bindPort);
     rpcServer.enableCors(rpcConfig.enableCors);
     logger(INFO) << "Core rpc server started ok";
@@ -0,0 +1,95 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "HttpInputBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#include "HttpParserErrorCodes.h"
+
+namespace {
+
+const size_t INITIAL_BUFFER_SIZE = 16384;
+// the body grows by at most this much ahead of the data read into it
+const size_t BODY_CHUNK_SIZE = 65536;
+const char HEAD_END[] = "\r\n\r\n";
+const size_t HEAD_END_SIZE = sizeof(HEAD_END) - 1;
+
+}
+
+namespace cn {
+
+HttpInputBuffer::HttpInputBuffer(ReadFunction read) : m_read(std::move(read)), m_buffer(INITIAL_BUFFER_SIZE), m_begin(0), m_end(0) {
+}
+
+bool HttpInputBuffer::waitForData() {
+  return m_begin != m_end || fill();
+}
+
+const char* HttpInputBuffer::readHead(size_t& size) {
+  size_t scanned = m_begin;
+  for (;;) {
+    auto end = std::search(m_buffer.begin() + scanned, m_buffer.begin() + m_end, HEAD_END, HEAD_END + HEAD_END_SIZE);
+    if (end != m_buffer.begin() + m_end) {
+      const char* head = m_buffer.data() + m_begin;
+      size = end - m_buffer.begin() + HEAD_END_SIZE - m_begin;
+      m_begin += size;
+      return head;
+    }
+
+    if (m_end - m_begin >= MAX_HEAD_SIZE) {
+      throw std::system_error(make_error_code(error::HttpParserErrorCodes::HEAD_TOO_LARGE));
+    }
+
+    // a terminator split between two reads is found by rescanning its first bytes
+    size_t rescan = std::min(m_end - m_begin, HEAD_END_SIZE - 1);
+    scanned = m_end - rescan - m_begin;
+    if (!fill()) {
+      throw std::system_error(make_error_code(error::HttpParserErrorCodes::END_OF_STREAM));
+    }
+
+    scanned += m_begin;
+  }
+}
+
+void HttpInputBuffer::readBody(std::string& body, size_t size) {
+  size_t buffered = std::min(size, m_end - m_begin);
+  body.assign(m_buffer.data() + m_begin, buffered);
+  m_begin += buffered;
+  if (buffered == size) {
+    return;
+  }
+
+  while (buffered < size) {
+    body.resize(std::min(size, buffered + BODY_CHUNK_SIZE));
+    size_t read = m_read(&body[buffered], body.size() - buffered);
+    if (read == 0) {
+      throw std::system_error(make_error_code(error::HttpParserErrorCodes::END_OF_STREAM));
+    }
+
+    buffered += read;
+    body.resize(buffered);
+  }
+}
+
+bool HttpInputBuffer::fill() {
+  if (m_begin != 0) {
+    std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+    m_end -= m_begin;
+    m_begin = 0;
+  }
+
+  if (m_end == m_buffer.size()) {
+    m_buffer.resize(m_buffer.size() * 2);
+  }
+
+  size_t read = m_read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+  m_end += read;
+  return read != 0;
+}
+
+}
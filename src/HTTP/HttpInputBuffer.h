@@ -0,0 +1,45 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cn {
+
+// Read buffer of one HTTP connection. Message heads are parsed in place in the buffer,
+// bodies are read straight into the message
+class HttpInputBuffer {
+public:
+  // Reads up to size bytes into data, returns 0 at the end of the stream
+  typedef std::function<size_t(char* data, size_t size)> ReadFunction;
+
+  static const size_t MAX_HEAD_SIZE = 65536;
+
+  explicit HttpInputBuffer(ReadFunction read);
+
+  // Blocks until data is available, false at the end of the stream
+  bool waitForData();
+
+  // Returns the message head up to and including the empty line that ends it. The range stays valid
+  // until the next call.
+  const char* readHead(size_t& size);
+
+  // Fills body with size bytes, buffered ones first and the rest read straight into it. The body
+  // grows as the data arrives rather than to the announced size up front.
+  void readBody(std::string& body, size_t size);
+
+private:
+  bool fill();
+
+  ReadFunction m_read;
+  std::vector<char> m_buffer;
+  size_t m_begin;
+  size_t m_end;
+};
+
+}
@@ -13,6 +13,16 @@
 
 namespace {
 
+const char* findLineEnd(const char* begin, const char* end) {
+  const char crlf[] = "\r\n";
+  const char* lineEnd = std::search(begin, end, crlf, crlf + 2);
+  if (lineEnd == end) {
+    throw std::system_error(make_error_code(cn::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+  }
+
+  return lineEnd;
+}
+
 void throwIfNotGood(std::istream& stream) {
   if (!stream.good()) {
     if (stream.eof()) {
@@ -41,6 +51,10 @@ namespace cn {
     {
       return cn::HttpResponse::STATUS_404;
     }
+    else if (status.substr(0, 4) == "413 ")
+    {
+      return cn::HttpResponse::STATUS_413;
+    }
     else if (status == "500 Internal Server Error")
     {
       return cn::HttpResponse::STATUS_500;
@@ -119,6 +133,78 @@ void HttpParser::receiveResponse(std::istream& stream, HttpResponse& response) {
 }
 
 
+void HttpParser::receiveRequest(HttpInputBuffer& input, HttpRequest& request, size_t maxBodySize) {
+  size_t size;
+  const char* head = input.readHead(size);
+  const char* end = head + size;
+
+  const char* lineEnd = findLineEnd(head, end);
+  const char* methodEnd = std::find(head, lineEnd, ' ');
+  const char* urlEnd = methodEnd == lineEnd ? lineEnd : std::find(methodEnd + 1, lineEnd, ' ');
+  if (urlEnd == lineEnd) {
+    throw std::system_error(make_error_code(cn::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+  }
+
+  request.method.assign(head, methodEnd);
+  request.url.assign(methodEnd + 1, urlEnd);
+  parseHeaders(lineEnd + 2, end, request.headers);
+
+  size_t bodyLen = getBodyLen(request.headers);
+  if (bodyLen > maxBodySize) {
+    throw std::system_error(make_error_code(cn::error::HttpParserErrorCodes::BODY_TOO_LARGE));
+  }
+
+  if (bodyLen) {
+    input.readBody(request.body, bodyLen);
+  }
+}
+
+void HttpParser::receiveResponse(HttpInputBuffer& input, HttpResponse& response) {
+  size_t size;
+  const char* head = input.readHead(size);
+  const char* end = head + size;
+
+  const char* lineEnd = findLineEnd(head, end);
+  const char* versionEnd = std::find(head, lineEnd, ' ');
+  if (versionEnd == lineEnd) {
+    throw std::system_error(make_error_code(cn::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+  }
+
+  response.setStatus(parseResponseStatusFromString(std::string(versionEnd + 1, lineEnd)));
+  parseHeaders(lineEnd + 2, end, response.headers);
+
+  std::string body;
+  size_t bodyLen = getBodyLen(response.headers);
+  if (bodyLen) {
+    input.readBody(body, bodyLen);
+  }
+
+  response.setBody(std::move(body));
+}
+
+void HttpParser::parseHeaders(const char* begin, const char* end, std::map<std::string, std::string>& headers) {
+  // the head ends with an empty line
+  end -= 2;
+  while (begin < end) {
+    const char* lineEnd = findLineEnd(begin, end + 2);
+    const char* colon = std::find(begin, lineEnd, ':');
+    if (colon == begin) {
+      throw std::system_error(make_error_code(cn::error::HttpParserErrorCodes::EMPTY_HEADER));
+    }
+
+    std::string name(begin, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    const char* value = colon == lineEnd ? lineEnd : colon + 1;
+    while (value < lineEnd && (*value == ' ' || *value == '\t')) {
+      ++value;
+    }
+
+    headers[name].assign(value, lineEnd);
+    begin = lineEnd + 2;
+  }
+}
+
 void HttpParser::readWord(std::istream& stream, std::string& word) {
   char c;
 
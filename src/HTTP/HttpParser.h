@@ -9,8 +9,10 @@
 #define HTTPPARSER_H_
 
 #include <iostream>
+#include <limits>
 #include <map>
 #include <string>
+#include "HttpInputBuffer.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
 
@@ -23,8 +25,15 @@ public:
 
   void receiveRequest(std::istream& stream, HttpRequest& request);
   void receiveResponse(std::istream& stream, HttpResponse& response);
+
+  // Parse the head in place in the connection buffer and read the body straight into the message.
+  // A request announcing a body above maxBodySize throws BODY_TOO_LARGE before any of it is read.
+  void receiveRequest(HttpInputBuffer& input, HttpRequest& request, size_t maxBodySize = std::numeric_limits<size_t>::max());
+  void receiveResponse(HttpInputBuffer& input, HttpResponse& response);
+
   static HttpResponse::HTTP_STATUS parseResponseStatusFromString(const std::string& status);
 private:
+  void parseHeaders(const char* begin, const char* end, std::map<std::string, std::string>& headers);
   void readWord(std::istream& stream, std::string& word);
   void readHeaders(std::istream& stream, HttpRequest::Headers &headers);
   bool readHeader(std::istream& stream, std::string& name, std::string& value);
@@ -6,6 +6,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "HttpRequest.h"
+#include "HttpWriter.h"
 
 namespace cn {
 
@@ -29,7 +30,11 @@ namespace cn {
     headers[name] = value;
   }
   void HttpRequest::setBody(const std::string& b) {
-    body = b;
+    setBody(std::string(b));
+  }
+
+  void HttpRequest::setBody(std::string&& b) {
+    body = std::move(b);
     if (!body.empty()) {
       headers["Content-Length"] = std::to_string(body.size());
     }
@@ -42,6 +47,16 @@ namespace cn {
     url = u;
   }
 
+  void HttpRequest::write(const std::function<void(const char* data, size_t size)>& write) const {
+    std::string head;
+    head.append("POST ").append(url).append(" HTTP/1.1\r\n");
+    if (headers.find("Host") == headers.end()) {
+      head.append("Host: 127.0.0.1\r\n");
+    }
+
+    writeHttpMessage(std::move(head), headers, body, write);
+  }
+
   std::ostream& HttpRequest::printHttpRequest(std::ostream& os) const {
     os << "POST " << url << " HTTP/1.1\r\n";
     auto host = headers.find("Host");
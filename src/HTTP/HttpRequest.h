@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <functional>
 #include <iostream>
 #include <map>
 #include <string>
@@ -23,8 +24,12 @@ namespace cn {
 
     void addHeader(const std::string& name, const std::string& value);
     void setBody(const std::string& b);
+    void setBody(std::string&& b);
     void setUrl(const std::string& uri);
 
+    // Hands the head and the body to write without joining them, small bodies are sent with the head
+    void write(const std::function<void(const char* data, size_t size)>& write) const;
+
   private:
     friend class HttpParser;
 
@@ -6,6 +6,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "HttpResponse.h"
+#include "HttpWriter.h"
 
 #include <stdexcept>
 
@@ -21,6 +22,8 @@ namespace {
       return "401 Unauthorized";
     case cn::HttpResponse::STATUS_404:
       return "404 Not Found";
+    case cn::HttpResponse::STATUS_413:
+      return "413 Payload Too Large";
     case cn::HttpResponse::STATUS_500:
       return "500 Internal Server Error";
     default:
@@ -36,6 +39,8 @@ namespace {
       return "Authorization required\n";
     case cn::HttpResponse::STATUS_404:
       return "Requested url is not found\n";
+    case cn::HttpResponse::STATUS_413:
+      return "Request body is too large\n";
     case cn::HttpResponse::STATUS_500:
       return "Internal server error is occurred\n";
     default:
@@ -65,7 +70,11 @@ void HttpResponse::addHeader(const std::string& name, const std::string& value)
 }
 
 void HttpResponse::setBody(const std::string& b) {
-  body = b;
+  setBody(std::string(b));
+}
+
+void HttpResponse::setBody(std::string&& b) {
+  body = std::move(b);
   if (!body.empty()) {
     headers["Content-Length"] = std::to_string(body.size());
   } else {
@@ -73,6 +82,10 @@ void HttpResponse::setBody(const std::string& b) {
   }
 }
 
+void HttpResponse::write(const std::function<void(const char* data, size_t size)>& write) const {
+  writeHttpMessage(std::string("HTTP/1.1 ").append(getStatusString(status)).append("\r\n"), headers, body, write);
+}
+
 std::ostream& HttpResponse::printHttpResponse(std::ostream& os) const {
   os << "HTTP/1.1 " << getStatusString(status) << "\r\n";
 
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <functional>
 #include <ostream>
 #include <string>
 #include <map>
@@ -19,6 +20,7 @@ namespace cn {
       STATUS_200,
       STATUS_401,
       STATUS_404,
+      STATUS_413,
       STATUS_500
     };
 
@@ -27,12 +29,17 @@ namespace cn {
     void setStatus(HTTP_STATUS s);
     void addHeader(const std::string& name, const std::string& value);
     void setBody(const std::string& b);
+    void setBody(std::string&& b);
 
     const std::map<std::string, std::string>& getHeaders() const { return headers; }
     HTTP_STATUS getStatus() const { return status; }
     const std::string& getBody() const { return body; }
 
+    // Hands the head and the body to write without joining them, small bodies are sent with the head
+    void write(const std::function<void(const char* data, size_t size)>& write) const;
+
   private:
+    friend class HttpParser;
     friend std::ostream& operator<<(std::ostream& os, const HttpResponse& resp);
     std::ostream& printHttpResponse(std::ostream& os) const;
 
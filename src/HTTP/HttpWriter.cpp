@@ -0,0 +1,42 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "HttpWriter.h"
+
+#include <System/TcpConnection.h>
+
+namespace {
+  const size_t HEAD_RESERVE_SIZE = 256;
+  const size_t INLINE_BODY_SIZE = 16384;
+}
+
+namespace cn {
+
+void writeHttpMessage(std::string head, const std::map<std::string, std::string>& headers, const std::string& body,
+  const HttpWriteFunction& write) {
+  head.reserve(head.size() + HEAD_RESERVE_SIZE + (body.size() <= INLINE_BODY_SIZE ? body.size() : 0));
+  for (const auto& pair : headers) {
+    head.append(pair.first).append(": ").append(pair.second).append("\r\n");
+  }
+
+  head.append("\r\n");
+  if (body.size() <= INLINE_BODY_SIZE) {
+    head.append(body);
+    write(head.data(), head.size());
+  } else {
+    write(head.data(), head.size());
+    write(body.data(), body.size());
+  }
+}
+
+void writeAll(platform_system::TcpConnection& connection, const char* data, size_t size) {
+  while (size > 0) {
+    size_t written = connection.write(reinterpret_cast<const uint8_t*>(data), size);
+    data += written;
+    size -= written;
+  }
+}
+
+}
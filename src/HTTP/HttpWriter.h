@@ -0,0 +1,28 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+
+namespace platform_system {
+class TcpConnection;
+}
+
+namespace cn {
+
+typedef std::function<void(const char* data, size_t size)> HttpWriteFunction;
+
+// Hands the start line, the headers and the body of a message to write, small bodies are copied
+// behind the head so the message goes out in one write
+void writeHttpMessage(std::string head, const std::map<std::string, std::string>& headers, const std::string& body,
+  const HttpWriteFunction& write);
+
+// Writes until the connection took all of the data
+void writeAll(platform_system::TcpConnection& connection, const char* data, size_t size);
+
+}
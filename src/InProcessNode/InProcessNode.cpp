@@ -221,6 +221,39 @@ std::error_code InProcessNode::doGetTransactionOutsGlobalIndices(const crypto::H
   return std::error_code();
 }
 
+void InProcessNode::getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+    std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  if (state != INITIALIZED) {
+    lock.unlock();
+    callback(make_error_code(cn::error::NOT_INITIALIZED));
+    return;
+  }
+
+  ioService.post(
+    std::bind(&InProcessNode::getTransactionsOutsGlobalIndicesAsync,
+      this,
+      std::cref(transactionHashes),
+      std::ref(outsGlobalIndices),
+      callback
+    )
+  );
+}
+
+void InProcessNode::getTransactionsOutsGlobalIndicesAsync(const std::vector<crypto::Hash>& transactionHashes,
+    std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback)
+{
+  std::error_code ec;
+  outsGlobalIndices.resize(transactionHashes.size());
+  for (size_t i = 0; i < transactionHashes.size() && !ec; ++i) {
+    outsGlobalIndices[i].clear();
+    ec = doGetTransactionOutsGlobalIndices(transactionHashes[i], outsGlobalIndices[i]);
+  }
+
+  callback(ec);
+}
+
 void InProcessNode::getRandomOutsByAmounts(std::vector<uint64_t>&& amounts, uint64_t outsCount,
     std::vector<cn::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result, const Callback& callback)
 {
@@ -21,7 +21,8 @@ enum NodeErrorCodes {
   NODE_BUSY,
   INTERNAL_NODE_ERROR,
   REQUEST_ERROR,
-  CONNECT_ERROR
+  CONNECT_ERROR,
+  UNSUPPORTED_REQUEST
 };
 
 // custom category:
@@ -46,6 +47,7 @@ public:
     case INTERNAL_NODE_ERROR: return "Internal node error";
     case REQUEST_ERROR:       return "Error in request parameters";
     case CONNECT_ERROR:       return "Can't connect to daemon";
+    case UNSUPPORTED_REQUEST: return "Request is not supported by the daemon";
     default:                  return "Unknown error";
     }
   }
@@ -8,6 +8,7 @@
 #include "NodeRpcProxy.h"
 #include "NodeErrors.h"
 
+#include <algorithm>
 #include <atomic>
 #include <system_error>
 #include <thread>
@@ -22,6 +23,7 @@
 #include <CryptoNoteCore/TransactionApi.h>
 
 #include "Common/StringTools.h"
+#include "CryptoNoteConfig.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
@@ -73,6 +75,7 @@ void NodeRpcProxy::resetInternalState() {
   m_networkHeight.store(0, std::memory_order_relaxed);
   m_lastKnowHash = cn::NULL_HASH;
   m_knownTxs.clear();
+  m_batchIndicesSupported = true;
 }
 
 void NodeRpcProxy::init(const INode::Callback& callback) {
@@ -352,6 +355,18 @@ void NodeRpcProxy::getTransactionOutsGlobalIndices(const crypto::Hash& transacti
     std::ref(outsGlobalIndices)), callback);
 }
 
+void NodeRpcProxy::getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+                                                    std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doGetTransactionsOutsGlobalIndices, this, transactionHashes,
+    std::ref(outsGlobalIndices)), callback);
+}
+
 void NodeRpcProxy::queryBlocks(std::vector<crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks,
   uint32_t& startHeight, const Callback& callback) {
   std::lock_guard<std::mutex> lock(m_mutex);
@@ -520,6 +535,54 @@ std::error_code NodeRpcProxy::doGetTransactionOutsGlobalIndices(const crypto::Ha
   return ec;
 }
 
+std::error_code NodeRpcProxy::doGetTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+                                                                 std::vector<std::vector<uint32_t>>& outsGlobalIndices) {
+  outsGlobalIndices.clear();
+  outsGlobalIndices.reserve(transactionHashes.size());
+
+  auto begin = transactionHashes.begin();
+  while (m_batchIndicesSupported && begin != transactionHashes.end()) {
+    auto end = begin + std::min<size_t>(transactionHashes.end() - begin, COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES_MAX_COUNT);
+
+    cn::COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::request req = AUTO_VAL_INIT(req);
+    cn::COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::response rsp = AUTO_VAL_INIT(rsp);
+    req.txids.assign(begin, end);
+
+    std::error_code ec = binaryCommand("/get_o_indexes_batch.bin", req, rsp);
+    if (ec == make_error_code(error::UNSUPPORTED_REQUEST)) {
+      // older nodes only answer one transaction per request
+      m_batchIndicesSupported = false;
+      break;
+    }
+
+    if (ec) {
+      return ec;
+    }
+
+    if (rsp.txs.size() != req.txids.size()) {
+      return make_error_code(error::INTERNAL_NODE_ERROR);
+    }
+
+    for (auto& tx : rsp.txs) {
+      outsGlobalIndices.push_back(std::move(tx.o_indexes));
+    }
+
+    begin = end;
+  }
+
+  for (; begin != transactionHashes.end(); ++begin) {
+    std::vector<uint32_t> indices;
+    std::error_code ec = doGetTransactionOutsGlobalIndices(*begin, indices);
+    if (ec) {
+      return ec;
+    }
+
+    outsGlobalIndices.push_back(std::move(indices));
+  }
+
+  return std::error_code();
+}
+
 std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<crypto::Hash>& knownBlockIds, uint64_t timestamp,
         std::vector<cn::BlockShortEntry>& newBlocks, uint32_t& startHeight) {
   cn::COMMAND_RPC_QUERY_BLOCKS_LITE::request req = AUTO_VAL_INIT(req);
@@ -681,6 +744,8 @@ std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Reques
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
+  } catch (const NotFoundException&) {
+    ec = make_error_code(error::UNSUPPORTED_REQUEST);
   } catch (const std::exception&) {
     ec = make_error_code(error::NETWORK_ERROR);
   }
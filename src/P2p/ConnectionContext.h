@@ -22,6 +22,7 @@ namespace cn {
 
 struct CryptoNoteConnectionContext {
   uint8_t version;
+  uint32_t m_support_flags = 0; // features supported by both ends of the connection
   boost::uuids::uuid m_connection_id;
   uint32_t m_remote_ip = 0;
   uint32_t m_remote_port = 0;
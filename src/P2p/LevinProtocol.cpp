@@ -6,6 +6,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "LevinProtocol.h"
+#include <cstring>
 #include <System/TcpConnection.h>
 
 using namespace cn;
@@ -32,6 +33,27 @@ struct bucket_head2
 };
 #pragma pack(pop)
 
+static_assert(sizeof(bucket_head2) == LevinProtocol::HEADER_SIZE, "Levin header size mismatch");
+
+bucket_head2 makeHead(uint32_t command, size_t size, bool needResponse, uint32_t flags, int32_t returnCode) {
+  bucket_head2 head = { 0 };
+  head.m_signature = LEVIN_SIGNATURE;
+  head.m_cb = size;
+  head.m_have_to_return_data = needResponse;
+  head.m_command = command;
+  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
+  head.m_flags = flags;
+  head.m_return_code = returnCode;
+  return head;
+}
+
+std::shared_ptr<const LevinProtocol::Packet> makePacket(const bucket_head2& head, BinaryArray body) {
+  auto packet = std::make_shared<LevinProtocol::Packet>();
+  memcpy(packet->header.data(), &head, sizeof(head));
+  packet->body = std::move(body);
+  return packet;
+}
+
 }
 
 bool LevinProtocol::Command::needReply() const {
@@ -41,24 +63,19 @@ bool LevinProtocol::Command::needReply() const {
 LevinProtocol::LevinProtocol(platform_system::TcpConnection& connection) 
   : m_conn(connection) {}
 
-void LevinProtocol::sendMessage(uint32_t command, const BinaryArray& out, bool needResponse) {
-  bucket_head2 head = { 0 };
-  head.m_signature = LEVIN_SIGNATURE;
-  head.m_cb = out.size();
-  head.m_have_to_return_data = needResponse;
-  head.m_command = command;
-  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-  head.m_flags = LEVIN_PACKET_REQUEST;
-
-  // write header and body in one operation
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
+std::shared_ptr<const LevinProtocol::Packet> LevinProtocol::makeMessage(uint32_t command, BinaryArray body, bool needResponse) {
+  bucket_head2 head = makeHead(command, body.size(), needResponse, LEVIN_PACKET_REQUEST, 0);
+  return makePacket(head, std::move(body));
+}
 
-  common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
+std::shared_ptr<const LevinProtocol::Packet> LevinProtocol::makeReply(uint32_t command, BinaryArray body, int32_t returnCode) {
+  bucket_head2 head = makeHead(command, body.size(), false, LEVIN_PACKET_RESPONSE, returnCode);
+  return makePacket(head, std::move(body));
+}
 
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+void LevinProtocol::sendMessage(uint32_t command, const BinaryArray& out, bool needResponse) {
+  bucket_head2 head = makeHead(command, out.size(), needResponse, LEVIN_PACKET_REQUEST, 0);
+  writeStrict(reinterpret_cast<const uint8_t*>(&head), sizeof(head), out);
 }
 
 bool LevinProtocol::readCommand(Command& cmd) {
@@ -94,23 +111,12 @@ bool LevinProtocol::readCommand(Command& cmd) {
 }
 
 void LevinProtocol::sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode) {
-  bucket_head2 head = { 0 };
-  head.m_signature = LEVIN_SIGNATURE;
-  head.m_cb = out.size();
-  head.m_have_to_return_data = false;
-  head.m_command = command;
-  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-  head.m_flags = LEVIN_PACKET_RESPONSE;
-  head.m_return_code = returnCode;
-
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
+  bucket_head2 head = makeHead(command, out.size(), false, LEVIN_PACKET_RESPONSE, returnCode);
+  writeStrict(reinterpret_cast<const uint8_t*>(&head), sizeof(head), out);
+}
 
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+void LevinProtocol::sendPacket(const Packet& packet) {
+  writeStrict(packet.header.data(), packet.header.size(), packet.body);
 }
 
 void LevinProtocol::writeStrict(const uint8_t* ptr, size_t size) {
@@ -120,6 +126,17 @@ void LevinProtocol::writeStrict(const uint8_t* ptr, size_t size) {
   }
 }
 
+// write header and body in one operation, the body is sent from the caller's buffer without copying
+void LevinProtocol::writeStrict(const uint8_t* head, size_t headSize, const BinaryArray& body) {
+  size_t offset = 0;
+  while (offset < headSize) {
+    offset += m_conn.write(head + offset, headSize - offset, body.data(), body.size());
+  }
+
+  offset -= headSize;
+  writeStrict(body.data() + offset, body.size() - offset);
+}
+
 bool LevinProtocol::readStrict(uint8_t* ptr, size_t size) {
   size_t offset = 0;
   while (offset < size) {
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
+
 #include "CryptoNote.h"
 #include <Common/MemoryInputStream.h>
 #include <Common/VectorOutputStream.h>
@@ -65,10 +68,22 @@ public:
     bool needReply() const;
   };
 
+  static const size_t HEADER_SIZE = 33;
+
+  // A message with its header, built once and written as is on any number of connections
+  struct Packet {
+    std::array<uint8_t, HEADER_SIZE> header;
+    BinaryArray body;
+  };
+
+  static std::shared_ptr<const Packet> makeMessage(uint32_t command, BinaryArray body, bool needResponse);
+  static std::shared_ptr<const Packet> makeReply(uint32_t command, BinaryArray body, int32_t returnCode);
+
   bool readCommand(Command& cmd);
 
   void sendMessage(uint32_t command, const BinaryArray& out, bool needResponse);
   void sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode);
+  void sendPacket(const Packet& packet);
 
   template <typename T>
   static bool decode(const BinaryArray& buf, T& value) {
@@ -97,6 +112,7 @@ private:
 
   bool readStrict(uint8_t* ptr, size_t size);
   void writeStrict(const uint8_t* ptr, size_t size);
+  void writeStrict(const uint8_t* head, size_t headSize, const BinaryArray& body);
   platform_system::TcpConnection& m_conn;
 };
 
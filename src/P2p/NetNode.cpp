@@ -208,7 +208,8 @@ namespace cn
     m_timeoutTimer(m_dispatcher),
     logger(log, "node_server"),
     m_payload_handler(payload_handler),
-    m_timedSyncTimer(m_dispatcher)    
+    m_timedSyncTimer(m_dispatcher),
+    m_txAnnounceTimer(m_dispatcher)
   {
   }
 
@@ -334,21 +335,23 @@ namespace cn
   //-----------------------------------------------------------------------------------
   void NodeServer::externalRelayNotifyToAll(int command, const BinaryArray &data_buff, const net_connection_id *excludeConnection)
   {
-    m_dispatcher.remoteSpawn([this, command, data_buff, excludeConnection] {
-      relay_notify_to_all(command, data_buff, excludeConnection);
+    auto packet = LevinProtocol::makeMessage(command, data_buff, false);
+    m_dispatcher.remoteSpawn([this, command, packet, excludeConnection] {
+      relayNotifyToAll(command, packet, excludeConnection);
     });
   }
 
   //-----------------------------------------------------------------------------------
   void NodeServer::externalRelayNotifyToList(int command, const BinaryArray &data_buff, const std::list<boost::uuids::uuid> &relayList)
   {
-    m_dispatcher.remoteSpawn([this, command, data_buff, relayList] {
-      forEachConnection([&relayList, &command, &data_buff](P2pConnectionContext &conn) {
+    auto packet = LevinProtocol::makeMessage(command, data_buff, false);
+    m_dispatcher.remoteSpawn([this, command, packet, relayList] {
+      forEachConnection([&relayList, &command, &packet](P2pConnectionContext &conn) {
         if (std::find(relayList.begin(), relayList.end(), conn.m_connection_id) != relayList.end())
         {
           if (conn.peerId && (conn.m_state == CryptoNoteConnectionContext::state_normal || conn.m_state == CryptoNoteConnectionContext::state_synchronizing))
           {
-            conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+            conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, packet));
           }
         }
       });
@@ -455,6 +458,7 @@ namespace cn
     std::copy(seedNodes.begin(), seedNodes.end(), std::back_inserter(m_seed_nodes));
 
     m_hide_my_port = config.getHideMyPort();
+    m_support_flags = config.getTxAnnounce() ? P2P_SUPPORT_FLAG_TX_ANNOUNCE : 0;
     return true;
   }
 
@@ -569,6 +573,9 @@ namespace cn
     m_workingContextGroup.spawn(std::bind(&NodeServer::onIdle, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timedSyncLoop, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timeoutLoop, this));
+    if (m_support_flags & P2P_SUPPORT_FLAG_TX_ANNOUNCE) {
+      m_workingContextGroup.spawn(std::bind(&NodeServer::txAnnounceLoop, this));
+    }
 
     m_stopEvent.wait();
 
@@ -646,6 +653,7 @@ namespace cn
     }
 
     context.version = rsp.node_data.version;
+    context.m_support_flags = rsp.node_data.support_flags & m_support_flags;
 
     if (rsp.node_data.network_id != m_network_id) {
       logger(logging::DEBUGGING) << context << "COMMAND_HANDSHAKE Failed, wrong network!  (" << rsp.node_data.network_id << "), closing connection.";
@@ -695,13 +703,13 @@ namespace cn
   bool NodeServer::timedSync() {
     COMMAND_TIMED_SYNC::request arg = boost::value_initialized<COMMAND_TIMED_SYNC::request>();
     m_payload_handler.get_payload_sync_data(arg.payload_data);
-    auto cmdBuf = LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg);
+    auto packet = LevinProtocol::makeMessage(COMMAND_TIMED_SYNC::ID, LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg), true);
 
-    forEachConnection([&cmdBuf](P2pConnectionContext& conn) {
+    forEachConnection([&packet](P2pConnectionContext& conn) {
       if (conn.peerId &&
           (conn.m_state == CryptoNoteConnectionContext::state_normal ||
            conn.m_state == CryptoNoteConnectionContext::state_idle)) {
-        conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf));
+        conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, packet));
       }
     });
 
@@ -1111,6 +1119,7 @@ namespace cn
     else
       node_data.my_port = 0;
     node_data.network_id = m_network_id;
+    node_data.support_flags = m_support_flags;
     return true;
   }
   //-----------------------------------------------------------------------------------
@@ -1197,13 +1206,18 @@ namespace cn
   //-----------------------------------------------------------------------------------
 
   void NodeServer::relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) {
+    relayNotifyToAll(command, LevinProtocol::makeMessage(command, data_buff, false), excludeConnection);
+  }
+
+  //-----------------------------------------------------------------------------------
+  void NodeServer::relayNotifyToAll(int command, const std::shared_ptr<const LevinProtocol::Packet>& packet, const net_connection_id* excludeConnection) {
     net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
 
-    forEachConnection([&excludeId, &command, &data_buff](P2pConnectionContext& conn) {
+    forEachConnection([&excludeId, &command, &packet](P2pConnectionContext& conn) {
       if (conn.peerId && conn.m_connection_id != excludeId &&
           (conn.m_state == CryptoNoteConnectionContext::state_normal ||
            conn.m_state == CryptoNoteConnectionContext::state_synchronizing)) {
-        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, packet));
       }
     });
   }
@@ -1286,6 +1300,7 @@ namespace cn
   int NodeServer::handle_handshake(int command, const COMMAND_HANDSHAKE::request& arg, COMMAND_HANDSHAKE::response& rsp, P2pConnectionContext& context)
   {
     context.version = arg.node_data.version;
+    context.m_support_flags = arg.node_data.support_flags & m_support_flags;
 
     if (arg.node_data.network_id != m_network_id) {
       logger(logging::INFO) << context << "WRONG NETWORK AGENT CONNECTED! id=" << arg.node_data.network_id;
@@ -1532,6 +1547,19 @@ namespace cn
     logger(DEBUGGING) << "NodeServer::timedSyncLoop() finished";
   }
 
+  void NodeServer::txAnnounceLoop() {
+    try {
+      for (;;) {
+        m_txAnnounceTimer.sleep(std::chrono::milliseconds(P2P_TX_ANNOUNCE_INTERVAL));
+        m_payload_handler.announceTransactions();
+      }
+    } catch (const platform_system::InterruptedException&) {
+      logger(DEBUGGING) << "NodeServer::txAnnounceLoop() is interrupted";
+    } catch (const std::exception& e) {
+      logger(DEBUGGING) << "Exception in NodeServer::txAnnounceLoop(): " << e.what();
+    }
+  }
+
   void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx) {
     // This inner context is necessary in order to stop connection handler at any moment
     platform_system::Context<> context(m_dispatcher, [this, &connectionId, &ctx] {
@@ -1567,7 +1595,7 @@ namespace cn
               response.clear();
             }
 
-            ctx.pushMessage(P2pMessage(P2pMessage::REPLY, cmd.command, response, retcode));
+            ctx.pushMessage(P2pMessage(P2pMessage::REPLY, cmd.command, std::move(response), retcode));
           }
 
           if (ctx.m_state == CryptoNoteConnectionContext::state_shutdown) {
@@ -1611,19 +1639,7 @@ namespace cn
 
         for (const auto& msg : msgs) {
           logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
-          switch (msg.type) {
-          case P2pMessage::COMMAND:
-            proto.sendMessage(msg.command, msg.buffer, true);
-            break;
-          case P2pMessage::NOTIFY:
-            proto.sendMessage(msg.command, msg.buffer, false);
-            break;
-          case P2pMessage::REPLY:
-            proto.sendReply(msg.command, msg.buffer, msg.returnCode);
-            break;
-          default:
-            assert(false);
-          }
+          proto.sendPacket(*msg.packet);
         }
       }
     } catch (const platform_system::InterruptedException&) {
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -53,18 +54,24 @@ namespace cn
       NOTIFY
     };
 
-    P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0) :
-      type(type), command(command), buffer(buffer), returnCode(returnCode) {
+    P2pMessage(Type type, uint32_t command, BinaryArray buffer, int32_t returnCode = 0) :
+      type(type), command(command),
+      packet(type == REPLY ? LevinProtocol::makeReply(command, std::move(buffer), returnCode) :
+                             LevinProtocol::makeMessage(command, std::move(buffer), type == COMMAND)) {
+    }
+
+    // relayed messages share one immutable packet, header included, between all the connections they are queued on
+    P2pMessage(Type type, uint32_t command, std::shared_ptr<const LevinProtocol::Packet> packet) :
+      type(type), command(command), packet(std::move(packet)) {
     }
 
     size_t size() const {
-      return buffer.size();
+      return packet->body.size();
     }
 
     Type type;
     uint32_t command;
-    const BinaryArray buffer;
-    int32_t returnCode;
+    std::shared_ptr<const LevinProtocol::Packet> packet;
   };
 
   struct P2pConnectionContext : public CryptoNoteConnectionContext {
@@ -158,6 +165,7 @@ namespace cn
 
     //----------------- i_p2p_endpoint -------------------------------------------------------------
     void relay_notify_to_all(int command, const BinaryArray &data_buff, const net_connection_id *excludeConnection) override;
+    void relayNotifyToAll(int command, const std::shared_ptr<const LevinProtocol::Packet> &packet, const net_connection_id *excludeConnection);
     bool invoke_notify_to_peer(int command, const BinaryArray &req_buff, const CryptoNoteConnectionContext &context) override;
     void drop_connection(CryptoNoteConnectionContext &context, bool add_fail) override;
     void for_each_connection(const std::function<void(cn::CryptoNoteConnectionContext &, PeerIdType)> &f) override;
@@ -202,6 +210,7 @@ namespace cn
     void writeHandler(P2pConnectionContext& ctx) const;
     void onIdle();
     void timedSyncLoop();
+    void txAnnounceLoop();
     void timeoutLoop();
 
     template<typename T>
@@ -228,6 +237,7 @@ namespace cn
     uint32_t m_ip_address;
     bool m_allow_local_ip = false;
     bool m_hide_my_port = false;
+    uint32_t m_support_flags = 0;
     std::string m_p2p_state_filename;
 
     platform_system::Dispatcher& m_dispatcher;
@@ -245,6 +255,7 @@ namespace cn
     OnceInInterval m_connections_maker_interval = OnceInInterval(1);
     OnceInInterval m_peerlist_store_interval = OnceInInterval(60 * 30, false);
     platform_system::Timer m_timedSyncTimer;
+    platform_system::Timer m_txAnnounceTimer;
 
     std::string m_bind_ip;
     std::string m_port;
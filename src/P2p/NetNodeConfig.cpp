@@ -28,6 +28,7 @@ const command_line::arg_descriptor<std::vector<std::string> > arg_p2p_add_exclus
       " If this option is given the options add-priority-node and seed-node are ignored"};
 const command_line::arg_descriptor<std::vector<std::string> > arg_p2p_seed_node   = {"seed-node", "Connect to a node to retrieve peer addresses, and disconnect"};
 const command_line::arg_descriptor<bool> arg_p2p_hide_my_port   =    {"hide-my-port", "Do not announce yourself as peerlist candidate", false, true};
+const command_line::arg_descriptor<bool> arg_p2p_tx_announce    =    {"p2p-tx-announce", "Announce transaction hashes to peers that support it instead of relaying whole transactions", false};
 
 bool parsePeerFromString(NetworkAddress& pe, const std::string& node_addr) {
   return common::parseIpAddressAndPort(pe.ip, pe.port, node_addr);
@@ -61,6 +62,7 @@ void NetNodeConfig::initOptions(boost::program_options::options_description& des
   command_line::add_arg(desc, arg_p2p_add_exclusive_node);
   command_line::add_arg(desc, arg_p2p_seed_node);
   command_line::add_arg(desc, arg_p2p_hide_my_port);
+  command_line::add_arg(desc, arg_p2p_tx_announce);
 }
 
 NetNodeConfig::NetNodeConfig() {
@@ -69,6 +71,7 @@ NetNodeConfig::NetNodeConfig() {
   externalPort = 0;
   allowLocalIp = false;
   hideMyPort = false;
+  txAnnounce = false;
   configFolder = tools::getDefaultDataDirectory();
   testnet = false;
 }
@@ -132,6 +135,10 @@ bool NetNodeConfig::init(const boost::program_options::variables_map& vm)
     hideMyPort = true;
   }
 
+  if (command_line::has_arg(vm, arg_p2p_tx_announce)) {
+    txAnnounce = true;
+  }
+
   return true;
 }
 
@@ -183,6 +190,10 @@ bool NetNodeConfig::getHideMyPort() const {
   return hideMyPort;
 }
 
+bool NetNodeConfig::getTxAnnounce() const {
+  return txAnnounce;
+}
+
 std::string NetNodeConfig::getConfigFolder() const {
   return configFolder;
 }
@@ -227,6 +238,10 @@ void NetNodeConfig::setHideMyPort(bool hide) {
   hideMyPort = hide;
 }
 
+void NetNodeConfig::setTxAnnounce(bool announce) {
+  txAnnounce = announce;
+}
+
 void NetNodeConfig::setConfigFolder(const std::string& folder) {
   configFolder = folder;
 }
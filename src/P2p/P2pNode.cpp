@@ -454,6 +454,7 @@ basic_node_data P2pNode::getNodeData() const {
   nodeData.version = cn::P2P_CURRENT_VERSION;
   nodeData.local_time = time(nullptr);
   nodeData.peer_id = m_myPeerId;
+  nodeData.support_flags = 0;
 
   if (m_cfg.getHideMyPort()) {
     nodeData.my_port = 0;
@@ -51,16 +51,19 @@ namespace cn
     uint64_t local_time;
     uint32_t my_port;
     PeerIdType peer_id;
+    uint32_t support_flags;
 
     void serialize(ISerializer& s) {
       KV_MEMBER(network_id)
       if (s.type() == ISerializer::INPUT) {
         version = 0;
+        support_flags = 0;
       }
       KV_MEMBER(version)
       KV_MEMBER(peer_id)
       KV_MEMBER(local_time)
       KV_MEMBER(my_port)
+      KV_MEMBER(support_flags)
     }
   };
   
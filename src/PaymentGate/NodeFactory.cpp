@@ -38,6 +38,7 @@ public:
     callback(std::error_code());
   }
   void getTransactionOutsGlobalIndices(const crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override { }
+  void getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override { }
 
   void queryBlocks(std::vector<crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<cn::BlockShortEntry>& newBlocks,
     uint32_t& startHeight, const Callback& callback) override {
@@ -19,23 +19,26 @@
 
 #include <System/ErrorMessage.h>
 #include <cassert>
+#include <cstdlib>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdexcept>
 #include <string.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <sys/timerfd.h>
-#include <ucontext.h>
 #include <unistd.h>
 #include <pthread.h>
 
+#include "IoUring.h"
+
 namespace platform_system {
 
 namespace {
 
 struct ContextMakingData {
   Dispatcher* dispatcher;
-  void* ucontext;
+  MachineContext* machineContext;
 };
 
 class MutextGuard {
@@ -57,9 +60,16 @@ private:
 
 static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "invalid pthread mutex size");
 
-//const size_t STACK_SIZE = 64 * 1024;
+// reserved address space, only the touched pages are committed
 const size_t STACK_SIZE = 512 * 1024;
 
+#ifdef PLATFORM_SYSTEM_IO_URING
+bool ioUringRequested() {
+  const char* backend = getenv("CONCEAL_DISPATCHER");
+  return backend != nullptr && strcmp(backend, "io_uring") == 0;
+}
+#endif
+
 };
 
 Dispatcher::Dispatcher() {
@@ -68,10 +78,13 @@ Dispatcher::Dispatcher() {
   if (epoll == -1) {
     message = "epoll_create1 failed, " + lastErrorMessage();
   } else {
-    mainContext.ucontext = new ucontext_t;
-    if (getcontext(reinterpret_cast<ucontext_t*>(mainContext.ucontext)) == -1) {
-      message = "getcontext failed, " + lastErrorMessage();
-    } else {
+    try {
+      initMachineContext(mainContext.machineContext);
+    } catch (std::exception& e) {
+      message = e.what();
+    }
+
+    if (message.empty()) {
       remoteSpawnEvent = eventfd(0, O_NONBLOCK);
       if(remoteSpawnEvent == -1) {
         message = "eventfd failed, " + lastErrorMessage();
@@ -100,12 +113,27 @@ Dispatcher::Dispatcher() {
           firstResumingContext = nullptr;
           firstReusableContext = nullptr;
           runningContextCount = 0;
+          ring = nullptr;
+#ifdef PLATFORM_SYSTEM_IO_URING
+          if (ioUringRequested()) {
+            try {
+              ring = new IoUring;
+              armRemoteSpawnEvent();
+            } catch (std::exception&) {
+              // kernels without io_uring keep the epoll backend
+              delete ring;
+              ring = nullptr;
+            }
+          }
+#endif
           return;
         }
 
         auto result = close(remoteSpawnEvent);
         assert(result == 0);
       }
+
+      destroyMachineContext(mainContext.machineContext);
     }
 
     auto result = close(epoll);
@@ -126,11 +154,10 @@ Dispatcher::~Dispatcher() {
   assert(firstResumingContext == nullptr);
   assert(runningContextCount == 0);
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto stackPtr = firstReusableContext->stackPtr;
+    destroyMachineContext(firstReusableContext->machineContext);
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    freeStack(stackPtr, STACK_SIZE);
   }
 
   while (!timers.empty()) {
@@ -139,21 +166,24 @@ Dispatcher::~Dispatcher() {
     timers.pop();
   }
 
+#ifdef PLATFORM_SYSTEM_IO_URING
+  delete ring;
+#endif
   auto result = close(epoll);
   assert(result == 0);
   result = close(remoteSpawnEvent);
   assert(result == 0);
   result = pthread_mutex_destroy(reinterpret_cast<pthread_mutex_t*>(this->mutex));
   assert(result == 0);
+  destroyMachineContext(mainContext.machineContext);
 }
 
 void Dispatcher::clear() {
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto stackPtr = firstReusableContext->stackPtr;
+    destroyMachineContext(firstReusableContext->machineContext);
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    freeStack(stackPtr, STACK_SIZE);
   }
 
   while (!timers.empty()) {
@@ -175,23 +205,22 @@ void Dispatcher::dispatch() {
       break;
     }
 
+#ifdef PLATFORM_SYSTEM_IO_URING
+    if (ring != nullptr) {
+      if (!reapCompletions()) {
+        ring->wait();
+      }
+
+      continue;
+    }
+#endif
+
     epoll_event event;
     int count = epoll_wait(epoll, &event, 1, -1);
     if (count == 1) {
       ContextPair *contextPair = static_cast<ContextPair*>(event.data.ptr);
       if(((event.events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-        uint64_t buf;
-        auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-        if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-        }
-
-        MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-        while (!remoteSpawningProcedures.empty()) {
-          spawn(std::move(remoteSpawningProcedures.front()));
-          remoteSpawningProcedures.pop();
-        }
-
+        spawnRemoteProcedures();
         continue;
       }
 
@@ -215,11 +244,9 @@ void Dispatcher::dispatch() {
   }
 
   if (context != currentContext) {
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    NativeContext* oldContext = currentContext;
     currentContext = context;
-    if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1) {
-      throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
-    }
+    switchMachineContext(oldContext->machineContext, context->machineContext);
   }
 }
 
@@ -298,7 +325,14 @@ void Dispatcher::spawn(std::function<void()>&& procedure) {
 }
 
 void Dispatcher::yield() {
-  for(;;){
+#ifdef PLATFORM_SYSTEM_IO_URING
+  if (ring != nullptr) {
+    ring->submit();
+    reapCompletions();
+  }
+#endif
+
+  while (ring == nullptr) {
     epoll_event events[16];
     int count = epoll_wait(epoll, events, 16, 0);
     if (count == 0) {
@@ -309,18 +343,7 @@ void Dispatcher::yield() {
       for(int i = 0; i < count; ++i) {
         ContextPair *contextPair = static_cast<ContextPair*>(events[i].data.ptr);
         if(((events[i].events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-          uint64_t buf;
-          auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-          if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-          }
-
-          MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-          while (!remoteSpawningProcedures.empty()) {
-            spawn(std::move(remoteSpawningProcedures.front()));
-            remoteSpawningProcedures.pop();
-          }
-
+          spawnRemoteProcedures();
           continue;
         }
 
@@ -365,25 +388,20 @@ int Dispatcher::getEpoll() const {
 
 NativeContext& Dispatcher::getReusableContext() {
   if(firstReusableContext == nullptr) {
-    ucontext_t* newlyCreatedContext = new ucontext_t;
-    if (getcontext(newlyCreatedContext) == -1) { //makecontext precondition
-      throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
+    auto stackPointer = allocateStack(STACK_SIZE);
+    MachineContext newlyCreatedContext;
+    ContextMakingData makingContextData {this, &newlyCreatedContext};
+    try {
+      makeMachineContext(newlyCreatedContext, stackPointer, STACK_SIZE, contextProcedureStatic, &makingContextData);
+    } catch (std::exception&) {
+      freeStack(stackPointer, STACK_SIZE);
+      throw;
     }
 
-    auto stackPointer = new uint8_t[STACK_SIZE];
-    newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-    newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
-
-    ContextMakingData makingContextData {this, newlyCreatedContext};
-    makecontext(newlyCreatedContext, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
-
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
-    if (swapcontext(oldContext, newlyCreatedContext) == -1) {
-      throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
-    }
+    // the new context takes over the machine context and switches back as soon as it is set up
+    switchMachineContext(currentContext->machineContext, newlyCreatedContext);
 
     assert(firstReusableContext != nullptr);
-    assert(firstReusableContext->ucontext == newlyCreatedContext);
     firstReusableContext->stackPtr = stackPointer;
   };
 
@@ -421,17 +439,98 @@ void Dispatcher::pushTimer(int timer) {
   timers.push(timer);
 }
 
-void Dispatcher::contextProcedure(void* ucontext) {
+IoUring* Dispatcher::getIoUring() const {
+  return ring;
+}
+
+#ifdef PLATFORM_SYSTEM_IO_URING
+int32_t Dispatcher::submitOperation(io_uring_sqe& request, bool& interrupted) {
+  assert(ring != nullptr);
+  OperationContext operationContext;
+  operationContext.context = currentContext;
+  operationContext.interrupted = false;
+  request.user_data = reinterpret_cast<uintptr_t>(&operationContext);
+  ring->push(request);
+
+  bool timeout = request.opcode == IORING_OP_TIMEOUT;
+  currentContext->interruptProcedure = [this, &operationContext, timeout] {
+    // the buffers of the request stay in use until its completion, so the context waits for it
+    io_uring_sqe cancel = {};
+    cancel.opcode = timeout ? IORING_OP_TIMEOUT_REMOVE : IORING_OP_ASYNC_CANCEL;
+    cancel.fd = -1;
+    cancel.addr = reinterpret_cast<uintptr_t>(&operationContext);
+    ring->push(cancel);
+    operationContext.interrupted = true;
+  };
+
+  if (timeout) {
+    // a timeout runs from its submission, queuing it until the next wait would stretch the sleep
+    ring->submit();
+  }
+
+  dispatch();
+  currentContext->interruptProcedure = nullptr;
+  assert(operationContext.context == currentContext);
+  interrupted = operationContext.interrupted;
+  return operationContext.result;
+}
+#endif
+
+void Dispatcher::armRemoteSpawnEvent() {
+#ifdef PLATFORM_SYSTEM_IO_URING
+  io_uring_sqe request = {};
+  request.opcode = IORING_OP_POLL_ADD;
+  request.fd = remoteSpawnEvent;
+  request.poll_events = POLLIN;
+  request.user_data = reinterpret_cast<uintptr_t>(&remoteSpawnEventContext);
+  ring->push(request);
+#endif
+}
+
+void Dispatcher::spawnRemoteProcedures() {
+  uint64_t buf;
+  auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
+  if(transferred == -1) {
+    throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
+  }
+
+  MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
+  while (!remoteSpawningProcedures.empty()) {
+    spawn(std::move(remoteSpawningProcedures.front()));
+    remoteSpawningProcedures.pop();
+  }
+}
+
+bool Dispatcher::reapCompletions() {
+  bool reaped = false;
+#ifdef PLATFORM_SYSTEM_IO_URING
+  io_uring_cqe completion;
+  while (ring->peek(completion)) {
+    reaped = true;
+    if (completion.user_data == reinterpret_cast<uintptr_t>(&remoteSpawnEventContext)) {
+      spawnRemoteProcedures();
+      armRemoteSpawnEvent();
+    } else if (completion.user_data != 0) {
+      // cancel requests carry no user data
+      OperationContext* operationContext = reinterpret_cast<OperationContext*>(completion.user_data);
+      operationContext->result = completion.res;
+      operationContext->context->interruptProcedure = nullptr;
+      pushContext(operationContext->context);
+    }
+  }
+#endif
+
+  return reaped;
+}
+
+void Dispatcher::contextProcedure(MachineContext* machineContext) {
   assert(firstReusableContext == nullptr);
   NativeContext context;
-  context.ucontext = ucontext;
+  context.machineContext = *machineContext;
   context.interrupted = false;
   context.next = nullptr;
   firstReusableContext = &context;
-  ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
-    throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
-  }
+  switchMachineContext(context.machineContext, currentContext->machineContext);
 
   for (;;) {
     ++runningContextCount;
@@ -482,7 +581,7 @@ void Dispatcher::contextProcedure(void* ucontext) {
 
 void Dispatcher::contextProcedureStatic(void *context) {
   ContextMakingData* makingContextData = reinterpret_cast<ContextMakingData*>(context);
-  makingContextData->dispatcher->contextProcedure(makingContextData->ucontext);
+  makingContextData->dispatcher->contextProcedure(makingContextData->machineContext);
 }
 
 }
@@ -26,12 +26,18 @@
 #include <bits/reg.h>
 #endif
 
+#include "MachineContext.h"
+
+struct io_uring_sqe;
+
 namespace platform_system {
 
+class IoUring;
+
 struct NativeContextGroup;
 
 struct NativeContext {
-  void* ucontext;
+  MachineContext machineContext;
   void* stackPtr;
   bool interrupted;
   bool inExecutionQueue;
@@ -54,6 +60,7 @@ struct OperationContext {
   NativeContext *context;
   bool interrupted;
   uint32_t events;
+  int32_t result;
 };
 
 struct ContextPair {
@@ -83,6 +90,12 @@ public:
   void pushReusableContext(NativeContext&);
   int getTimer();
   void pushTimer(int timer);
+  // io_uring backend, selected by CONCEAL_DISPATCHER=io_uring (set by the --dispatcher option of the daemon),
+  // nullptr when the dispatcher runs on epoll
+  IoUring* getIoUring() const;
+  // Queues the request, parks the current context until its completion and returns the result. An interrupt
+  // cancels the request and sets interrupted, the context is resumed by the completion either way.
+  int32_t submitOperation(io_uring_sqe& request, bool& interrupted);
 
 #ifdef __x86_64__
 #if __WORDSIZE == 64
@@ -101,6 +114,7 @@ public:
 private:
   void spawn(std::function<void()>&& procedure);
   int epoll;
+  IoUring* ring;
   alignas(void*) uint8_t mutex[SIZEOF_PTHREAD_MUTEX_T];
   int remoteSpawnEvent;
   ContextPair remoteSpawnEventContext;
@@ -115,7 +129,10 @@ private:
   NativeContext* firstReusableContext;
   size_t runningContextCount;
 
-  void contextProcedure(void* ucontext);
+  void armRemoteSpawnEvent();
+  void spawnRemoteProcedures();
+  bool reapCompletions();
+  void contextProcedure(MachineContext* machineContext);
   static void contextProcedureStatic(void* context);
 };
 
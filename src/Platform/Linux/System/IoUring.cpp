@@ -0,0 +1,182 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "IoUring.h"
+
+#ifdef PLATFORM_SYSTEM_IO_URING
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <stdexcept>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <System/ErrorMessage.h>
+
+namespace platform_system {
+
+namespace {
+
+const unsigned SUBMISSION_ENTRIES = 256;
+// every parked context holds at most one request, the completion ring is sized for the connection limits of the node
+const unsigned COMPLETION_ENTRIES = 8192;
+
+const uint8_t REQUIRED_OPERATIONS[] = {
+  IORING_OP_RECV,
+  IORING_OP_SENDMSG,
+  IORING_OP_ACCEPT,
+  IORING_OP_CONNECT,
+  IORING_OP_TIMEOUT,
+  IORING_OP_TIMEOUT_REMOVE,
+  IORING_OP_ASYNC_CANCEL,
+  IORING_OP_POLL_ADD
+};
+
+template<typename T> T* ringField(void* rings, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<uint8_t*>(rings) + offset);
+}
+
+bool supportsRequiredOperations(int ring) {
+  std::vector<uint8_t> buffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+  io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+  if (syscall(__NR_io_uring_register, ring, IORING_REGISTER_PROBE, probe, 256) == -1) {
+    return false;
+  }
+
+  return std::all_of(std::begin(REQUIRED_OPERATIONS), std::end(REQUIRED_OPERATIONS), [probe](uint8_t operation) {
+    return operation <= probe->last_op && (probe->ops[operation].flags & IO_URING_OP_SUPPORTED) != 0;
+  });
+}
+
+}
+
+IoUring::IoUring() : pending(0) {
+  io_uring_params params = {};
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = COMPLETION_ENTRIES;
+  ring = static_cast<int>(syscall(__NR_io_uring_setup, SUBMISSION_ENTRIES, &params));
+  if (ring == -1) {
+    throw std::runtime_error("IoUring::IoUring, io_uring_setup failed, " + lastErrorMessage());
+  }
+
+  std::string message;
+  const uint32_t requiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL;
+  if ((params.features & requiredFeatures) != requiredFeatures || !supportsRequiredOperations(ring)) {
+    message = "kernel lacks required features";
+  } else {
+    ringsSize = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned), params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    rings = mmap(nullptr, ringsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED) {
+      message = "mmap failed, " + lastErrorMessage();
+    } else {
+      requestsSize = params.sq_entries * sizeof(io_uring_sqe);
+      void* mappedRequests = mmap(nullptr, requestsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+      if (mappedRequests == MAP_FAILED) {
+        message = "mmap failed, " + lastErrorMessage();
+      } else {
+        requests = static_cast<io_uring_sqe*>(mappedRequests);
+        submissionHead = ringField<unsigned>(rings, params.sq_off.head);
+        submissionTail = ringField<unsigned>(rings, params.sq_off.tail);
+        submissionFlags = ringField<unsigned>(rings, params.sq_off.flags);
+        submissionMask = *ringField<unsigned>(rings, params.sq_off.ring_mask);
+        submissionEntries = params.sq_entries;
+        completionHead = ringField<unsigned>(rings, params.cq_off.head);
+        completionTail = ringField<unsigned>(rings, params.cq_off.tail);
+        completionMask = *ringField<unsigned>(rings, params.cq_off.ring_mask);
+        completions = ringField<io_uring_cqe>(rings, params.cq_off.cqes);
+
+        // slot i of the submission ring always refers to request i, push fills the requests in ring order
+        unsigned* array = ringField<unsigned>(rings, params.sq_off.array);
+        for (unsigned i = 0; i < submissionEntries; ++i) {
+          array[i] = i;
+        }
+
+        return;
+      }
+
+      int result = munmap(rings, ringsSize);
+      assert(result == 0);
+    }
+  }
+
+  int result = close(ring);
+  assert(result == 0);
+  throw std::runtime_error("IoUring::IoUring, " + message);
+}
+
+IoUring::~IoUring() {
+  int result = munmap(requests, requestsSize);
+  assert(result == 0);
+  result = munmap(rings, ringsSize);
+  assert(result == 0);
+  result = close(ring);
+  assert(result == 0);
+}
+
+void IoUring::push(const io_uring_sqe& request) {
+  unsigned tail = *submissionTail;
+  if (tail - __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE) == submissionEntries) {
+    if (enter(0, 0) == -1) {
+      throw std::runtime_error("IoUring::push, io_uring_enter failed, " + lastErrorMessage());
+    }
+
+    if (tail - __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE) == submissionEntries) {
+      throw std::runtime_error("IoUring::push, submission ring is full");
+    }
+  }
+
+  requests[tail & submissionMask] = request;
+  __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+  ++pending;
+}
+
+void IoUring::submit() {
+  // nothing to hand over, completions already posted are read by peek without a system call
+  if (pending == 0 && (__atomic_load_n(submissionFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) == 0) {
+    return;
+  }
+
+  if (enter(0, IORING_ENTER_GETEVENTS) == -1 && errno != EINTR && errno != EBUSY) {
+    throw std::runtime_error("IoUring::submit, io_uring_enter failed, " + lastErrorMessage());
+  }
+}
+
+void IoUring::wait() {
+  // EBUSY means the kernel holds completions that do not fit the ring, they are flushed once the ring is read
+  if (enter(1, IORING_ENTER_GETEVENTS) == -1 && errno != EINTR && errno != EBUSY) {
+    throw std::runtime_error("IoUring::wait, io_uring_enter failed, " + lastErrorMessage());
+  }
+}
+
+bool IoUring::peek(io_uring_cqe& completion) {
+  unsigned head = *completionHead;
+  if (head == __atomic_load_n(completionTail, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+
+  completion = completions[head & completionMask];
+  __atomic_store_n(completionHead, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+int IoUring::enter(unsigned minComplete, unsigned flags) {
+  if ((__atomic_load_n(submissionFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) != 0) {
+    flags |= IORING_ENTER_GETEVENTS;
+  }
+
+  int result = static_cast<int>(syscall(__NR_io_uring_enter, ring, pending, minComplete, flags, nullptr, 0));
+  if (result >= 0) {
+    pending -= static_cast<unsigned>(result);
+  }
+
+  return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The backend needs the opcodes and the internal polling of sockets added in Linux 5.7, older kernel
+// headers build the epoll backend only
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_FEAT_FAST_POLL)
+#define PLATFORM_SYSTEM_IO_URING
+#endif
+#endif
+#endif
+
+namespace platform_system {
+
+#ifdef PLATFORM_SYSTEM_IO_URING
+
+// Submission and completion rings shared with the kernel, set up with raw system calls. Requests are
+// queued by push and handed to the kernel in batches by submit or wait, so a blocking operation of a
+// context costs no system call of its own.
+class IoUring {
+public:
+  // Throws if the kernel lacks io_uring or one of the operations used by the dispatcher
+  IoUring();
+  IoUring(const IoUring&) = delete;
+  ~IoUring();
+  IoUring& operator=(const IoUring&) = delete;
+
+  // Queues the request, submits the queued ones first when the submission ring is full
+  void push(const io_uring_sqe& request);
+  // Submits the queued requests and runs the completions pending in the kernel without waiting, makes no
+  // system call when nothing is queued
+  void submit();
+  // Submits the queued requests and waits for at least one completion
+  void wait();
+  bool peek(io_uring_cqe& completion);
+
+private:
+  int ring;
+  void* rings;
+  size_t ringsSize;
+  io_uring_sqe* requests;
+  size_t requestsSize;
+  unsigned* submissionHead;
+  unsigned* submissionTail;
+  unsigned* submissionFlags;
+  unsigned submissionMask;
+  unsigned submissionEntries;
+  unsigned* completionHead;
+  unsigned* completionTail;
+  unsigned completionMask;
+  io_uring_cqe* completions;
+  unsigned pending;
+
+  int enter(unsigned minComplete, unsigned flags);
+};
+
+#else
+
+class IoUring;
+
+#endif
+
+}
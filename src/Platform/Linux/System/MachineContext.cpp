@@ -0,0 +1,227 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "MachineContext.h"
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <System/ErrorMessage.h>
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+#include <ucontext.h>
+#endif
+
+#if defined(__x86_64__)
+
+// Saves the callee saved registers, MXCSR and the x87 control word on the current stack, stores the stack
+// pointer to *from and restores the same frame from the stack at to
+asm(
+  ".text\n"
+  ".globl platform_system_switch_context\n"
+  ".hidden platform_system_switch_context\n"
+  ".type platform_system_switch_context, @function\n"
+  ".align 16\n"
+  "platform_system_switch_context:\n"
+  "  pushq %rbp\n"
+  "  pushq %rbx\n"
+  "  pushq %r12\n"
+  "  pushq %r13\n"
+  "  pushq %r14\n"
+  "  pushq %r15\n"
+  "  subq $16, %rsp\n"
+  "  stmxcsr (%rsp)\n"
+  "  fnstcw 4(%rsp)\n"
+  "  movq %rsp, (%rdi)\n"
+  "  movq %rsi, %rsp\n"
+  "  ldmxcsr (%rsp)\n"
+  "  fldcw 4(%rsp)\n"
+  "  addq $16, %rsp\n"
+  "  popq %r15\n"
+  "  popq %r14\n"
+  "  popq %r13\n"
+  "  popq %r12\n"
+  "  popq %rbx\n"
+  "  popq %rbp\n"
+  "  ret\n"
+  ".size platform_system_switch_context, .-platform_system_switch_context\n"
+
+  // first return of a new context, the frame built by makeMachineContext holds the argument in r12 and the procedure in r13
+  ".globl platform_system_start_context\n"
+  ".hidden platform_system_start_context\n"
+  ".type platform_system_start_context, @function\n"
+  ".align 16\n"
+  "platform_system_start_context:\n"
+  "  .cfi_startproc\n"
+  "  .cfi_undefined rip\n"
+  "  movq %r12, %rdi\n"
+  "  callq *%r13\n"
+  "  ud2\n"
+  "  .cfi_endproc\n"
+  ".size platform_system_start_context, .-platform_system_start_context\n"
+);
+
+#elif defined(__aarch64__)
+
+// Saves x19-x30 and d8-d15 on the current stack, stores the stack pointer to *from and restores the same frame
+// from the stack at to
+asm(
+  ".text\n"
+  ".globl platform_system_switch_context\n"
+  ".hidden platform_system_switch_context\n"
+  ".type platform_system_switch_context, %function\n"
+  ".align 4\n"
+  "platform_system_switch_context:\n"
+  "  sub sp, sp, #160\n"
+  "  stp x19, x20, [sp, #0]\n"
+  "  stp x21, x22, [sp, #16]\n"
+  "  stp x23, x24, [sp, #32]\n"
+  "  stp x25, x26, [sp, #48]\n"
+  "  stp x27, x28, [sp, #64]\n"
+  "  stp x29, x30, [sp, #80]\n"
+  "  stp d8, d9, [sp, #96]\n"
+  "  stp d10, d11, [sp, #112]\n"
+  "  stp d12, d13, [sp, #128]\n"
+  "  stp d14, d15, [sp, #144]\n"
+  "  mov x9, sp\n"
+  "  str x9, [x0]\n"
+  "  mov sp, x1\n"
+  "  ldp x19, x20, [sp, #0]\n"
+  "  ldp x21, x22, [sp, #16]\n"
+  "  ldp x23, x24, [sp, #32]\n"
+  "  ldp x25, x26, [sp, #48]\n"
+  "  ldp x27, x28, [sp, #64]\n"
+  "  ldp x29, x30, [sp, #80]\n"
+  "  ldp d8, d9, [sp, #96]\n"
+  "  ldp d10, d11, [sp, #112]\n"
+  "  ldp d12, d13, [sp, #128]\n"
+  "  ldp d14, d15, [sp, #144]\n"
+  "  add sp, sp, #160\n"
+  "  ret\n"
+  ".size platform_system_switch_context, .-platform_system_switch_context\n"
+
+  // first return of a new context, the frame built by makeMachineContext holds the argument in x19 and the procedure in x20
+  ".globl platform_system_start_context\n"
+  ".hidden platform_system_start_context\n"
+  ".type platform_system_start_context, %function\n"
+  ".align 4\n"
+  "platform_system_start_context:\n"
+  "  .cfi_startproc\n"
+  "  .cfi_undefined x30\n"
+  "  mov x0, x19\n"
+  "  blr x20\n"
+  "  brk #0\n"
+  "  .cfi_endproc\n"
+  ".size platform_system_start_context, .-platform_system_start_context\n"
+);
+
+#endif
+
+#if defined(__x86_64__) || defined(__aarch64__)
+extern "C" void platform_system_switch_context(void** from, void* to);
+extern "C" void platform_system_start_context();
+#endif
+
+namespace platform_system {
+
+void initMachineContext(MachineContext& context) {
+#if defined(__x86_64__) || defined(__aarch64__)
+  context.state = nullptr;
+#else
+  ucontext_t* ucontext = new ucontext_t;
+  if (getcontext(ucontext) == -1) {
+    delete ucontext;
+    throw std::runtime_error("initMachineContext, getcontext failed, " + lastErrorMessage());
+  }
+
+  context.state = ucontext;
+#endif
+}
+
+void makeMachineContext(MachineContext& context, void* stack, size_t stackSize, void (*procedure)(void*), void* argument) {
+  uintptr_t top = (reinterpret_cast<uintptr_t>(stack) + stackSize) & ~static_cast<uintptr_t>(15);
+#if defined(__x86_64__)
+  // MXCSR and x87 control word, r15, r14, r13, r12, rbx, rbp and the return address, the stack is 16 byte aligned after the return
+  uint64_t* frame = reinterpret_cast<uint64_t*>(top - 16 - 9 * sizeof(uint64_t));
+  frame[0] = 0x1f80 | (static_cast<uint64_t>(0x037f) << 32);
+  frame[1] = 0;
+  frame[2] = 0;
+  frame[3] = 0;
+  frame[4] = reinterpret_cast<uint64_t>(procedure);
+  frame[5] = reinterpret_cast<uint64_t>(argument);
+  frame[6] = 0;
+  frame[7] = 0;
+  frame[8] = reinterpret_cast<uint64_t>(&platform_system_start_context);
+  context.state = frame;
+#elif defined(__aarch64__)
+  // x19-x30 and d8-d15, the stack is back at its aligned top after the return
+  uint64_t* frame = reinterpret_cast<uint64_t*>(top - 20 * sizeof(uint64_t));
+  for (size_t i = 0; i < 20; ++i) {
+    frame[i] = 0;
+  }
+
+  frame[0] = reinterpret_cast<uint64_t>(argument);
+  frame[1] = reinterpret_cast<uint64_t>(procedure);
+  frame[11] = reinterpret_cast<uint64_t>(&platform_system_start_context);
+  context.state = frame;
+#else
+  ucontext_t* ucontext = new ucontext_t;
+  if (getcontext(ucontext) == -1) { //makecontext precondition
+    delete ucontext;
+    throw std::runtime_error("makeMachineContext, getcontext failed, " + lastErrorMessage());
+  }
+
+  ucontext->uc_stack.ss_sp = stack;
+  ucontext->uc_stack.ss_size = stackSize;
+  ucontext->uc_link = nullptr;
+  makecontext(ucontext, (void(*)())procedure, 1, argument);
+  context.state = ucontext;
+#endif
+}
+
+void destroyMachineContext(MachineContext& context) {
+#if !defined(__x86_64__) && !defined(__aarch64__)
+  delete static_cast<ucontext_t*>(context.state);
+#endif
+  context.state = nullptr;
+}
+
+void switchMachineContext(MachineContext& from, MachineContext& to) {
+#if defined(__x86_64__) || defined(__aarch64__)
+  platform_system_switch_context(&from.state, to.state);
+#else
+  if (swapcontext(static_cast<ucontext_t*>(from.state), static_cast<ucontext_t*>(to.state)) == -1) {
+    throw std::runtime_error("switchMachineContext, swapcontext failed, " + lastErrorMessage());
+  }
+#endif
+}
+
+void* allocateStack(size_t size) {
+  size_t guardSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  void* region = mmap(nullptr, guardSize + size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+  if (region == MAP_FAILED) {
+    throw std::runtime_error("allocateStack, mmap failed, " + lastErrorMessage());
+  }
+
+  // the stack grows down, an overflow hits the guard page instead of the neighbouring memory
+  if (mprotect(region, guardSize, PROT_NONE) == -1) {
+    std::string message = "allocateStack, mprotect failed, " + lastErrorMessage();
+    munmap(region, guardSize + size);
+    throw std::runtime_error(message);
+  }
+
+  return static_cast<uint8_t*>(region) + guardSize;
+}
+
+void freeStack(void* stack, size_t size) {
+  size_t guardSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto result = munmap(static_cast<uint8_t*>(stack) - guardSize, guardSize + size);
+  assert(result == 0);
+}
+
+}
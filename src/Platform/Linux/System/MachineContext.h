@@ -0,0 +1,30 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+
+namespace platform_system {
+
+// Execution state of a suspended context. On x86_64 and aarch64 it is the stack pointer of the context,
+// the callee saved registers are kept on its stack and a switch makes no system call. Other
+// architectures fall back to ucontext and keep a ucontext_t here.
+struct MachineContext {
+  void* state;
+};
+
+// Prepares the context of the calling thread, it is filled by the first switch away from it
+void initMachineContext(MachineContext& context);
+// The procedure must never return
+void makeMachineContext(MachineContext& context, void* stack, size_t stackSize, void (*procedure)(void*), void* argument);
+void destroyMachineContext(MachineContext& context);
+void switchMachineContext(MachineContext& from, MachineContext& to);
+
+// Reserves a stack of the given size below a guard page, pages are committed by the kernel on first touch
+void* allocateStack(size_t size);
+void freeStack(void* stack, size_t size);
+
+}
@@ -16,6 +16,7 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "TcpConnection.h"
+#include "IoUring.h"
 
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
@@ -24,10 +25,50 @@
 #include <cassert>
 #include <stdexcept>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace platform_system {
 
+namespace {
+
+ssize_t sendBuffers(int connection, const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size) {
+  iovec buffers[2];
+  buffers[0].iov_base = const_cast<uint8_t*>(header);
+  buffers[0].iov_len = headerSize;
+  buffers[1].iov_base = const_cast<uint8_t*>(data);
+  buffers[1].iov_len = size;
+
+  msghdr message = {};
+  message.msg_iov = buffers;
+  message.msg_iovlen = 2;
+  return ::sendmsg(connection, &message, MSG_NOSIGNAL);
+}
+
+#ifdef PLATFORM_SYSTEM_IO_URING
+size_t completeTransfer(Dispatcher& dispatcher, io_uring_sqe& request, const std::string& failure) {
+  bool interrupted;
+  int32_t result = dispatcher.submitOperation(request, interrupted);
+  if (result < 0) {
+    if (interrupted) {
+      throw InterruptedException();
+    }
+
+    throw std::runtime_error(failure + errorMessage(-result));
+  }
+
+  if (interrupted) {
+    // the transfer completed before the cancel, the next operation of the context reports the interrupt
+    dispatcher.interrupt();
+  }
+
+  return static_cast<size_t>(result);
+}
+#endif
+
+}
+
 TcpConnection::TcpConnection() : dispatcher(nullptr) {
 }
 
@@ -78,6 +119,17 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
     throw InterruptedException();
   }
 
+#ifdef PLATFORM_SYSTEM_IO_URING
+  if (dispatcher->getIoUring() != nullptr) {
+    io_uring_sqe request = {};
+    request.opcode = IORING_OP_RECV;
+    request.fd = connection;
+    request.addr = reinterpret_cast<uintptr_t>(data);
+    request.len = static_cast<uint32_t>(size);
+    return completeTransfer(*dispatcher, request, "TcpConnection::read, recv failed, ");
+  }
+#endif
+
   std::string message;
   ssize_t transferred = ::recv(connection, (void *)data, size, 0);
   if (transferred == -1) {
@@ -166,7 +218,6 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw InterruptedException();
   }
 
-  std::string message;
   if(size == 0) {
     if(shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
@@ -175,7 +226,40 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void *)data, size, MSG_NOSIGNAL);
+  return write(nullptr, 0, data, size);
+}
+
+std::size_t TcpConnection::write(const uint8_t* header, std::size_t headerSize, const uint8_t* data, std::size_t size) {
+  assert(dispatcher != nullptr);
+  assert(contextPair.writeContext == nullptr);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+#ifdef PLATFORM_SYSTEM_IO_URING
+  if (dispatcher->getIoUring() != nullptr) {
+    iovec buffers[2];
+    buffers[0].iov_base = const_cast<uint8_t*>(header);
+    buffers[0].iov_len = headerSize;
+    buffers[1].iov_base = const_cast<uint8_t*>(data);
+    buffers[1].iov_len = size;
+
+    msghdr message = {};
+    message.msg_iov = buffers;
+    message.msg_iovlen = 2;
+
+    io_uring_sqe request = {};
+    request.opcode = IORING_OP_SENDMSG;
+    request.fd = connection;
+    request.addr = reinterpret_cast<uintptr_t>(&message);
+    request.len = 1;
+    request.msg_flags = MSG_NOSIGNAL;
+    return completeTransfer(*dispatcher, request, "TcpConnection::write, send failed, ");
+  }
+#endif
+
+  std::string message;
+  ssize_t transferred = sendBuffers(connection, header, headerSize, data, size);
   if (transferred == -1) {
     if (errno != EAGAIN) {
       message = "send failed, " + lastErrorMessage();
@@ -238,11 +322,11 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
           throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, 0);
+        ssize_t transferred = sendBuffers(connection, header, headerSize, data, size);
         if (transferred == -1) {
           message = "send failed, "  + lastErrorMessage();
         } else {
-          assert(transferred <= static_cast<ssize_t>(size));
+          assert(transferred <= static_cast<ssize_t>(headerSize + size));
           return transferred;
         }
       }
@@ -251,7 +335,7 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw std::runtime_error("TcpConnection::write, " + message);
   }
 
-  assert(transferred <= static_cast<ssize_t>(size));
+  assert(transferred <= static_cast<ssize_t>(headerSize + size));
   return transferred;
 }
 
@@ -269,6 +353,10 @@ std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
 TcpConnection::TcpConnection(Dispatcher& dispatcher, int socket) : dispatcher(&dispatcher), connection(socket) {
   contextPair.readContext = nullptr;
   contextPair.writeContext = nullptr;
+  if (dispatcher.getIoUring() != nullptr) {
+    return;
+  }
+
   epoll_event connectionEvent;
   connectionEvent.events = EPOLLONESHOT;
   connectionEvent.data.ptr = nullptr;
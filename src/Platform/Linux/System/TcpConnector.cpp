@@ -18,6 +18,7 @@
 #include <System/Ipv4Address.h>
 #include "Dispatcher.h"
 #include "ErrorMessage.h"
+#include "IoUring.h"
 #include "TcpConnection.h"
 
 namespace platform_system {
@@ -85,6 +86,32 @@ TcpConnection TcpConnector::connect(const Ipv4Address& address, uint16_t port) {
         addressData.sin_family = AF_INET;
         addressData.sin_port = htons(port);
         addressData.sin_addr.s_addr = htonl(address.getValue());
+#ifdef PLATFORM_SYSTEM_IO_URING
+        if (dispatcher->getIoUring() != nullptr) {
+          io_uring_sqe request = {};
+          request.opcode = IORING_OP_CONNECT;
+          request.fd = connection;
+          request.addr = reinterpret_cast<uintptr_t>(&addressData);
+          request.off = sizeof addressData;
+
+          bool interrupted;
+          context = &request;
+          int32_t result = dispatcher->submitOperation(request, interrupted);
+          context = nullptr;
+          if (result == 0 && !interrupted) {
+            return TcpConnection(*dispatcher, connection);
+          }
+
+          int closeResult = close(connection);
+          assert(closeResult != -1);
+          if (interrupted) {
+            throw InterruptedException();
+          }
+
+          throw std::runtime_error("TcpConnector::connect, connect failed, " + errorMessage(-result));
+        }
+#endif
+
         int result = ::connect(connection, reinterpret_cast<sockaddr *>(&addressData), sizeof addressData);
         if (result == -1) {
           if (errno == EINPROGRESS) {
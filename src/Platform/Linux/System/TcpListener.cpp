@@ -16,6 +16,7 @@
 #include <string.h>
 
 #include "Dispatcher.h"
+#include "IoUring.h"
 #include "TcpConnection.h"
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
@@ -48,6 +49,9 @@ TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& addr, uint16
           message = "bind failed, " + lastErrorMessage();
         } else if (listen(listener, SOMAXCONN) != 0) {
           message = "listen failed, " + lastErrorMessage();
+        } else if (dispatcher.getIoUring() != nullptr) {
+          context = nullptr;
+          return;
         } else {
           epoll_event listenEvent;
           listenEvent.events = 0;
@@ -113,6 +117,33 @@ TcpConnection TcpListener::accept() {
     throw InterruptedException();
   }
 
+#ifdef PLATFORM_SYSTEM_IO_URING
+  if (dispatcher->getIoUring() != nullptr) {
+    io_uring_sqe request = {};
+    request.opcode = IORING_OP_ACCEPT;
+    request.fd = listener;
+    request.accept_flags = SOCK_NONBLOCK;
+
+    bool interrupted;
+    context = &request;
+    int32_t connection = dispatcher->submitOperation(request, interrupted);
+    context = nullptr;
+    if (connection < 0) {
+      if (interrupted) {
+        throw InterruptedException();
+      }
+
+      throw std::runtime_error("TcpListener::accept, accept failed, " + errorMessage(-connection));
+    }
+
+    if (interrupted) {
+      dispatcher->interrupt();
+    }
+
+    return TcpConnection(*dispatcher, connection);
+  }
+#endif
+
   ContextPair contextPair;
   OperationContext listenerContext;
   listenerContext.interrupted = false;
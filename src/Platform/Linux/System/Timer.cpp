@@ -17,6 +17,7 @@
 
 #include "Timer.h"
 #include <cassert>
+#include <cerrno>
 #include <stdexcept>
 
 #include <sys/timerfd.h>
@@ -24,6 +25,7 @@
 #include <unistd.h>
 
 #include "Dispatcher.h"
+#include "IoUring.h"
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
 
@@ -71,6 +73,34 @@ void Timer::sleep(std::chrono::nanoseconds duration) {
 
   if(duration.count() == 0 ) {
     dispatcher->yield();
+#ifdef PLATFORM_SYSTEM_IO_URING
+  } else if (dispatcher->getIoUring() != nullptr) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    __kernel_timespec expires;
+    expires.tv_sec = seconds.count();
+    expires.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - seconds).count();
+
+    io_uring_sqe request = {};
+    request.opcode = IORING_OP_TIMEOUT;
+    request.fd = -1;
+    request.addr = reinterpret_cast<uintptr_t>(&expires);
+    request.len = 1;
+
+    bool interrupted;
+    context = &expires;
+    int32_t result = dispatcher->submitOperation(request, interrupted);
+    context = nullptr;
+    if (result == -ETIME) {
+      if (interrupted) {
+        // expired before the removal, the next operation of the context reports the interrupt
+        dispatcher->interrupt();
+      }
+    } else if (interrupted) {
+      throw InterruptedException();
+    } else {
+      throw std::runtime_error("Timer::sleep, timeout failed, " + errorMessage(-result));
+    }
+#endif
   } else {
     timer = dispatcher->getTimer();
 
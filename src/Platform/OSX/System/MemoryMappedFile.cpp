@@ -24,6 +24,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cassert>
 
 #include "Common/ScopeExit.h"
@@ -33,7 +34,8 @@ namespace platform_system {
 MemoryMappedFile::MemoryMappedFile() :
   m_file(-1),
   m_size(0),
-  m_data(nullptr) {
+  m_data(nullptr),
+  m_readOnly(false) {
 }
 
 MemoryMappedFile::~MemoryMappedFile() {
@@ -159,6 +161,47 @@ void MemoryMappedFile::open(const std::string& path) {
   }
 }
 
+void MemoryMappedFile::openReadOnly(const std::string& path, uint64_t mappedSize, std::error_code& ec) {
+  if (isOpened()) {
+    close(ec);
+    if (ec) {
+      return;
+    }
+  }
+
+  tools::ScopeExit failExitHandler([this, &ec] {
+    ec = std::error_code(errno, std::system_category());
+    std::error_code ignore;
+    close(ignore);
+  });
+
+  m_file = ::open(path.c_str(), O_RDONLY);
+  if (m_file == -1) {
+    return;
+  }
+
+  struct stat fileStat;
+  int result = ::fstat(m_file, &fileStat);
+  if (result == -1) {
+    return;
+  }
+
+  // pages of a shared mapping past the end of the file become readable as the file grows
+  uint64_t size = std::max(static_cast<uint64_t>(fileStat.st_size), mappedSize);
+  void* data = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, m_file, 0);
+  if (data == MAP_FAILED) {
+    return;
+  }
+
+  m_data = reinterpret_cast<uint8_t*>(data);
+  m_size = size;
+  m_path = path;
+  m_readOnly = true;
+  ec = std::error_code();
+
+  failExitHandler.cancel();
+}
+
 void MemoryMappedFile::rename(const std::string& newPath, std::error_code& ec) {
   assert(isOpened());
 
@@ -184,14 +227,17 @@ void MemoryMappedFile::rename(const std::string& newPath) {
 void MemoryMappedFile::close(std::error_code& ec) {
   int result;
   if (m_data != nullptr) {
-    flush(m_data, m_size, ec);
-    if (ec) {
-      return;
+    if (!m_readOnly) {
+      flush(m_data, m_size, ec);
+      if (ec) {
+        return;
+      }
     }
 
     result = ::munmap(m_data, static_cast<size_t>(m_size));
     if (result == 0) {
       m_data = nullptr;
+      m_readOnly = false;
     } else {
       ec = std::error_code(errno, std::system_category());
       return;
@@ -254,6 +300,7 @@ void MemoryMappedFile::swap(MemoryMappedFile& other) {
   std::swap(m_path, other.m_path);
   std::swap(m_data, other.m_data);
   std::swap(m_size, other.m_size);
+  std::swap(m_readOnly, other.m_readOnly);
 }
 
 }
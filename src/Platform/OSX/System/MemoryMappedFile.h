@@ -32,6 +32,9 @@ public:
   void create(const std::string& path, uint64_t size, bool overwrite);
   void open(const std::string& path, std::error_code& ec);
   void open(const std::string& path);
+  // Maps at least mappedSize bytes of the file for reading only, close() then does not flush. Where the platform
+  // allows a view past the end of the file, data appended to the file later is readable through that part.
+  void openReadOnly(const std::string& path, uint64_t mappedSize, std::error_code& ec);
   void close(std::error_code& ec);
   void close();
 
@@ -54,6 +57,7 @@ private:
   std::string m_path;
   uint64_t m_size;
   uint8_t* m_data;
+  bool m_readOnly;
 };
 
 }
@@ -30,7 +30,8 @@ MemoryMappedFile::MemoryMappedFile() :
   m_fileHandle(INVALID_HANDLE_VALUE),
   m_mappingHandle(INVALID_HANDLE_VALUE),
   m_size(0),
-  m_data(nullptr) {
+  m_data(nullptr),
+  m_readOnly(false) {
 }
 
 MemoryMappedFile::~MemoryMappedFile() {
@@ -186,6 +187,58 @@ void MemoryMappedFile::open(const std::string& path) {
   }
 }
 
+void MemoryMappedFile::openReadOnly(const std::string& path, uint64_t mappedSize, std::error_code& ec) {
+  if (isOpened()) {
+    close(ec);
+    if (ec) {
+      return;
+    }
+  }
+
+  tools::ScopeExit failExitHandler([this, &ec] {
+    ec = std::error_code(::GetLastError(), std::system_category());
+    std::error_code ignore;
+    close(ignore);
+  });
+
+  m_fileHandle = ::CreateFile(
+    path.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+    NULL,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    NULL);
+  if (m_fileHandle == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  LARGE_INTEGER fileSize;
+  BOOL result = ::GetFileSizeEx(m_fileHandle, &fileSize);
+  if (!result) {
+    return;
+  }
+
+  // a read only view can not extend past the end of the file, mappedSize is not reserved here
+  m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+  m_mappingHandle = ::CreateFileMapping(m_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (m_mappingHandle == NULL) {
+    return;
+  }
+
+  m_data = reinterpret_cast<uint8_t*>(::MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (m_data == NULL) {
+    return;
+  }
+
+  m_path = path;
+  m_readOnly = true;
+  ec = std::error_code();
+
+  failExitHandler.cancel();
+}
+
 void MemoryMappedFile::rename(const std::string& newPath, std::error_code& ec) {
   assert(isOpened());
 
@@ -211,14 +264,17 @@ void MemoryMappedFile::rename(const std::string& newPath) {
 void MemoryMappedFile::close(std::error_code& ec) {
   BOOL result;
   if (m_data != nullptr) {
-    flush(m_data, m_size, ec);
-    if (ec) {
-      return;
+    if (!m_readOnly) {
+      flush(m_data, m_size, ec);
+      if (ec) {
+        return;
+      }
     }
 
     result = ::UnmapViewOfFile(m_data);
     if (result) {
       m_data = nullptr;
+      m_readOnly = false;
     } else {
       ec = std::error_code(::GetLastError(), std::system_category());
       return;
@@ -288,6 +344,7 @@ void MemoryMappedFile::swap(MemoryMappedFile& other) {
   std::swap(m_path, other.m_path);
   std::swap(m_data, other.m_data);
   std::swap(m_size, other.m_size);
+  std::swap(m_readOnly, other.m_readOnly);
 }
 
 }
@@ -25,6 +25,9 @@ public:
   TcpConnection& operator=(TcpConnection&& other);
   size_t read(uint8_t* data, size_t size);
   size_t write(const uint8_t* data, size_t size);
+  // Writes the header followed by the data with a single system call, returns the number of bytes
+  // written from both; a partial write may end anywhere, including inside the header
+  size_t write(const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size);
   std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
 private:
@@ -204,6 +204,35 @@ struct COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES {
   };
 };
 //-----------------------------------------------
+struct COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES {
+
+  struct request {
+    std::vector<crypto::Hash> txids;
+
+    void serialize(ISerializer &s) {
+      serializeAsBinary(txids, "txids", s);
+    }
+  };
+
+  struct tx_outputs_indexes {
+    std::vector<uint32_t> o_indexes;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(o_indexes)
+    }
+  };
+
+  struct response {
+    std::vector<tx_outputs_indexes> txs; // in the order of txids
+    std::string status;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(txs)
+      KV_MEMBER(status)
+    }
+  };
+};
+//-----------------------------------------------
 struct COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_request {
   std::vector<uint64_t> amounts;
   uint64_t outs_count;
@@ -351,6 +380,10 @@ struct COMMAND_RPC_GET_INFO {
     uint64_t last_block_reward;
     uint64_t last_block_timestamp;
     uint64_t last_block_difficulty;
+    uint64_t signature_cache_hits;
+    uint64_t signature_cache_misses;
+    uint64_t rpc_cache_hits;
+    uint64_t rpc_cache_misses;
     std::vector<std::string> connections;
 
     void serialize(ISerializer &s) {
@@ -374,6 +407,10 @@ struct COMMAND_RPC_GET_INFO {
       KV_MEMBER(last_block_reward)
       KV_MEMBER(last_block_timestamp)
       KV_MEMBER(last_block_difficulty)
+      KV_MEMBER(signature_cache_hits)
+      KV_MEMBER(signature_cache_misses)
+      KV_MEMBER(rpc_cache_hits)
+      KV_MEMBER(rpc_cache_misses)
       KV_MEMBER(connections)      
     }
   };
@@ -446,10 +483,14 @@ struct COMMAND_RPC_GETBLOCKTEMPLATE {
   struct request {
     uint64_t reserve_size; //max 255 bytes
     std::string wallet_address;
+    std::string template_id; //optional, wait until the template identified by it is outdated
+    uint64_t pool_delta; //optional, pool size change that outdates a template, 1 by default
 
     void serialize(ISerializer &s) {
       KV_MEMBER(reserve_size)
       KV_MEMBER(wallet_address)
+      KV_MEMBER(template_id)
+      KV_MEMBER(pool_delta)
     }
   };
 
@@ -458,6 +499,7 @@ struct COMMAND_RPC_GETBLOCKTEMPLATE {
     uint32_t height;
     uint64_t reserved_offset;
     std::string blocktemplate_blob;
+    std::string template_id;
     std::string status;
 
     void serialize(ISerializer &s) {
@@ -465,6 +507,7 @@ struct COMMAND_RPC_GETBLOCKTEMPLATE {
       KV_MEMBER(height)
       KV_MEMBER(reserved_offset)
       KV_MEMBER(blocktemplate_blob)
+      KV_MEMBER(template_id)
       KV_MEMBER(status)
     }
   };
@@ -483,7 +526,7 @@ struct COMMAND_RPC_GET_CURRENCY_ID {
 };
 
 struct COMMAND_RPC_SUBMITBLOCK {
-  using request = std::vector<std::string>;
+  using request = std::vector<std::string>; //block blob, optionally followed by the template id it was mined on
   using response = STATUS_STRUCT;
 };
 
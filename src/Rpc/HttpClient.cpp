@@ -18,6 +18,7 @@
 #include "HttpClient.h"
 
 #include <HTTP/HttpParser.h>
+#include <HTTP/HttpWriter.h>
 #include <System/Ipv4Resolver.h>
 #include <System/Ipv4Address.h>
 #include <System/TcpConnector.h>
@@ -40,11 +41,12 @@ void HttpClient::request(const HttpRequest &req, HttpResponse &res) {
   }
 
   try {
-    std::iostream stream(m_streamBuf.get());
+    req.write([this](const char* data, size_t size) {
+      writeAll(m_connection, data, size);
+    });
+
     HttpParser parser;
-    stream << req;
-    stream.flush();
-    parser.receiveResponse(stream, res);
+    parser.receiveResponse(*m_input, res);
   } catch (const std::exception &) {
     disconnect();
     throw;
@@ -55,7 +57,9 @@ void HttpClient::connect() {
   try {
     auto ipAddr = platform_system::Ipv4Resolver(m_dispatcher).resolve(m_address);
     m_connection = platform_system::TcpConnector(m_dispatcher).connect(ipAddr, m_port);
-    m_streamBuf.reset(new platform_system::TcpStreambuf(m_connection));
+    m_input.reset(new HttpInputBuffer([this](char* data, size_t size) {
+      return m_connection.read(reinterpret_cast<uint8_t*>(data), size);
+    }));
     m_connected = true;
   } catch (const std::exception& e) {
     throw ConnectException(e.what());
@@ -67,7 +71,7 @@ bool HttpClient::isConnected() const {
 }
 
 void HttpClient::disconnect() {
-  m_streamBuf.reset();
+  m_input.reset();
   try {
     m_connection.write(nullptr, 0); //Socket shutdown.
   } catch (const std::exception& e) {
@@ -88,4 +92,7 @@ void HttpClient::disconnect() {
 ConnectException::ConnectException(const std::string& whatArg) : std::runtime_error(whatArg.c_str()) {
 }
 
+NotFoundException::NotFoundException(const std::string& whatArg) : std::runtime_error(whatArg.c_str()) {
+}
+
 }
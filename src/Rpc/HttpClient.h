@@ -20,10 +20,10 @@
 #include <memory>
 
 #include <Common/Base64.h>
+#include <HTTP/HttpInputBuffer.h>
 #include <HTTP/HttpRequest.h>
 #include <HTTP/HttpResponse.h>
 #include <System/TcpConnection.h>
-#include <System/TcpStream.h>
 #include "JsonRpc.h"
 
 #include "Serialization/SerializationTools.h"
@@ -35,6 +35,12 @@ public:
   ConnectException(const std::string& whatArg);
 };
 
+// The server answered 404, it does not know the requested url
+class NotFoundException : public std::runtime_error  {
+public:
+  NotFoundException(const std::string& whatArg);
+};
+
 class HttpClient {
 public:
 
@@ -54,7 +60,7 @@ private:
   bool m_connected = false;
   platform_system::Dispatcher& m_dispatcher;
   platform_system::TcpConnection m_connection;
-  std::unique_ptr<platform_system::TcpStreambuf> m_streamBuf;
+  std::unique_ptr<HttpInputBuffer> m_input;
 };
 
 template <typename Request, typename Response>
@@ -70,6 +76,10 @@ void invokeJsonCommand(HttpClient& client, const std::string& url, const Request
   hreq.setBody(storeToJson(req));
   client.request(hreq, hres);
 
+  if (hres.getStatus() == HttpResponse::STATUS_404) {
+    throw NotFoundException(url);
+  }
+
   if (hres.getStatus() != HttpResponse::STATUS_200) {
     throw std::runtime_error("HTTP status: " + std::to_string(hres.getStatus()));
   }
@@ -128,6 +138,10 @@ void invokeBinaryCommand(HttpClient& client, const std::string& url, const Reque
   hreq.setBody(storeToBinaryKeyValue(req));
   client.request(hreq, hres);
 
+  if (hres.getStatus() == HttpResponse::STATUS_404) {
+    throw NotFoundException(url);
+  }
+
   if (!loadFromBinaryKeyValue(res, hres.getBody())) {
     throw std::runtime_error("Failed to parse binary response");
   }
@@ -18,30 +18,52 @@
 // along with Karbo.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "HttpServer.h"
+#include <algorithm>
+#include <limits>
 #include <boost/scope_exit.hpp>
 
 #include <Common/Base64.h>
 #include <HTTP/HttpParser.h>
+#include <HTTP/HttpParserErrorCodes.h>
+#include <HTTP/HttpWriter.h>
 #include <System/InterruptedException.h>
-#include <System/TcpStream.h>
 #include <System/Ipv4Address.h>
 
 using namespace logging;
 
 namespace {
+	const size_t DEFAULT_MAX_REQUEST_BODY_SIZE = 16 * 1024 * 1024;
+
 	void fillUnauthorizedResponse(cn::HttpResponse& response) {
 		response.setStatus(cn::HttpResponse::STATUS_401);
 		response.addHeader("WWW-Authenticate", "Basic realm=\"RPC\"");
 		response.addHeader("Content-Type", "text/plain");
 		response.setBody("Authorization required");
 	}
+
+	bool isBodyTooLarge(const std::system_error& error) {
+		return error.code() == make_error_code(cn::error::HttpParserErrorCodes::BODY_TOO_LARGE);
+	}
 }
 
 namespace cn {
 
 HttpServer::HttpServer(platform_system::Dispatcher& dispatcher, logging::ILogger& log)
-  : m_dispatcher(dispatcher), workingContextGroup(dispatcher), logger(log, "HttpServer") {
+  : m_dispatcher(dispatcher), workingContextGroup(dispatcher), logger(log, "HttpServer"),
+  m_maxRequestBodySize(DEFAULT_MAX_REQUEST_BODY_SIZE), m_maxConcurrentRequests(std::numeric_limits<size_t>::max()), m_concurrentRequests(0), m_requestFinished(dispatcher) {
+
+}
+
+void HttpServer::setWorkerThreads(size_t count) {
+  m_workers.reset(count > 0 ? new platform_system::DispatcherPool(count) : nullptr);
+}
 
+void HttpServer::setMaxConcurrentRequests(size_t count) {
+  m_maxConcurrentRequests = std::max<size_t>(count, 1);
+}
+
+void HttpServer::setMaxRequestBodySize(size_t size) {
+  m_maxRequestBodySize = size;
 }
 
 void HttpServer::start(const std::string& address, uint16_t port, const std::string& user, const std::string& password) {
@@ -90,8 +112,9 @@ void HttpServer::acceptLoop() {
 
     logger(DEBUGGING) << "Incoming connection from " << addr.first.toDottedDecimal() << ":" << addr.second;
 
-    platform_system::TcpStreambuf streambuf(connection);
-    std::iostream stream(&streambuf);
+    HttpInputBuffer input([&connection](char* data, size_t size) {
+      return connection.read(reinterpret_cast<uint8_t*>(data), size);
+    });
     HttpParser parser;
 
     for (;;) {
@@ -100,7 +123,25 @@ void HttpServer::acceptLoop() {
 	  resp.addHeader("Access-Control-Allow-Origin", "*");
 	  resp.addHeader("Content-Type", "application/json");
 	
-      parser.receiveRequest(stream, req);
+      try {
+        parser.receiveRequest(input, req, m_maxRequestBodySize);
+      } catch (std::system_error& e) {
+        if (!isBodyTooLarge(e)) {
+          throw;
+        }
+
+        // the body is left unread, so the connection can not carry another request
+        logger(WARNING) << "Request body too large from " << addr.first.toDottedDecimal() << ":" << addr.second;
+        resp.setStatus(HttpResponse::STATUS_413);
+        resp.addHeader("Content-Type", "text/plain");
+        resp.addHeader("Connection", "close");
+        resp.write([&connection](const char* data, size_t size) {
+          writeAll(connection, data, size);
+        });
+
+        break;
+      }
+
 				if (authenticate(req)) {
 					processRequest(req, resp);
 				}
@@ -109,10 +150,11 @@ void HttpServer::acceptLoop() {
 					fillUnauthorizedResponse(resp);
 				}
 
-      stream << resp;
-      stream.flush();
+      resp.write([&connection](const char* data, size_t size) {
+        writeAll(connection, data, size);
+      });
 
-      if (stream.peek() == std::iostream::traits_type::eof()) {
+      if (!input.waitForData()) {
         break;
       }
     }
@@ -126,6 +168,52 @@ void HttpServer::acceptLoop() {
   }
 }
 
+void HttpServer::runConcurrently(const std::function<void(platform_system::Dispatcher&)>& handler) {
+  if (!m_workers) {
+    handler(m_dispatcher);
+    return;
+  }
+
+  while (m_concurrentRequests >= m_maxConcurrentRequests) {
+    m_requestFinished.wait();
+  }
+
+  ++m_concurrentRequests;
+  platform_system::Event done(m_dispatcher);
+  std::exception_ptr error;
+  m_workers->spawn([&](platform_system::Dispatcher& dispatcher) {
+    try {
+      handler(dispatcher);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    m_dispatcher.remoteSpawn([&done] { done.set(); });
+  });
+
+  // the handler works on objects of this context, so it is waited for even when interrupted
+  bool interrupted = false;
+  while (!done.get()) {
+    try {
+      done.wait();
+    } catch (platform_system::InterruptedException&) {
+      interrupted = true;
+    }
+  }
+
+  --m_concurrentRequests;
+  m_requestFinished.set();
+  m_requestFinished.clear();
+
+  if (interrupted) {
+    throw platform_system::InterruptedException();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 bool HttpServer::authenticate(const HttpRequest& request) const {
 	if (!m_credentials.empty()) {
 		auto headerIt = request.getHeaders().find("authorization");
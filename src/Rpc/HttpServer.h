@@ -18,6 +18,8 @@
 
 #pragma once 
 
+#include <functional>
+#include <memory>
 #include <unordered_set>
 
 #include <HTTP/HttpRequest.h>
@@ -25,6 +27,7 @@
 
 #include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
+#include <System/DispatcherPool.h>
 #include <System/TcpListener.h>
 #include <System/TcpConnection.h>
 #include <System/Event.h>
@@ -42,11 +45,27 @@ public:
   void start(const std::string& address, uint16_t port, const std::string& user = "", const std::string& password = "");
   void stop();
 
+  // Handlers passed to runConcurrently run on a pool of this many dispatchers, with 0 they run on the
+  // dispatcher of the server. Call before start. Connections are still accepted, read and written on
+  // the dispatcher of the server: a TcpConnection stays bound to the dispatcher that accepted it, and the
+  // handlers that are not offloaded use objects of that dispatcher. Only the offloaded handler work is
+  // spread over the pool, socket I/O and request parsing stay on one thread.
+  void setWorkerThreads(size_t count);
+  // Requests beyond this many concurrent handlers wait on the dispatcher for a free slot
+  void setMaxConcurrentRequests(size_t count);
+  // Requests announcing a larger body are answered with 413 and the connection is closed
+  void setMaxRequestBodySize(size_t size);
+
   virtual void processRequest(const HttpRequest& request, HttpResponse& response) = 0;
   virtual size_t get_connections_count() const;
 
 protected:
 
+  // Runs a handler that does not touch objects bound to the server dispatcher on a pool dispatcher, the
+  // calling context is suspended until it returns. The handler gets the dispatcher it runs on, timers and
+  // events it waits on belong to that one. Exceptions thrown by the handler are rethrown here.
+  void runConcurrently(const std::function<void(platform_system::Dispatcher&)>& handler);
+
   platform_system::Dispatcher& m_dispatcher;
 
 private:
@@ -60,6 +79,12 @@ private:
   platform_system::TcpListener m_listener;
   std::unordered_set<platform_system::TcpConnection*> m_connections;
   std::string m_credentials;
+
+  std::unique_ptr<platform_system::DispatcherPool> m_workers;
+  size_t m_maxRequestBodySize;
+  size_t m_maxConcurrentRequests;
+  size_t m_concurrentRequests;
+  platform_system::Event m_requestFinished;
 };
 
 }
@@ -113,6 +113,10 @@ public:
     return id;
   }
 
+  std::string getParamsBody() const {
+    return psReq.contains("params") ? psReq("params").toString() : std::string();
+  }
+
   std::string getBody() {
     psReq.set("jsonrpc", std::string("2.0"));
     psReq.set("method", method);
@@ -164,6 +168,25 @@ public:
     return psResp.toString();
   }
 
+  bool hasResult() const {
+    return psResp.contains("result") && !psResp.contains("error");
+  }
+
+  std::string getResultBody() const {
+    return psResp("result").toString();
+  }
+
+  // Same body as getBody() of a response carrying the already serialized result
+  static std::string makeBody(const OptionalId& id, const std::string& resultBody) {
+    std::string body = "{";
+    if (id.is_initialized()) {
+      body += "\"id\":" + id->toString() + ",";
+    }
+
+    body += "\"jsonrpc\":\"2.0\",\"result\":" + resultBody + "}";
+    return body;
+  }
+
   template <typename T>
   bool setResult(const T& v) {
     psResp.set("result", storeToJsonValue(v));
@@ -0,0 +1,138 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "RpcResponseCache.h"
+
+#include <iterator>
+
+namespace {
+
+// list node, index node and bookkeeping of one entry
+const size_t ENTRY_OVERHEAD = 192;
+
+}
+
+namespace cn {
+
+const std::chrono::seconds RpcResponseCache::NODE_STATE_MAX_AGE(1);
+
+RpcResponseCache::RpcResponseCache(size_t maxSize) : m_maxSize(maxSize), m_memoryUsage(0), m_version{0, 0}, m_hits(0), m_misses(0) {
+}
+
+void RpcResponseCache::setMaxSize(size_t maxSize) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxSize = maxSize;
+  shrink(m_maxSize);
+}
+
+RpcResponseCache::Version RpcResponseCache::version() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_version;
+}
+
+bool RpcResponseCache::find(const std::string& key, std::string& response) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it == m_index.end()) {
+    ++m_misses;
+    return false;
+  }
+
+  if (!isFresh(*it->second, std::chrono::steady_clock::now())) {
+    erase(it->second);
+    ++m_misses;
+    return false;
+  }
+
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  response = it->second->response;
+  ++m_hits;
+  return true;
+}
+
+void RpcResponseCache::insert(const std::string& key, const std::string& response, Policy policy, const Version& version) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t size = entrySize(key, response);
+  if (policy == NONE || size > m_maxSize) {
+    return;
+  }
+
+  Entry entry{ key, response, policy, version, std::chrono::steady_clock::now() };
+  if (!isFresh(entry, entry.created)) {
+    return;
+  }
+
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    erase(it->second);
+  }
+
+  shrink(m_maxSize - size);
+  m_entries.emplace_front(std::move(entry));
+  m_index.emplace(key, m_entries.begin());
+  m_memoryUsage += size;
+}
+
+void RpcResponseCache::chainUpdated() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_version.chain;
+}
+
+void RpcResponseCache::poolUpdated() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_version.pool;
+}
+
+uint64_t RpcResponseCache::hits() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_hits;
+}
+
+uint64_t RpcResponseCache::misses() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_misses;
+}
+
+size_t RpcResponseCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+size_t RpcResponseCache::memoryUsage() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_memoryUsage;
+}
+
+bool RpcResponseCache::isFresh(const Entry& entry, std::chrono::steady_clock::time_point now) const {
+  switch (entry.policy) {
+  case STATIC:
+    return true;
+  case CHAIN:
+    return entry.version.chain == m_version.chain;
+  case NODE_STATE:
+    return entry.version.chain == m_version.chain && entry.version.pool == m_version.pool && now - entry.created < NODE_STATE_MAX_AGE;
+  default:
+    return false;
+  }
+}
+
+void RpcResponseCache::erase(EntryList::iterator it) {
+  m_memoryUsage -= entrySize(it->key, it->response);
+  m_index.erase(it->key);
+  m_entries.erase(it);
+}
+
+// stale entries are not swept, they are dropped when looked up or as the least recently used
+void RpcResponseCache::shrink(size_t maxSize) {
+  while (m_memoryUsage > maxSize) {
+    erase(std::prev(m_entries.end()));
+  }
+}
+
+size_t RpcResponseCache::entrySize(const std::string& key, const std::string& response) {
+  return 2 * key.size() + response.size() + ENTRY_OVERHEAD;
+}
+
+}
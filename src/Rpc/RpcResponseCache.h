@@ -0,0 +1,80 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cn {
+
+// Serialized answers of read only RPC requests, keyed by the method and its parameters. Entries
+// remember the chain and pool versions they were computed at and are dropped once the state they
+// depend on moves on. The cache is bounded by the size of keys and answers.
+class RpcResponseCache {
+public:
+  enum Policy {
+    NONE,       // not cached
+    STATIC,     // never goes stale
+    CHAIN,      // stale after the main chain changes
+    NODE_STATE  // also reports the pool and connections, stale after the pool changes or NODE_STATE_MAX_AGE
+  };
+
+  struct Version {
+    uint64_t chain;
+    uint64_t pool;
+  };
+
+  static const std::chrono::seconds NODE_STATE_MAX_AGE;
+
+  explicit RpcResponseCache(size_t maxSize);
+
+  void setMaxSize(size_t maxSize);
+
+  // Taken before computing an answer, an answer computed across an update is not inserted
+  Version version() const;
+
+  bool find(const std::string& key, std::string& response);
+  void insert(const std::string& key, const std::string& response, Policy policy, const Version& version);
+
+  void chainUpdated();
+  void poolUpdated();
+
+  uint64_t hits() const;
+  uint64_t misses() const;
+  size_t size() const;
+  size_t memoryUsage() const;
+
+private:
+  struct Entry {
+    std::string key;
+    std::string response;
+    Policy policy;
+    Version version;
+    std::chrono::steady_clock::time_point created;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  bool isFresh(const Entry& entry, std::chrono::steady_clock::time_point now) const;
+  void erase(EntryList::iterator it);
+  void shrink(size_t maxSize);
+  static size_t entrySize(const std::string& key, const std::string& response);
+
+  size_t m_maxSize;
+  size_t m_memoryUsage;
+  mutable std::mutex m_mutex;
+  EntryList m_entries; // most recently used first
+  std::unordered_map<std::string, EntryList::iterator> m_index;
+  Version m_version;
+  uint64_t m_hits;
+  uint64_t m_misses;
+};
+
+}
@@ -8,6 +8,7 @@
 #include "RpcServer.h"
 
 #include <future>
+#include <boost/scope_exit.hpp>
 #include <unordered_map>
 
 // cn
@@ -25,6 +26,10 @@
 
 #include "P2p/NetNode.h"
 
+#include <System/ContextGroup.h>
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+
 #include "CoreRpcServerErrorCodes.h"
 #include "JsonRpc.h"
 #include "version.h"
@@ -36,6 +41,7 @@ using namespace crypto;
 using namespace common;
 
 const uint64_t BLOCK_LIST_MAX_COUNT = 1000;
+const std::chrono::seconds BLOCK_TEMPLATE_LONGPOLL_TIMEOUT(60);
 
 namespace cn {
 
@@ -58,6 +64,15 @@ RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command
   };
 }
 
+void addJsonHeaders(const std::string& cors_domain, HttpResponse& response) {
+  if (!cors_domain.empty()) {
+    response.addHeader("Access-Control-Allow-Origin", cors_domain);
+    response.addHeader("Access-Control-Allow-Headers", "Origin, X-Requested-With, Content-Type, Accept");
+    response.addHeader("Access-Control-Allow-Methods", "POST, GET");
+  }
+  response.addHeader("Content-Type", "application/json");
+}
+
 template <typename Command>
 RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
   return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
@@ -71,14 +86,7 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
 
     bool result = (obj->*handler)(req, res);
 
-    std::string cors_domain = obj->getCorsDomain();
-    if (!cors_domain.empty()) {
-      response.addHeader("Access-Control-Allow-Origin", cors_domain);
-      response.addHeader("Access-Control-Allow-Headers", "Origin, X-Requested-With, Content-Type, Accept");
-      response.addHeader("Access-Control-Allow-Methods", "POST, GET");
-    }
-    response.addHeader("Content-Type", "application/json");
-
+    addJsonHeaders(obj->getCorsDomain(), response);
     response.setBody(storeToJson(res.data()));
     return result;
   };
@@ -89,32 +97,40 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
 std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
 
   // binary handlers
-  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false } },
-  { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false } },
-  { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false } },
-  { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false } },
-  { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs_bin), false } },
-  { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
-  { "/get_pool_changes_lite.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false } },
+  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false, true } },
+  { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false, true } },
+  { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false, true } },
+  { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false, true } },
+  { "/get_o_indexes_batch.bin", { binMethod<COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes_batch), false, true } },
+  { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs_bin), false, true } },
+  { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false, true } },
+  { "/get_pool_changes_lite.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false, true } },
 
   // json handlers
-  { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true } },
-  { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true } },
-  { "/gettransactions", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false } },
+  { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true, false, RpcResponseCache::NODE_STATE } },
+  { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true, true } },
+  { "/gettransactions", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false, true } },
   { "/sendrawtransaction", { jsonMethod<COMMAND_RPC_SEND_RAW_TX>(&RpcServer::on_send_raw_tx), false } },
   { "/feeaddress", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_address), true } },
   { "/peers", { jsonMethod<COMMAND_RPC_GET_PEER_LIST>(&RpcServer::on_get_peer_list), true } },
   { "/getpeers", { jsonMethod<COMMAND_RPC_GET_PEER_LIST>(&RpcServer::on_get_peer_list), true } },
-  { "/get_raw_transactions_by_heights", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS_WITH_OUTPUT_GLOBAL_INDEXES>(&RpcServer::on_get_txs_with_output_global_indexes), true } },
-  { "/getrawtransactionspool", { jsonMethod<COMMAND_RPC_GET_RAW_TRANSACTIONS_POOL>(&RpcServer::on_get_transactions_pool_raw), true } },
-  { "/getrandom_outs", { jsonMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_JSON>(&RpcServer::on_get_random_outs_json), false } },
+  { "/get_raw_transactions_by_heights", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS_WITH_OUTPUT_GLOBAL_INDEXES>(&RpcServer::on_get_txs_with_output_global_indexes), true, true } },
+  { "/getrawtransactionspool", { jsonMethod<COMMAND_RPC_GET_RAW_TRANSACTIONS_POOL>(&RpcServer::on_get_transactions_pool_raw), true, true } },
+  { "/getrandom_outs", { jsonMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_JSON>(&RpcServer::on_get_random_outs_json), false, true } },
 
   // json rpc
   { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
 };
 
 RpcServer::RpcServer(platform_system::Dispatcher& dispatcher, logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery) :
-  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery) {
+  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery),
+  m_templateChanged(dispatcher), m_templateWaiters(0), m_templateNotifyPending(false),
+  m_templateLongPollTimeout(BLOCK_TEMPLATE_LONGPOLL_TIMEOUT), m_responseCache(0) {
+  m_core.addObserver(this);
+}
+
+RpcServer::~RpcServer() {
+  m_core.removeObserver(this);
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -132,7 +148,31 @@ void RpcServer::processRequest(const HttpRequest& request, HttpResponse& respons
     return;
   }
 
-  it->second.handler(this, request, response);
+  // only JSON handlers are cached, a hit is answered with their headers
+  std::string cacheKey;
+  RpcResponseCache::Version cacheVersion = {};
+  if (it->second.cache != RpcResponseCache::NONE) {
+    cacheKey = url + '\n' + request.getBody();
+    std::string body;
+    if (m_responseCache.find(cacheKey, body)) {
+      addJsonHeaders(m_cors_domain, response);
+      response.setBody(std::move(body));
+      return;
+    }
+
+    cacheVersion = m_responseCache.version();
+  }
+
+  bool result;
+  if (it->second.concurrent) {
+    runConcurrently([&](platform_system::Dispatcher&) { result = it->second.handler(this, request, response); });
+  } else {
+    result = it->second.handler(this, request, response);
+  }
+
+  if (result && it->second.cache != RpcResponseCache::NONE) {
+    m_responseCache.insert(cacheKey, response.getBody(), it->second.cache, cacheVersion);
+  }
 }
 
 bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse& response) {
@@ -148,6 +188,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
 
   JsonRpcRequest jsonRequest;
   JsonRpcResponse jsonResponse;
+  std::string body;
 
   try {
     logger(TRACE) << "JSON-RPC request: " << request.getBody();
@@ -155,26 +196,26 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
     jsonResponse.setId(jsonRequest.getId()); // copy id
 
     static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers = {
-        {"getaltblockslist", {makeMemberMethod(&RpcServer::on_alt_blocks_list_json), true}},
-        {"f_blocks_list_json", {makeMemberMethod(&RpcServer::f_on_blocks_list_json), false}},
-        {"f_block_json", {makeMemberMethod(&RpcServer::f_on_block_json), false}},
-        {"f_transaction_json", {makeMemberMethod(&RpcServer::f_on_transaction_json), false}},
-        {"f_on_transactions_pool_json", {makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false}},
+        {"getaltblockslist", {makeMemberMethod(&RpcServer::on_alt_blocks_list_json), true, true}},
+        {"f_blocks_list_json", {makeMemberMethod(&RpcServer::f_on_blocks_list_json), false, true, RpcResponseCache::CHAIN}},
+        {"f_block_json", {makeMemberMethod(&RpcServer::f_on_block_json), false, true, RpcResponseCache::CHAIN}},
+        {"f_transaction_json", {makeMemberMethod(&RpcServer::f_on_transaction_json), false, true}},
+        {"f_on_transactions_pool_json", {makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false, true}},
         {"check_tx_proof", {makeMemberMethod(&RpcServer::k_on_check_tx_proof), false}},
-        {"check_reserve_proof", {makeMemberMethod(&RpcServer::k_on_check_reserve_proof), false}},
-        {"getblockcount", {makeMemberMethod(&RpcServer::on_getblockcount), true}},
-        {"getblockhash", {makeMemberMethod(&RpcServer::on_getblockhash), true}},
-        {"getblockbyheight", {makeMemberMethod(&RpcServer::on_get_block_details_by_height), true}},
-        {"on_getblockhash", {makeMemberMethod(&RpcServer::on_getblockhash), false}},
+        {"check_reserve_proof", {makeMemberMethod(&RpcServer::k_on_check_reserve_proof), false, true}},
+        {"getblockcount", {makeMemberMethod(&RpcServer::on_getblockcount), true, true}},
+        {"getblockhash", {makeMemberMethod(&RpcServer::on_getblockhash), true, true}},
+        {"getblockbyheight", {makeMemberMethod(&RpcServer::on_get_block_details_by_height), true, true}},
+        {"on_getblockhash", {makeMemberMethod(&RpcServer::on_getblockhash), false, true}},
         {"getblocktemplate", {makeMemberMethod(&RpcServer::on_getblocktemplate), false}},
-        {"getcurrencyid", {makeMemberMethod(&RpcServer::on_get_currency_id), true}},
+        {"getcurrencyid", {makeMemberMethod(&RpcServer::on_get_currency_id), true, true, RpcResponseCache::STATIC}},
         {"submitblock", {makeMemberMethod(&RpcServer::on_submitblock), false}},
-        {"getlastblockheader", {makeMemberMethod(&RpcServer::on_get_last_block_header), false}},
-        {"getblockheaderbyhash", {makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false}},
-        {"getblocktimestamp", {makeMemberMethod(&RpcServer::on_get_block_timestamp_by_height), true}},
-        {"getblockheaderbyheight", {makeMemberMethod(&RpcServer::on_get_block_header_by_height), false}},
-        {"getrawtransactionspool", {makeMemberMethod(&RpcServer::on_get_transactions_pool_raw), true}},
-        {"getrawtransactionsbyheights", {makeMemberMethod(&RpcServer::on_get_txs_with_output_global_indexes), true}}
+        {"getlastblockheader", {makeMemberMethod(&RpcServer::on_get_last_block_header), false, true, RpcResponseCache::CHAIN}},
+        {"getblockheaderbyhash", {makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false, true}},
+        {"getblocktimestamp", {makeMemberMethod(&RpcServer::on_get_block_timestamp_by_height), true, true}},
+        {"getblockheaderbyheight", {makeMemberMethod(&RpcServer::on_get_block_header_by_height), false, true, RpcResponseCache::CHAIN}},
+        {"getrawtransactionspool", {makeMemberMethod(&RpcServer::on_get_transactions_pool_raw), true, true}},
+        {"getrawtransactionsbyheights", {makeMemberMethod(&RpcServer::on_get_txs_with_output_global_indexes), true, true}}
     };
 
     auto it = jsonRpcHandlers.find(jsonRequest.getMethod());
@@ -186,16 +227,47 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
     }
 
-    it->second.handler(this, jsonRequest, jsonResponse);
+    // cached results are spliced into the body, the id differs between requests
+    std::string cacheKey;
+    RpcResponseCache::Version cacheVersion = {};
+    if (it->second.cache != RpcResponseCache::NONE) {
+      cacheKey = jsonRequest.getMethod() + '\n' + jsonRequest.getParamsBody();
+      std::string result;
+      if (m_responseCache.find(cacheKey, result)) {
+        body = JsonRpcResponse::makeBody(jsonRequest.getId(), result);
+      } else {
+        cacheVersion = m_responseCache.version();
+      }
+    }
+
+    if (body.empty()) {
+      if (it->second.concurrent) {
+        runConcurrently([&](platform_system::Dispatcher&) { it->second.handler(this, jsonRequest, jsonResponse); });
+      } else {
+        it->second.handler(this, jsonRequest, jsonResponse);
+      }
+
+      if (it->second.cache != RpcResponseCache::NONE && jsonResponse.hasResult()) {
+        std::string result = jsonResponse.getResultBody();
+        m_responseCache.insert(cacheKey, result, it->second.cache, cacheVersion);
+        body = JsonRpcResponse::makeBody(jsonRequest.getId(), result);
+      }
+    }
 
   } catch (const JsonRpcError& err) {
     jsonResponse.setError(err);
+  } catch (const platform_system::InterruptedException&) {
+    throw;
   } catch (const std::exception& e) {
     jsonResponse.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
   }
 
-  response.setBody(jsonResponse.getBody());
-  logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
+  if (body.empty()) {
+    body = jsonResponse.getBody();
+  }
+
+  logger(TRACE) << "JSON-RPC response: " << body;
+  response.setBody(std::move(body));
   return true;
 }
 
@@ -203,6 +275,84 @@ bool RpcServer::isCoreReady() {
   return m_core.currency().isTestnet() || m_p2p.get_payload_object().isSynchronized();
 }
 
+void RpcServer::blockchainUpdated() {
+  m_responseCache.chainUpdated();
+  notifyTemplateWaiters();
+}
+
+void RpcServer::poolUpdated() {
+  m_responseCache.poolUpdated();
+  notifyTemplateWaiters();
+}
+
+void RpcServer::notifyTemplateWaiters() {
+  if (m_templateWaiters == 0 || m_templateNotifyPending.exchange(true)) {
+    return;
+  }
+
+  m_dispatcher.remoteSpawn([this]() {
+    m_templateNotifyPending = false;
+    m_templateChanged.set();
+    m_templateChanged.clear();
+  });
+}
+
+std::string RpcServer::makeTemplateId(const crypto::Hash& tail, uint64_t poolSize) {
+  return podToHex(tail) + std::to_string(poolSize);
+}
+
+bool RpcServer::parseTemplateId(const std::string& templateId, crypto::Hash& tail, uint64_t& poolSize) {
+  const size_t tailSize = 2 * sizeof(crypto::Hash);
+  if (templateId.size() <= tailSize || !podFromHex(templateId.substr(0, tailSize), tail)) {
+    return false;
+  }
+
+  try {
+    poolSize = std::stoull(templateId.substr(tailSize));
+  } catch (std::exception&) {
+    return false;
+  }
+
+  return true;
+}
+
+void RpcServer::waitForTemplateChange(const std::string& templateId, uint64_t poolDelta) {
+  crypto::Hash tail;
+  uint64_t poolSize;
+  if (!parseTemplateId(templateId, tail, poolSize)) {
+    throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_WRONG_PARAM, "Wrong template id" };
+  }
+
+  auto outdated = [&]() {
+    uint64_t currentPoolSize = m_core.get_pool_transactions_count();
+    uint64_t delta = currentPoolSize > poolSize ? currentPoolSize - poolSize : poolSize - currentPoolSize;
+    return m_core.get_tail_id() != tail || delta >= poolDelta;
+  };
+
+  if (outdated()) {
+    return;
+  }
+
+  bool timedOut = false;
+  platform_system::ContextGroup timeoutGroup(m_dispatcher);
+  timeoutGroup.spawn([&]() {
+    try {
+      platform_system::Timer(m_dispatcher).sleep(m_templateLongPollTimeout);
+      timedOut = true;
+      m_templateChanged.set();
+      m_templateChanged.clear();
+    } catch (platform_system::InterruptedException&) {
+    }
+  });
+
+  ++m_templateWaiters;
+  BOOST_SCOPE_EXIT_ALL(this) { --m_templateWaiters; };
+
+  while (!timedOut && !outdated()) {
+    m_templateChanged.wait();
+  }
+}
+
 bool RpcServer::enableCors(const std::string& domain) {
   m_cors_domain = domain;
   return true;
@@ -212,6 +362,14 @@ std::string RpcServer::getCorsDomain() const {
   return m_cors_domain;
 }
 
+void RpcServer::setResponseCacheSize(size_t size) {
+  m_responseCache.setMaxSize(size);
+}
+
+void RpcServer::setBlockTemplateLongPollTimeout(std::chrono::milliseconds timeout) {
+  m_templateLongPollTimeout = timeout;
+}
+
 //
 // Binary handlers
 //
@@ -237,10 +395,15 @@ bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, C
 
   for (const auto& blockId : supplement) {
     assert(m_core.have_block(blockId));
+    res.blocks.resize(res.blocks.size() + 1);
+    if (m_core.getBlockBlobs(blockId, res.blocks.back())) {
+      continue;
+    }
+
+    // the block left the main chain since the supplement was taken
     auto completeBlock = m_core.getBlock(blockId);
     assert(completeBlock != nullptr);
 
-    res.blocks.resize(res.blocks.size() + 1);
     res.blocks.back().block = asString(toBinaryArray(completeBlock->getBlock()));
 
     res.blocks.back().txs.reserve(completeBlock->getTransactionCount());
@@ -885,6 +1048,26 @@ bool RpcServer::on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::
   return true;
 }
 
+bool RpcServer::on_get_indexes_batch(const COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::response& res) {
+  if (req.txids.size() > COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES_MAX_COUNT) {
+    res.status = "Failed: too many transactions requested";
+    return true;
+  }
+
+  res.txs.resize(req.txids.size());
+  for (size_t i = 0; i < req.txids.size(); ++i) {
+    if (!m_core.get_tx_outputs_gindexs(req.txids[i], res.txs[i].o_indexes)) {
+      res.txs.clear();
+      res.status = "Failed: transaction " + common::podToHex(req.txids[i]) + " not found";
+      return true;
+    }
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  logger(TRACE) << "COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES: [" << res.txs.size() << "]";
+  return true;
+}
+
 bool RpcServer::on_get_random_outs_bin(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res) {
   res.status = "Failed";
   if (!m_core.get_random_outs_for_amounts(req, res)) {
@@ -976,6 +1159,10 @@ bool RpcServer::on_get_info(const COMMAND_RPC_GET_INFO::request&, COMMAND_RPC_GE
   res.grey_peerlist_size = m_p2p.getPeerlistManager().get_gray_peers_count();
   res.last_known_block_index = std::max(static_cast<uint32_t>(1), m_protocolQuery.getObservedHeight()) - 1;
   res.full_deposit_amount = m_core.fullDepositAmount();
+  res.signature_cache_hits = m_core.ringSignatureCacheHits();
+  res.signature_cache_misses = m_core.ringSignatureCacheMisses();
+  res.rpc_cache_hits = m_responseCache.hits();
+  res.rpc_cache_misses = m_responseCache.misses();
   res.status = CORE_RPC_STATUS_OK;
   crypto::Hash last_block_hash = m_core.getBlockIdByHeight(m_core.get_current_blockchain_height() - 1);
   res.top_block_hash = common::podToHex(last_block_hash);
@@ -1337,14 +1524,22 @@ bool RpcServer::on_getblocktemplate(const COMMAND_RPC_GETBLOCKTEMPLATE::request&
     throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_WRONG_WALLET_ADDRESS, "Failed to parse wallet address" };
   }
 
+  if (!req.template_id.empty()) {
+    waitForTemplateChange(req.template_id, std::max<uint64_t>(req.pool_delta, 1));
+  }
+
   Block b = boost::value_initialized<Block>();
   cn::BinaryArray blob_reserve;
   blob_reserve.resize(req.reserve_size, 0);
+  uint64_t poolSize = m_core.get_pool_transactions_count();
   if (!m_core.get_block_template(b, acc, res.difficulty, res.height, blob_reserve)) {
     logger(ERROR) << "Failed to create block template";
     throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_INTERNAL_ERROR, "Internal error: failed to create block template" };
   }
 
+  // the tail is the one the template builds on, the chain may have moved since the wait above
+  res.template_id = makeTemplateId(b.previousBlockHash, poolSize);
+
   BinaryArray block_blob = toBinaryArray(b);
   PublicKey tx_pub_key = cn::getTransactionPublicKeyFromExtra(b.baseTransaction.extra);
   if (tx_pub_key == NULL_PUBLIC_KEY) {
@@ -1380,7 +1575,7 @@ bool RpcServer::on_get_currency_id(const COMMAND_RPC_GET_CURRENCY_ID::request& /
 }
 
 bool RpcServer::on_submitblock(const COMMAND_RPC_SUBMITBLOCK::request& req, COMMAND_RPC_SUBMITBLOCK::response& res) {
-  if (req.size() != 1) {
+  if (req.size() != 1 && req.size() != 2) {
     throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_WRONG_PARAM, "Wrong param" };
   }
 
@@ -1389,6 +1584,25 @@ bool RpcServer::on_submitblock(const COMMAND_RPC_SUBMITBLOCK::request& req, COMM
     throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_WRONG_BLOCKBLOB, "Wrong block blob" };
   }
 
+  if (req.size() == 2) {
+    crypto::Hash tail;
+    uint64_t poolSize;
+    if (!parseTemplateId(req[1], tail, poolSize)) {
+      throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_WRONG_PARAM, "Wrong template id" };
+    }
+
+    // a block on an outdated tail can not extend the main chain, skip its verification. The block names the
+    // tail it builds on itself, the one in the id only tells which template the miner worked on.
+    Block block;
+    if (!fromBinaryArray(block, blockblob)) {
+      throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_WRONG_BLOCKBLOB, "Wrong block blob" };
+    }
+
+    if (block.previousBlockHash != m_core.get_tail_id()) {
+      throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_BLOCK_NOT_ACCEPTED, "Block template is outdated" };
+    }
+  }
+
   block_verification_context bvc = boost::value_initialized<block_verification_context>();
 
   m_core.handle_incoming_block_blob(blockblob, bvc, true, true);
@@ -1460,20 +1674,34 @@ void RpcServer::fill_block_header_response(const Block& blk, bool orphan_status,
   responce.reward = get_block_reward(blk);
 }
 
+// Main chain header from the block header columns, the stored block is not loaded
+void RpcServer::fill_block_header_response(const BlockHeaderColumns::Header& header, uint32_t height, const Hash& hash, block_header_response& responce) {
+  responce.major_version = header.majorVersion;
+  responce.minor_version = header.minorVersion;
+  responce.timestamp = header.timestamp;
+  responce.prev_hash = common::podToHex(height == 0 ? NULL_HASH : m_core.getBlockIdByHeight(height - 1));
+  responce.nonce = header.nonce;
+  responce.orphan_status = false;
+  responce.height = height;
+  responce.deposits = m_core.depositAmountAtHeight(height);
+  responce.depth = m_core.get_current_blockchain_height() - height - 1;
+  responce.hash = common::podToHex(hash);
+  m_core.getBlockDifficulty(height, responce.difficulty);
+  responce.reward = header.reward;
+}
+
 bool RpcServer::on_get_last_block_header(const COMMAND_RPC_GET_LAST_BLOCK_HEADER::request&, COMMAND_RPC_GET_LAST_BLOCK_HEADER::response& res) {
   uint32_t last_block_height;
   Hash last_block_hash;
 
   m_core.get_blockchain_top(last_block_height, last_block_hash);
 
-  Block last_block;
-  if (!m_core.getBlockByHash(last_block_hash, last_block)) {
+  BlockHeaderColumns::Header last_block_header;
+  if (!m_core.getBlockHeader(last_block_height, last_block_header)) {
     throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_INTERNAL_ERROR, "Internal error: can't get last block hash." };
   }
 
-  crypto::Hash tmp_hash = m_core.getBlockIdByHeight(last_block_height);
-  bool is_orphaned = last_block_hash != tmp_hash;
-  fill_block_header_response(last_block, is_orphaned, last_block_height, last_block_hash, res.block_header);
+  fill_block_header_response(last_block_header, last_block_height, last_block_hash, res.block_header);
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
@@ -1516,15 +1744,13 @@ bool RpcServer::on_get_block_header_by_height(const COMMAND_RPC_GET_BLOCK_HEADER
   }
 
   Hash block_hash = m_core.getBlockIdByHeight(req.height);
-  Block blk;
-  if (!m_core.getBlockByHash(block_hash, blk)) {
+  BlockHeaderColumns::Header header;
+  if (!m_core.getBlockHeader(req.height, header)) {
     throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
       "Internal error: can't get block by height. Height = " + std::to_string(req.height) + '.' };
   }
 
-  crypto::Hash tmp_hash = m_core.getBlockIdByHeight(req.height);
-  bool is_orphaned = block_hash != tmp_hash;
-  fill_block_header_response(blk, is_orphaned, req.height, block_hash, res.block_header);
+  fill_block_header_response(header, req.height, block_hash, res.block_header);
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
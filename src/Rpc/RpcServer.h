@@ -6,13 +6,18 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "HttpServer.h"
+#include "RpcResponseCache.h"
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <unordered_map>
 
 #include <Logging/LoggerRef.h>
 #include "Common/Math.h"
 #include "CoreRpcServerCommandsDefinitions.h"
+#include "CryptoNoteCore/BlockHeaderColumns.h"
+#include "CryptoNoteCore/ICoreObserver.h"
 
 namespace cn {
 
@@ -20,9 +25,10 @@ class core;
 class NodeServer;
 class ICryptoNoteProtocolQuery;
 
-class RpcServer : public HttpServer {
+class RpcServer : public HttpServer, public ICoreObserver {
 public:
   RpcServer(platform_system::Dispatcher& dispatcher, logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery);
+  ~RpcServer();
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
   bool setFeeAddress(const std::string& fee_address, const AccountPublicAddress& fee_acc);
   bool setViewKey(const std::string& view_key);
@@ -32,6 +38,10 @@ public:
   bool remotenode_check_incoming_tx(const BinaryArray& tx_blob);
   bool enableCors(const std::string& domain);
   std::string getCorsDomain() const;
+  // Memory for cached answers of hot read only requests, 0 disables the cache
+  void setResponseCacheSize(size_t size);
+  // How long a long polling getblocktemplate request waits for its template to be outdated
+  void setBlockTemplateLongPollTimeout(std::chrono::milliseconds timeout);
 
 private:
 
@@ -39,6 +49,8 @@ private:
   struct RpcHandler {
     const Handler handler;
     const bool allowBusyCore;
+    const bool concurrent; // only reads the core, may run on an HTTP worker thread
+    const RpcResponseCache::Policy cache;
   };
 
   typedef void (RpcServer::*HandlerPtr)(const HttpRequest& request, HttpResponse& response);
@@ -48,11 +60,21 @@ private:
   bool processJsonRpcRequest(const HttpRequest& request, HttpResponse& response);
   bool isCoreReady();
 
+  // ICoreObserver
+  void blockchainUpdated() override;
+  void poolUpdated() override;
+
+  void notifyTemplateWaiters();
+  void waitForTemplateChange(const std::string& templateId, uint64_t poolDelta);
+  static std::string makeTemplateId(const crypto::Hash& tail, uint64_t poolSize);
+  static bool parseTemplateId(const std::string& templateId, crypto::Hash& tail, uint64_t& poolSize);
+
   // binary handlers
   bool on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res);
   bool on_query_blocks(const COMMAND_RPC_QUERY_BLOCKS::request& req, COMMAND_RPC_QUERY_BLOCKS::response& res);
   bool on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::request& req, COMMAND_RPC_QUERY_BLOCKS_LITE::response& res);
   bool on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response& res);
+  bool on_get_indexes_batch(const COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TXS_GLOBAL_OUTPUTS_INDEXES::response& res);
   bool on_get_random_outs_bin(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res);
   bool onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& req, COMMAND_RPC_GET_POOL_CHANGES::response& rsp);
   bool onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::request& req, COMMAND_RPC_GET_POOL_CHANGES_LITE::response& rsp);
@@ -85,6 +107,7 @@ private:
   bool on_get_transactions_pool_raw(const COMMAND_RPC_GET_RAW_TRANSACTIONS_POOL::request& req, COMMAND_RPC_GET_RAW_TRANSACTIONS_POOL::response& res);
 
   void fill_block_header_response(const Block& blk, bool orphan_status, uint32_t height, const crypto::Hash& hash, block_header_response& responce);
+  void fill_block_header_response(const BlockHeaderColumns::Header& header, uint32_t height, const crypto::Hash& hash, block_header_response& responce);
 
   bool f_on_blocks_list_json(const F_COMMAND_RPC_GET_BLOCKS_LIST::request& req, F_COMMAND_RPC_GET_BLOCKS_LIST::response& res);
   bool f_on_block_json(const F_COMMAND_RPC_GET_BLOCK_DETAILS::request& req, F_COMMAND_RPC_GET_BLOCK_DETAILS::response& res);
@@ -103,6 +126,15 @@ private:
   std::string m_fee_address;
   crypto::SecretKey m_view_key = NULL_SECRET_KEY;
   AccountPublicAddress m_fee_acc; 
+
+  // long polling getblocktemplate requests sleep on this event, core notifications from any thread
+  // are posted to the dispatcher only while somebody is waiting
+  platform_system::Event m_templateChanged;
+  std::atomic<size_t> m_templateWaiters;
+  std::atomic<bool> m_templateNotifyPending;
+  std::chrono::milliseconds m_templateLongPollTimeout;
+
+  RpcResponseCache m_responseCache;
 };
 
 }
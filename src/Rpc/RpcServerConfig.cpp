@@ -16,13 +16,24 @@ namespace cn {
     const std::string DEFAULT_RPC_IP = "127.0.0.1";
     const uint16_t DEFAULT_RPC_PORT = RPC_DEFAULT_PORT;
 
+    const size_t DEFAULT_RPC_THREADS = 2;
+    const size_t DEFAULT_RPC_MAX_CONCURRENT_REQUESTS = 64;
+    const size_t DEFAULT_RPC_CACHE_SIZE = 32;
+    const size_t DEFAULT_RPC_MAX_REQUEST_SIZE = 16;
+
     const command_line::arg_descriptor<std::string> arg_rpc_bind_ip = { "rpc-bind-ip", "", DEFAULT_RPC_IP };
     const command_line::arg_descriptor<uint16_t> arg_rpc_bind_port = { "rpc-bind-port", "", DEFAULT_RPC_PORT };
     const command_line::arg_descriptor<std::string> arg_enable_cors = { "enable-cors", "Adds header 'Access-Control-Allow-Origin' to the daemon's RPC responses. Uses the value as domain. Use * for all", "" };
+    const command_line::arg_descriptor<size_t> arg_rpc_threads = { "rpc-threads", "Threads that run the handlers of read only RPC requests, connections stay on the network thread; 0 runs the handlers there too", DEFAULT_RPC_THREADS };
+    const command_line::arg_descriptor<size_t> arg_rpc_max_concurrent_requests = { "rpc-max-concurrent-requests", "Read only RPC requests processed at once, further ones wait", DEFAULT_RPC_MAX_CONCURRENT_REQUESTS };
+    const command_line::arg_descriptor<size_t> arg_rpc_max_request_size = { "rpc-max-request-size", "Largest RPC request body in MB, larger requests are refused", DEFAULT_RPC_MAX_REQUEST_SIZE };
+    const command_line::arg_descriptor<size_t> arg_rpc_cache_size = { "rpc-cache-size", "Memory in MB for cached answers of frequent read only RPC requests, 0 disables the cache", DEFAULT_RPC_CACHE_SIZE };
   }
 
 
-  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT), enableCors("") {
+  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT), enableCors(""),
+    threads(DEFAULT_RPC_THREADS), maxConcurrentRequests(DEFAULT_RPC_MAX_CONCURRENT_REQUESTS),
+    maxRequestSize(DEFAULT_RPC_MAX_REQUEST_SIZE), cacheSize(DEFAULT_RPC_CACHE_SIZE) {
   }
 
   std::string RpcServerConfig::getBindAddress() const {
@@ -33,6 +44,10 @@ namespace cn {
     command_line::add_arg(desc, arg_rpc_bind_ip);
     command_line::add_arg(desc, arg_rpc_bind_port);
     command_line::add_arg(desc, arg_enable_cors);
+    command_line::add_arg(desc, arg_rpc_threads);
+    command_line::add_arg(desc, arg_rpc_max_concurrent_requests);
+    command_line::add_arg(desc, arg_rpc_max_request_size);
+    command_line::add_arg(desc, arg_rpc_cache_size);
   }
 
   void RpcServerConfig::init(const boost::program_options::variables_map &vm)
@@ -51,5 +66,9 @@ namespace cn {
       }
     }
     enableCors = command_line::get_arg(vm, arg_enable_cors);
+    threads = command_line::get_arg(vm, arg_rpc_threads);
+    maxConcurrentRequests = command_line::get_arg(vm, arg_rpc_max_concurrent_requests);
+    maxRequestSize = command_line::get_arg(vm, arg_rpc_max_request_size);
+    cacheSize = command_line::get_arg(vm, arg_rpc_cache_size);
   }
 }
@@ -24,6 +24,10 @@ public:
   std::string bindIp;
   uint16_t bindPort;
   std::string enableCors;
+  size_t threads;
+  size_t maxConcurrentRequests;
+  size_t maxRequestSize; // MB
+  size_t cacheSize; // MB
 };
 
 }
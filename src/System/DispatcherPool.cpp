@@ -0,0 +1,300 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "DispatcherPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <future>
+#include <thread>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+
+namespace platform_system {
+
+namespace {
+
+const size_t QUEUE_CAPACITY = 1024;
+
+// Bounded queue of procedures that any thread may push to and pop from without a lock. Every cell
+// carries a sequence number telling whether it is free for the push or filled for the pop at a
+// given position.
+class WorkQueue {
+public:
+  explicit WorkQueue(size_t capacity) : cells(new Cell[capacity]), mask(capacity - 1), pushPosition(0), popPosition(0) {
+    assert((capacity & mask) == 0);
+    for (size_t i = 0; i < capacity; ++i) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Leaves the procedure untouched if the queue is full
+  bool push(std::function<void(Dispatcher&)>& procedure) {
+    size_t position = pushPosition.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells[position & mask];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < position) {
+        return false;
+      } else {
+        position = pushPosition.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->procedure = std::move(procedure);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(std::function<void(Dispatcher&)>& procedure) {
+    size_t position = popPosition.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells[position & mask];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      if (sequence == position + 1) {
+        if (popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < position + 1) {
+        return false;
+      } else {
+        position = popPosition.load(std::memory_order_relaxed);
+      }
+    }
+
+    procedure = std::move(cell->procedure);
+    cell->procedure = nullptr;
+    cell->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    std::function<void(Dispatcher&)> procedure;
+  };
+
+  std::unique_ptr<Cell[]> cells;
+  const size_t mask;
+  std::atomic<size_t> pushPosition;
+  std::atomic<size_t> popPosition;
+};
+
+}
+
+struct DispatcherPool::Worker {
+  Worker() : queue(QUEUE_CAPACITY), load(0), idle(false), stopped(false), dispatcher(nullptr), wakeEvent(nullptr), contexts(nullptr) {
+  }
+
+  WorkQueue queue;
+  // queued and running procedures
+  std::atomic<size_t> load;
+  // set while the worker waits for wakeEvent, whoever clears it sets the event
+  std::atomic<bool> idle;
+  // set on the thread of the worker, so the dispatcher outlives the remote spawn that stops it
+  bool stopped;
+  Dispatcher* dispatcher;
+  Event* wakeEvent;
+  ContextGroup* contexts;
+  std::thread thread;
+};
+
+DispatcherPool::DispatcherPool(size_t threadCount) {
+  std::vector<std::promise<void>> started(std::max<size_t>(threadCount, 1));
+  for (size_t i = 0; i < started.size(); ++i) {
+    workers.emplace_back(new Worker);
+  }
+
+  for (size_t i = 0; i < workers.size(); ++i) {
+    std::promise<void>* workerStarted = &started[i];
+    Worker* worker = workers[i].get();
+    worker->thread = std::thread([this, worker, workerStarted] {
+      std::unique_ptr<Dispatcher> dispatcher;
+      try {
+        dispatcher.reset(new Dispatcher);
+      } catch (...) {
+        workerStarted->set_exception(std::current_exception());
+        return;
+      }
+
+      Event wakeEvent(*dispatcher);
+      {
+        ContextGroup contexts(*dispatcher);
+        worker->dispatcher = dispatcher.get();
+        worker->wakeEvent = &wakeEvent;
+        worker->contexts = &contexts;
+        workerStarted->set_value();
+        workerLoop(*worker);
+        contexts.interrupt();
+        contexts.wait();
+        worker->contexts = nullptr;
+      }
+
+      // wakes still on their way run in the destructor and need the event
+      dispatcher.reset();
+    });
+  }
+
+  std::exception_ptr error;
+  for (auto& workerStarted : started) {
+    try {
+      workerStarted.get_future().get();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+
+  if (error) {
+    stop();
+    std::rethrow_exception(error);
+  }
+}
+
+DispatcherPool::~DispatcherPool() {
+  stop();
+}
+
+size_t DispatcherPool::size() const {
+  return workers.size();
+}
+
+void DispatcherPool::spawn(std::function<void(Dispatcher&)>&& procedure) {
+  Worker* target = workers.front().get();
+  for (auto& worker : workers) {
+    if (worker->load.load(std::memory_order_relaxed) < target->load.load(std::memory_order_relaxed)) {
+      target = worker.get();
+    }
+  }
+
+  ++target->load;
+  if (!target->queue.push(procedure)) {
+    // past the queue the procedure goes straight to the dispatcher and can not be taken by another one
+    std::function<void(Dispatcher&)> overflow = std::move(procedure);
+    target->dispatcher->remoteSpawn([this, target, overflow]() mutable {
+      start(*target, std::move(overflow));
+    });
+
+    return;
+  }
+
+  // a busy target leaves the procedure to the first idle worker
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  Worker* sleeper = nullptr;
+  if (target->idle.exchange(false)) {
+    sleeper = target;
+  } else {
+    for (auto& worker : workers) {
+      if (worker->idle.exchange(false)) {
+        sleeper = worker.get();
+        break;
+      }
+    }
+  }
+
+  if (sleeper != nullptr) {
+    wake(*sleeper);
+  }
+}
+
+size_t DispatcherPool::defaultThreadCount() {
+  return std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+}
+
+void DispatcherPool::workerLoop(Worker& worker) {
+  std::function<void(Dispatcher&)> procedure;
+  while (!worker.stopped) {
+    bool found = take(worker, procedure);
+    if (!found) {
+      // the queues are looked at again after idle is set, a procedure queued in between is not missed
+      worker.idle = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      found = take(worker, procedure);
+      if (!found && !worker.stopped) {
+        worker.wakeEvent->wait();
+      }
+
+      worker.wakeEvent->clear();
+      worker.idle = false;
+    }
+
+    if (found) {
+      start(worker, std::move(procedure));
+      worker.dispatcher->yield();
+    }
+  }
+}
+
+bool DispatcherPool::take(Worker& worker, std::function<void(Dispatcher&)>& procedure) {
+  if (worker.queue.pop(procedure)) {
+    return true;
+  }
+
+  for (auto& other : workers) {
+    if (other.get() != &worker && other->queue.pop(procedure)) {
+      --other->load;
+      ++worker.load;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void DispatcherPool::wake(Worker& worker) {
+  Event* wakeEvent = worker.wakeEvent;
+  worker.dispatcher->remoteSpawn([wakeEvent] { wakeEvent->set(); });
+}
+
+void DispatcherPool::stop() {
+  for (auto& worker : workers) {
+    if (worker->dispatcher != nullptr) {
+      Worker* stoppedWorker = worker.get();
+      worker->dispatcher->remoteSpawn([stoppedWorker] {
+        stoppedWorker->stopped = true;
+        stoppedWorker->wakeEvent->set();
+      });
+    }
+  }
+
+  for (auto& worker : workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+
+  workers.clear();
+}
+
+void DispatcherPool::start(Worker& worker, std::function<void(Dispatcher&)>&& procedure) {
+  if (worker.contexts == nullptr) {
+    // an overflowed procedure that arrives after the pool stopped
+    --worker.load;
+    return;
+  }
+
+  Dispatcher* dispatcher = worker.dispatcher;
+  std::atomic<size_t>* load = &worker.load;
+  std::function<void(Dispatcher&)> started = std::move(procedure);
+  worker.contexts->spawn([dispatcher, load, started] {
+    try {
+      started(*dispatcher);
+    } catch (...) {
+      --*load;
+      throw;
+    }
+
+    --*load;
+  });
+}
+
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace platform_system {
+
+class Dispatcher;
+
+// Runs a dispatcher on each of several threads. A spawned procedure is queued on the least loaded
+// dispatcher, dispatchers without work take the queued procedures of busy ones. Once started a
+// procedure runs as a context of the dispatcher that took it and stays on its thread until it returns,
+// so it may use any object bound to that dispatcher.
+class DispatcherPool {
+public:
+  explicit DispatcherPool(size_t threadCount);
+  DispatcherPool(const DispatcherPool&) = delete;
+  // Interrupts the running procedures and waits for them, queued procedures are dropped
+  ~DispatcherPool();
+  DispatcherPool& operator=(const DispatcherPool&) = delete;
+
+  size_t size() const;
+  // May be called from any thread
+  void spawn(std::function<void(Dispatcher&)>&& procedure);
+
+  // One thread per hardware thread
+  static size_t defaultThreadCount();
+
+private:
+  struct Worker;
+
+  void workerLoop(Worker& worker);
+  bool take(Worker& worker, std::function<void(Dispatcher&)>& procedure);
+  void start(Worker& worker, std::function<void(Dispatcher&)>&& procedure);
+  void wake(Worker& worker);
+  void stop();
+
+  std::vector<std::unique_ptr<Worker>> workers;
+};
+
+}
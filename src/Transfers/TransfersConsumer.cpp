@@ -195,7 +195,9 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
     const ITransactionReader* tx;
   };
 
-  struct PreprocessedTx : Tx, PreprocessInfo {};
+  struct PreprocessedTx : Tx, PreprocessInfo {
+    OwnOutputs ownOutputs;
+  };
 
   std::vector<PreprocessedTx> preprocessedTransactions;
   std::mutex preprocessedTransactionsMutex;
@@ -243,26 +245,20 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
     inputQueue.close();
   });
 
+  // workers only find our outputs, their global indices are then requested for the whole batch at once
   auto processingFunction = [&] {
     Tx item;
-    std::error_code ec;
     while (!stopProcessing && inputQueue.pop(item)) {
       PreprocessedTx output;
       static_cast<Tx&>(output) = item;
-
-      ec = preprocessOutputs(item.blockInfo, *item.tx, output);
-      if (ec) {
-        stopProcessing = true;
-        break;
-      }
+      findOwnOutputs(*item.tx, output.ownOutputs);
 
       std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
       preprocessedTransactions.push_back(std::move(output));
     }
-    return ec;
   };
 
-  std::vector<std::future<std::error_code>> processingThreads;
+  std::vector<std::future<void>> processingThreads;
   for (size_t i = 0; i < workers; ++i) {
     processingThreads.push_back(std::async(std::launch::async, processingFunction));
   }
@@ -270,26 +266,49 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
   std::error_code processingError;
   for (auto& f : processingThreads) {
     try {
-      std::error_code ec = f.get();
-      if (!processingError && ec) {
-        processingError = ec;
-      }
+      f.get();
     } catch (const std::system_error& e) {
+      stopProcessing = true;
       processingError = e.code();
     } catch (const std::exception&) {
+      stopProcessing = true;
       processingError = std::make_error_code(std::errc::operation_canceled);
     }
   }
 
+  // sort by block height and transaction index in block
+  std::sort(preprocessedTransactions.begin(), preprocessedTransactions.end(), [](const PreprocessedTx& a, const PreprocessedTx& b) {
+    return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex) < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
+  });
+
+  std::vector<crypto::Hash> ownTransactionHashes;
+  for (const auto& tx : preprocessedTransactions) {
+    if (!tx.ownOutputs.empty()) {
+      ownTransactionHashes.push_back(tx.tx->getTransactionHash());
+    }
+  }
+
+  if (!processingError && !ownTransactionHashes.empty()) {
+    std::vector<std::vector<uint32_t>> globalIndices;
+    processingError = getGlobalIndices(ownTransactionHashes, globalIndices);
+
+    auto indices = globalIndices.begin();
+    for (auto& tx : preprocessedTransactions) {
+      if (processingError) {
+        break;
+      }
+
+      if (!tx.ownOutputs.empty()) {
+        tx.globalIdxs = std::move(*indices++);
+        processingError = createOwnTransfers(tx.blockInfo, *tx.tx, tx.ownOutputs, tx);
+      }
+    }
+  }
+
   std::vector<crypto::Hash> blockHashes = getBlockHashes(blocks, count);
   if (!processingError) {
     m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-    // sort by block height and transaction index in block
-    std::sort(preprocessedTransactions.begin(), preprocessedTransactions.end(), [](const PreprocessedTx& a, const PreprocessedTx& b) {
-      return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex) < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-    });
-
     for (const auto& tx : preprocessedTransactions) {
       processTransaction(tx.blockInfo, *tx.tx, tx);
     }
@@ -479,29 +498,38 @@ std::error_code createTransfers(
   return std::error_code();
 }
 
-std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info) {
-  std::unordered_map<PublicKey, std::vector<uint32_t>> outputs;
-   try {
+void TransfersConsumer::findOwnOutputs(const ITransactionReader& tx, OwnOutputs& outputs) {
+  try {
     findMyOutputs(tx, m_viewSecret, m_spendKeys, outputs);
   }
   catch (const std::exception& e) {
     m_logger(ERROR, BRIGHT_RED) << "Failed to process transaction: " << e.what() << ", transaction hash " << common::podToHex(tx.getTransactionHash());
-    return std::error_code();
+    outputs.clear();
   }
-	
+}
+
+std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info) {
+  OwnOutputs outputs;
+  findOwnOutputs(tx, outputs);
   if (outputs.empty()) {
     return std::error_code();
   }
 
-  std::error_code errorCode;
-  auto txHash = tx.getTransactionHash();
   if (blockInfo.height != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT) {
-    errorCode = getGlobalIndices(reinterpret_cast<const Hash&>(txHash), info.globalIdxs);
+    std::vector<std::vector<uint32_t>> globalIdxs;
+    std::error_code errorCode = getGlobalIndices({ tx.getTransactionHash() }, globalIdxs);
     if (errorCode) {
       return errorCode;
     }
+
+    info.globalIdxs = std::move(globalIdxs.front());
   }
 
+  return createOwnTransfers(blockInfo, tx, outputs, info);
+}
+
+std::error_code TransfersConsumer::createOwnTransfers(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, const OwnOutputs& outputs, PreprocessInfo& info) {
+  std::error_code errorCode;
   for (const auto& kv : outputs) {
     auto it = m_subscriptions.find(kv.first);
     if (it != m_subscriptions.end()) {
@@ -577,7 +605,7 @@ void TransfersConsumer::processOutputs(const TransactionBlockInfo& blockInfo, Tr
   }
 }
 
-std::error_code TransfersConsumer::getGlobalIndices(const Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices) {  
+std::error_code TransfersConsumer::getGlobalIndices(const std::vector<Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices) {
   std::promise<std::error_code> prom;
   std::future<std::error_code> f = prom.get_future();
 
@@ -587,9 +615,14 @@ std::error_code TransfersConsumer::getGlobalIndices(const Hash& transactionHash,
   };
 
   outsGlobalIndices.clear();
-  m_node.getTransactionOutsGlobalIndices(transactionHash, outsGlobalIndices, cb);
+  m_node.getTransactionsOutsGlobalIndices(transactionHashes, outsGlobalIndices, cb);
+
+  std::error_code ec = f.get();
+  if (!ec && outsGlobalIndices.size() != transactionHashes.size()) {
+    ec = std::make_error_code(std::errc::bad_message);
+  }
 
-  return f.get();
+  return ec;
 }
 
 }
\ No newline at end of file
@@ -61,13 +61,18 @@ private:
     std::vector<uint32_t> globalIdxs;
   };
 
+  // map { spend public key -> indices of its outputs in the transaction }
+  typedef std::unordered_map<crypto::PublicKey, std::vector<uint32_t>> OwnOutputs;
+
+  void findOwnOutputs(const ITransactionReader& tx, OwnOutputs& outputs);
   std::error_code preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info);
+  std::error_code createOwnTransfers(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, const OwnOutputs& outputs, PreprocessInfo& info);
   std::error_code processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx);
   void processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, const PreprocessInfo& info);
   void processOutputs(const TransactionBlockInfo& blockInfo, TransfersSubscription& sub, const ITransactionReader& tx,
     const std::vector<TransactionOutputInformationIn>& outputs, const std::vector<uint32_t>& globalIdxs, bool& contains, bool& updated);
 
-  std::error_code getGlobalIndices(const crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices);
+  std::error_code getGlobalIndices(const std::vector<crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices);
 
   void updateSyncStart();
 
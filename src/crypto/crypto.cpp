@@ -13,6 +13,8 @@
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/Varint.h"
 #include "crypto.h"
@@ -589,4 +591,82 @@ void crypto_ops::generate_tx_proof(const Hash &prefix_hash, const PublicKey &R,
     sc_sub(reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&sum));
     return sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) == 0;
   }
+
+  namespace {
+    struct ring_key_precomp {
+      bool valid;
+      ge_dsmp key;   /* P, 3P, 5P, ..., 15P */
+      ge_dsmp point; /* Hp(P), 3Hp(P), 5Hp(P), ..., 15Hp(P) */
+    };
+
+    class ring_key_cache {
+    public:
+      const ring_key_precomp &get(const PublicKey &pub) {
+        auto it = indexes.find(pub);
+        if (it != indexes.end()) {
+          return precomps[it->second];
+        }
+        indexes.emplace(pub, precomps.size());
+        precomps.emplace_back();
+        ring_key_precomp &pre = precomps.back();
+        ge_p3 tmp3;
+        pre.valid = ge_frombytes_vartime(&tmp3, reinterpret_cast<const unsigned char*>(&pub)) == 0;
+        if (pre.valid) {
+          ge_dsm_precomp(pre.key, &tmp3);
+          hash_to_ec(pub, tmp3);
+          ge_dsm_precomp(pre.point, &tmp3);
+        }
+        return pre;
+      }
+
+    private:
+      std::unordered_map<PublicKey, size_t> indexes;
+      std::vector<ring_key_precomp> precomps;
+    };
+  }
+
+  void crypto_ops::check_ring_signatures(const RingSignatureBatchItem *items, size_t count, bool *results) {
+    ring_key_cache keys;
+    std::vector<unsigned char> comm;
+    for (size_t n = 0; n < count; n++) {
+      const RingSignatureBatchItem &item = items[n];
+      const Signature *sig = item.sig;
+      ge_p3 image_unp;
+      ge_dsmp image_pre;
+      EllipticCurveScalar sum, h;
+      results[n] = false;
+      if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char*>(item.image)) != 0) {
+        continue;
+      }
+      ge_dsm_precomp(image_pre, &image_unp);
+      if (comm.size() < rs_comm_size(item.pubsCount)) {
+        comm.resize(rs_comm_size(item.pubsCount));
+      }
+      rs_comm *const buf = reinterpret_cast<rs_comm *>(comm.data());
+      sc_0(reinterpret_cast<unsigned char*>(&sum));
+      buf->h = *item.prefixHash;
+      size_t i;
+      for (i = 0; i < item.pubsCount; i++) {
+        ge_p2 tmp2;
+        if (sc_check(reinterpret_cast<const unsigned char*>(&sig[i])) != 0 || sc_check(reinterpret_cast<const unsigned char*>(&sig[i]) + 32) != 0) {
+          break;
+        }
+        const ring_key_precomp &pre = keys.get(*item.pubs[i]);
+        if (!pre.valid) {
+          break;
+        }
+        ge_double_scalarmult_base_precomp_vartime(&tmp2, reinterpret_cast<const unsigned char*>(&sig[i]), pre.key, reinterpret_cast<const unsigned char*>(&sig[i]) + 32);
+        ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].a), &tmp2);
+        ge_double_scalarmult_precomp2_vartime(&tmp2, reinterpret_cast<const unsigned char*>(&sig[i]) + 32, pre.point, reinterpret_cast<const unsigned char*>(&sig[i]), image_pre);
+        ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].b), &tmp2);
+        sc_add(reinterpret_cast<unsigned char*>(&sum), reinterpret_cast<unsigned char*>(&sum), reinterpret_cast<const unsigned char*>(&sig[i]));
+      }
+      if (i != item.pubsCount) {
+        continue;
+      }
+      hash_to_scalar(buf, rs_comm_size(item.pubsCount), h);
+      sc_sub(reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&sum));
+      results[n] = sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) == 0;
+    }
+  }
 }
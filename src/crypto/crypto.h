@@ -26,6 +26,16 @@ namespace crypto {
 
   extern std::mutex random_lock;
 
+  /* One ring signature of a batch given to check_ring_signatures.
+   */
+  struct RingSignatureBatchItem {
+    const Hash *prefixHash;
+    const KeyImage *image;
+    const PublicKey *const *pubs;
+    size_t pubsCount;
+    const Signature *sig;
+  };
+
   class crypto_ops {
     crypto_ops();
     crypto_ops(const crypto_ops &);
@@ -85,6 +95,9 @@ namespace crypto {
 
     friend bool check_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const Signature *);
+
+    static void check_ring_signatures(const RingSignatureBatchItem *, size_t, bool *);
+    friend void check_ring_signatures(const RingSignatureBatchItem *, size_t, bool *);
   };
 
   /* Generate a value filled with random bytes.
@@ -264,6 +277,14 @@ namespace crypto {
     return check_ring_signature(prefix_hash, image, pubs.data(), pubs.size(), sig);
   }
 
+  /* Check a batch of ring signatures, results[i] receives the outcome of items[i].
+   * Public keys shared by several rings of the batch are decompressed and hashed to the curve once.
+   * Unlike check_ring_signature, an invalid public key only fails the signatures using it.
+   */
+  inline void check_ring_signatures(const RingSignatureBatchItem *items, size_t count, bool *results) {
+    crypto_ops::check_ring_signatures(items, count, results);
+  }
+
   static inline const SecretKey &EllipticCurveScalar2SecretKey(const EllipticCurveScalar &k) { return (const SecretKey &)k; }
 }
 
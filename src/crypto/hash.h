@@ -13,6 +13,7 @@
 #include "generic-ops.h"
 #include <boost/align/aligned_alloc.hpp>
 #include "pow_hash/cn_slow_hash.hpp"
+#include "scratchpad_pool.hpp"
 
 /* Standard Cryptonight */
 #define CN_PAGE_SIZE                    2097152
@@ -44,19 +45,22 @@ namespace crypto {
     return h;
   }
 
+  // The scratchpad comes from the process wide pool and is shared by all the slow hash variants
   class cn_context {
+    static_assert(CN_PAGE_SIZE == scratchpad_pool::page_size, "Scratchpad pool pages must hold a CryptoNight scratchpad");
+
   public:
 
-    cn_context()
+    cn_context() :
+        long_state((uint8_t*)scratchpad_pool::instance().acquire()),
+        hash_state((uint8_t*)boost::alignment::aligned_alloc(4096, 4096)),
+        cn_gpu_state(cn_v3_hash_t::make_borrowed(long_state, hash_state))
     {
-        long_state = (uint8_t*)boost::alignment::aligned_alloc(4096, CN_PAGE_SIZE);
-        hash_state = (uint8_t*)boost::alignment::aligned_alloc(4096, 4096);
     }
 
     ~cn_context()
     {
-        if(long_state != nullptr)
-            boost::alignment::aligned_free(long_state);
+        scratchpad_pool::instance().release(long_state);
         if(hash_state != nullptr)
             boost::alignment::aligned_free(hash_state);
     }
@@ -64,9 +68,9 @@ namespace crypto {
     cn_context(const cn_context &) = delete;
     void operator=(const cn_context &) = delete;
 
-    cn_v3_hash_t cn_gpu_state;
     uint8_t* long_state = nullptr;
     uint8_t* hash_state = nullptr;
+    cn_v3_hash_t cn_gpu_state;
   };
 
   void cn_slow_hash_v0(cn_context &context, const void *data, size_t length, Hash &hash);
@@ -181,6 +181,12 @@ class cn_slow_hash
 		return cn_pow_hash_v3(t.lpad.as_void(), t.spad.as_void());
 	}
 
+	// Hashes in scratchpads owned by the caller, which must outlive the returned object
+	static cn_slow_hash make_borrowed(void* lptr, void* sptr)
+	{
+		return cn_slow_hash(lptr, sptr);
+	}
+
 	cn_slow_hash& operator=(cn_slow_hash&& other) noexcept
 	{
 		if(this == &other)
@@ -0,0 +1,121 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "scratchpad_pool.hpp"
+
+#include <stdint.h>
+#include <new>
+
+#include <boost/align/aligned_alloc.hpp>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace crypto {
+
+  scratchpad_pool& scratchpad_pool::instance() {
+    // never destroyed, contexts living in static objects may release their pages at exit
+    static scratchpad_pool* pool = new scratchpad_pool();
+    return *pool;
+  }
+
+  scratchpad_pool::scratchpad_pool() : m_huge_pages(true) {
+  }
+
+  void* scratchpad_pool::acquire() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_idle.empty()) {
+      void* page = m_idle.back();
+      m_idle.pop_back();
+      return page;
+    }
+
+    bool mapped;
+    void* page = allocate(mapped);
+    m_mapped[page] = mapped;
+    return page;
+  }
+
+  void scratchpad_pool::release(void* page) {
+    if (page == nullptr) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_idle.size() < max_idle_pages) {
+      m_idle.push_back(page);
+      return;
+    }
+
+    auto it = m_mapped.find(page);
+    deallocate(page, it->second);
+    m_mapped.erase(it);
+  }
+
+  void scratchpad_pool::set_huge_pages(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_huge_pages = enabled;
+    for (void* page : m_idle) {
+      auto it = m_mapped.find(page);
+      deallocate(page, it->second);
+      m_mapped.erase(it);
+    }
+
+    m_idle.clear();
+  }
+
+  bool scratchpad_pool::huge_pages() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_huge_pages;
+  }
+
+  void* scratchpad_pool::allocate(bool& mapped) {
+#if defined(__linux__)
+    if (m_huge_pages) {
+      mapped = true;
+      void* page = mmap(nullptr, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (page != MAP_FAILED) {
+        return page;
+      }
+
+      // no huge pages reserved, map twice the size to cut a 2 MB aligned page out of it
+      uint8_t* area = static_cast<uint8_t*>(mmap(nullptr, 2 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      if (area != MAP_FAILED) {
+        uint8_t* aligned = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(area) + page_size - 1) & ~(uintptr_t)(page_size - 1));
+        if (aligned != area) {
+          munmap(area, aligned - area);
+        }
+
+        munmap(aligned + page_size, area + page_size - aligned);
+#if defined(MADV_HUGEPAGE)
+        madvise(aligned, page_size, MADV_HUGEPAGE);
+#endif
+        return aligned;
+      }
+    }
+#endif
+
+    mapped = false;
+    void* page = boost::alignment::aligned_alloc(4096, page_size);
+    if (page == nullptr) {
+      throw std::bad_alloc();
+    }
+
+    return page;
+  }
+
+  void scratchpad_pool::deallocate(void* page, bool mapped) {
+#if defined(__linux__)
+    if (mapped) {
+      munmap(page, page_size);
+      return;
+    }
+#endif
+
+    boost::alignment::aligned_free(page);
+  }
+
+}
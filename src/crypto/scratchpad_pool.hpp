@@ -0,0 +1,46 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+//
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stddef.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace crypto {
+
+  // Process wide pool of the 2 MB scratchpads the slow hashes work in. A page comes from the reserved
+  // huge pages (MAP_HUGETLB) if there are any, else from a mapping advised for transparent huge pages,
+  // else from the heap. Released pages are kept for the next context, so miner threads, block checks
+  // and wallet key derivations stop mapping and faulting in fresh memory for every hash.
+  class scratchpad_pool {
+  public:
+    static const size_t page_size = 2097152;
+
+    static scratchpad_pool& instance();
+
+    void* acquire();
+    void release(void* page);
+
+    // Turning huge pages on or off drops the idle pages, later acquisitions follow the new setting
+    void set_huge_pages(bool enabled);
+    bool huge_pages() const;
+
+  private:
+    scratchpad_pool();
+
+    void* allocate(bool& mapped);
+    void deallocate(void* page, bool mapped);
+
+    static const size_t max_idle_pages = 16;
+
+    mutable std::mutex m_mutex;
+    bool m_huge_pages;
+    std::vector<void*> m_idle;
+    std::unordered_map<void*, bool> m_mapped; // every page handed out or idle, true if it was mapped
+  };
+
+}
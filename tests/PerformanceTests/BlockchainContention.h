@@ -0,0 +1,175 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/IBlock.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteCore/VerificationContext.h"
+#include "Logging/LoggerGroup.h"
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+
+#include "../TestGenerator/TestGenerator.h"
+#include "PerformanceUtils.h"
+
+// Readers issue what /getblocks.bin and /getrandom_outs.bin do in the core while the main thread imports blocks
+template<size_t reader_count>
+class test_blockchain_contention
+{
+public:
+  static const size_t loop_count = 5;
+  static const size_t initial_blocks = 400;
+  static const size_t blocks_per_call = 20;
+  static const size_t queries_per_reader = 200;
+
+  test_blockchain_contention() : m_currency(cn::CurrencyBuilder(m_logger).currency()), m_generator(m_currency), m_imported(0)
+  {
+  }
+
+  ~test_blockchain_contention()
+  {
+    if (m_core)
+    {
+      m_core->deinit();
+      m_core.reset();
+    }
+
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+  bool init()
+  {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    if (!boost::filesystem::create_directories(m_directory))
+      return false;
+
+    cn::CoreConfig coreConfig;
+    coreConfig.configFolder = m_directory.string();
+    m_core.reset(new cn::core(m_currency, nullptr, m_logger));
+    if (!m_core->init(coreConfig, cn::MinerConfig(), false))
+      return false;
+
+    m_miner.generate();
+    cn::Block previous = m_currency.genesisBlock();
+    std::vector<size_t> blockSizes;
+    m_generator.addBlock(previous, 0, 0, blockSizes, 0);
+    for (size_t i = 0; i < initial_blocks + loop_count * blocks_per_call; ++i)
+    {
+      uint32_t height = cn::get_block_height(previous) + 1;
+      uint8_t majorVersion = height > m_currency.upgradeHeight(cn::BLOCK_MAJOR_VERSION_2) ? cn::BLOCK_MAJOR_VERSION_2 : cn::BLOCK_MAJOR_VERSION_1;
+      cn::Block block;
+      if (!m_generator.constructBlockManually(block, previous, m_miner, test_generator::bf_major_ver, majorVersion))
+        return false;
+
+      if (m_amounts.empty())
+      {
+        for (const auto &out : block.baseTransaction.outputs)
+        {
+          m_amounts.push_back(out.amount);
+        }
+      }
+
+      m_blocks.push_back(cn::toBinaryArray(block));
+      previous = block;
+    }
+
+    return importBlocks(initial_blocks);
+  }
+
+  bool test()
+  {
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < reader_count; ++i)
+    {
+      readers.emplace_back([this, i, &failed] {
+        reset_thread_affinity();
+        std::mt19937 generator(static_cast<uint32_t>(i));
+        for (size_t j = 0; j < queries_per_reader; ++j)
+        {
+          if (!(j % 2 == 0 ? getBlocks(generator) : getRandomOuts()))
+            failed = true;
+        }
+      });
+    }
+
+    bool imported = importBlocks(blocks_per_call);
+    for (auto &reader : readers)
+    {
+      reader.join();
+    }
+
+    return imported && !failed;
+  }
+
+private:
+  bool importBlocks(size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      cn::block_verification_context bvc = boost::value_initialized<cn::block_verification_context>();
+      m_core->handle_incoming_block_blob(m_blocks[m_imported++], bvc, false, false);
+      if (!bvc.m_added_to_main_chain)
+        return false;
+    }
+
+    return true;
+  }
+
+  // RpcServer::on_get_blocks
+  bool getBlocks(std::mt19937 &generator)
+  {
+    uint32_t height = m_core->get_current_blockchain_height();
+    std::uniform_int_distribution<uint32_t> distribution(0, height - 1);
+    std::vector<crypto::Hash> knownBlockIds = {m_core->getBlockIdByHeight(distribution(generator)), m_core->getBlockIdByHeight(0)};
+
+    uint32_t totalBlockCount;
+    uint32_t startBlockIndex;
+    std::vector<crypto::Hash> supplement = m_core->findBlockchainSupplement(knownBlockIds, cn::COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT, totalBlockCount, startBlockIndex);
+    for (const auto &blockId : supplement)
+    {
+      auto completeBlock = m_core->getBlock(blockId);
+      if (completeBlock == nullptr)
+        return false;
+
+      cn::toBinaryArray(completeBlock->getBlock());
+    }
+
+    return true;
+  }
+
+  // RpcServer::on_get_random_outs_bin
+  bool getRandomOuts()
+  {
+    cn::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request request;
+    cn::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response response;
+    request.amounts = m_amounts;
+    request.outs_count = 10;
+    return m_core->get_random_outs_for_amounts(request, response);
+  }
+
+  logging::LoggerGroup m_logger;
+  cn::Currency m_currency;
+  test_generator m_generator;
+  cn::AccountBase m_miner;
+  std::unique_ptr<cn::core> m_core;
+  boost::filesystem::path m_directory;
+  std::vector<cn::BinaryArray> m_blocks;
+  size_t m_imported;
+  std::vector<uint64_t> m_amounts;
+};
@@ -57,3 +57,78 @@ private:
   cn::Transaction m_tx;
   crypto::Hash m_tx_prefix_hash;
 };
+
+// Signatures of several transactions spending from the same ring, checked one by one or as a single batch
+template<size_t a_ring_size, bool batched>
+class test_check_ring_signatures : private multi_tx_test_base<a_ring_size>
+{
+  static_assert(0 < a_ring_size, "ring_size must be greater than 0");
+
+public:
+  static const size_t loop_count = a_ring_size < 100 ? 100 : 10;
+  static const size_t ring_size = a_ring_size;
+  static const size_t batch_size = 16;
+
+  typedef multi_tx_test_base<a_ring_size> base_class;
+
+  bool init()
+  {
+    using namespace cn;
+
+    if (!base_class::init())
+      return false;
+
+    m_alice.generate();
+
+    std::vector<TransactionDestinationEntry> destinations;
+    destinations.push_back(TransactionDestinationEntry(this->m_source_amount, m_alice.getAccountKeys().address));
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+      crypto::SecretKey txSK;
+      if (!constructTransaction(this->m_miners[this->real_source_idx].getAccountKeys(), this->m_sources, destinations, std::vector<uint8_t>(), m_txs[i], 0, this->m_logger, txSK))
+        return false;
+
+      getObjectHash(*static_cast<TransactionPrefix*>(&m_txs[i]), m_tx_prefix_hashes[i]);
+
+      crypto::RingSignatureBatchItem &item = m_items[i];
+      item.prefixHash = &m_tx_prefix_hashes[i];
+      item.image = &boost::get<KeyInput>(m_txs[i].inputs[0]).keyImage;
+      item.pubs = this->m_public_key_ptrs;
+      item.pubsCount = ring_size;
+      item.sig = m_txs[i].signatures[0].data();
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    if (batched)
+    {
+      bool results[batch_size];
+      crypto::check_ring_signatures(m_items, batch_size, results);
+      for (size_t i = 0; i < batch_size; ++i)
+      {
+        if (!results[i])
+          return false;
+      }
+
+      return true;
+    }
+
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+      const crypto::RingSignatureBatchItem &item = m_items[i];
+      if (!crypto::check_ring_signature(*item.prefixHash, *item.image, item.pubs, item.pubsCount, item.sig))
+        return false;
+    }
+
+    return true;
+  }
+
+private:
+  cn::AccountBase m_alice;
+  cn::Transaction m_txs[batch_size];
+  crypto::Hash m_tx_prefix_hashes[batch_size];
+  crypto::RingSignatureBatchItem m_items[batch_size];
+};
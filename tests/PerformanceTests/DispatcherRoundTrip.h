@@ -0,0 +1,197 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Ipv4Address.h>
+#include <System/TcpConnection.h>
+#include <System/TcpConnector.h>
+#include <System/TcpListener.h>
+
+// A client sends requests of 64 bytes over loopback and a server context echoes them back, both on one
+// dispatcher running the epoll or the io_uring backend
+class dispatcher_echo
+{
+public:
+  static const size_t message_size = 64;
+
+  dispatcher_echo(uint16_t port) :
+    m_listener(m_dispatcher, platform_system::Ipv4Address("127.0.0.1"), port),
+    m_server(m_dispatcher)
+  {
+    m_client = platform_system::TcpConnector(m_dispatcher).connect(platform_system::Ipv4Address("127.0.0.1"), port);
+    m_connection = m_listener.accept();
+    m_server.spawn([this] {
+      uint8_t request[message_size];
+      size_t received;
+      while ((received = m_connection.read(request, sizeof(request))) > 0)
+      {
+        writeAll(m_connection, request, received);
+      }
+    });
+  }
+
+  ~dispatcher_echo()
+  {
+    m_client = platform_system::TcpConnection();
+    m_server.wait();
+  }
+
+  platform_system::Dispatcher& dispatcher()
+  {
+    return m_dispatcher;
+  }
+
+  void roundTrip()
+  {
+    uint8_t request[message_size] = {};
+    uint8_t response[message_size];
+    writeAll(m_client, request, sizeof(request));
+    size_t received = 0;
+    while (received < sizeof(response))
+    {
+      received += m_client.read(response + received, sizeof(response) - received);
+    }
+  }
+
+private:
+  static void writeAll(platform_system::TcpConnection& connection, const uint8_t* data, size_t size)
+  {
+    size_t sent = 0;
+    while (sent < size)
+    {
+      sent += connection.write(data + sent, size - sent);
+    }
+  }
+
+  platform_system::Dispatcher m_dispatcher;
+  platform_system::TcpListener m_listener;
+  platform_system::TcpConnection m_client;
+  platform_system::TcpConnection m_connection;
+  platform_system::ContextGroup m_server;
+};
+
+// Round trips through the dispatcher. init() also reports the system calls a round trip costs, counted
+// by tracing a child process that runs the same round trips
+template<bool io_uring>
+class test_dispatcher_round_trip
+{
+public:
+  static const size_t loop_count = 20000;
+  static const uint16_t port = io_uring ? 16672 : 16670;
+
+  ~test_dispatcher_round_trip()
+  {
+    m_echo.reset();
+    unsetenv("CONCEAL_DISPATCHER");
+  }
+
+  bool init()
+  {
+    // the dispatcher picks its backend when it is created
+    if (io_uring)
+    {
+      setenv("CONCEAL_DISPATCHER", "io_uring", 1);
+    }
+    else
+    {
+      unsetenv("CONCEAL_DISPATCHER");
+    }
+
+    countSystemCalls();
+    m_echo.reset(new dispatcher_echo(port));
+    if (io_uring && m_echo->dispatcher().getIoUring() == nullptr)
+    {
+      std::cout << "io_uring is not available, the dispatcher runs on epoll" << std::endl;
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    m_echo->roundTrip();
+    return true;
+  }
+
+private:
+  static void countSystemCalls()
+  {
+    const size_t rounds = 1000;
+    pid_t child = fork();
+    if (child == -1)
+    {
+      return;
+    }
+
+    if (child == 0)
+    {
+      // the rounds to count are framed by two signals, seen by the tracer and never delivered
+      ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+      raise(SIGSTOP);
+      {
+        dispatcher_echo echo(port + 1);
+        raise(SIGUSR1);
+        for (size_t i = 0; i < rounds; ++i)
+        {
+          echo.roundTrip();
+        }
+
+        raise(SIGUSR2);
+      }
+
+      _exit(0);
+    }
+
+    int status;
+    if (waitpid(child, &status, 0) != child || !WIFSTOPPED(status) ||
+        ptrace(PTRACE_SETOPTIONS, child, nullptr, reinterpret_cast<void*>(PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL)) == -1)
+    {
+      std::cout << "System calls are not counted, the child process can't be traced" << std::endl;
+      kill(child, SIGKILL);
+      waitpid(child, &status, 0);
+      return;
+    }
+
+    // every system call stops the child twice, on entry and on exit
+    size_t stops = 0;
+    bool counting = false;
+    for (;;)
+    {
+      if (ptrace(PTRACE_SYSCALL, child, nullptr, nullptr) == -1 || waitpid(child, &status, 0) != child || !WIFSTOPPED(status))
+      {
+        break;
+      }
+
+      if (WSTOPSIG(status) == (SIGTRAP | 0x80))
+      {
+        stops += counting ? 1 : 0;
+      }
+      else if (WSTOPSIG(status) == SIGUSR1)
+      {
+        counting = true;
+      }
+      else if (WSTOPSIG(status) == SIGUSR2)
+      {
+        counting = false;
+      }
+    }
+
+    waitpid(child, &status, 0);
+    std::cout << (io_uring ? "io_uring" : "epoll") << " dispatcher: " << stops / 2 / static_cast<double>(rounds) << " system calls per round trip" << std::endl;
+  }
+
+  std::unique_ptr<dispatcher_echo> m_echo;
+};
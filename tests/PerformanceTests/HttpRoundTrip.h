@@ -0,0 +1,82 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "HTTP/HttpParser.h"
+
+// Parses a request with a large body and writes it back as the response, through the stream parser
+// and operator<< or through the connection buffer parser and the direct writer
+template<bool buffered>
+class test_http_round_trip
+{
+public:
+  static const size_t loop_count = 100;
+  static const size_t body_size = 1024 * 1024;
+
+  bool init()
+  {
+    cn::HttpRequest request;
+    request.setUrl("/getblocks.bin");
+    request.addHeader("Content-Type", "application/octet-stream");
+    request.setBody(std::string(body_size, 'x'));
+
+    std::ostringstream stream;
+    stream << request;
+    m_message = stream.str();
+    m_output.resize(m_message.size() + 1024);
+    return true;
+  }
+
+  bool test()
+  {
+    cn::HttpParser parser;
+    cn::HttpRequest request;
+    cn::HttpResponse response;
+    size_t written = 0;
+
+    if (buffered)
+    {
+      size_t offset = 0;
+      cn::HttpInputBuffer input([&](char* data, size_t size) {
+        size_t read = std::min(size, m_message.size() - offset);
+        memcpy(data, m_message.data() + offset, read);
+        offset += read;
+        return read;
+      });
+
+      parser.receiveRequest(input, request);
+      std::string body = request.getBody();
+      response.setBody(std::move(body));
+      response.write([&](const char* data, size_t size) {
+        memcpy(&m_output[written], data, size);
+        written += size;
+      });
+    }
+    else
+    {
+      std::istringstream input(m_message);
+      parser.receiveRequest(input, request);
+      std::string body = request.getBody();
+      response.setBody(body);
+
+      std::ostringstream output;
+      output << response;
+      const std::string& data = output.str();
+      memcpy(&m_output[0], data.data(), data.size());
+      written = data.size();
+    }
+
+    return written > body_size;
+  }
+
+private:
+  std::string m_message;
+  std::string m_output;
+};
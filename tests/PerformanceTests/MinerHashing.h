@@ -0,0 +1,62 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstring>
+
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "crypto/crypto.h"
+
+// Miner attempts on a template of transaction_count transactions, hashes/second = hashes_per_call * 1000 / time per call;
+// the hashing blob is built again for every nonce or built once with the nonce patched in place
+template<bool patched>
+class test_miner_hashing
+{
+public:
+  static const size_t loop_count = 10;
+  static const size_t hashes_per_call = 1;
+  static const size_t transaction_count = 1000;
+
+  bool init()
+  {
+    m_block.majorVersion = cn::BLOCK_MAJOR_VERSION_8;
+    m_block.minorVersion = cn::BLOCK_MINOR_VERSION_0;
+    m_block.timestamp = 1500000000;
+    m_block.previousBlockHash = crypto::rand<crypto::Hash>();
+    m_block.nonce = 0;
+    for (size_t i = 0; i < transaction_count; ++i)
+      m_block.transactionHashes.push_back(crypto::rand<crypto::Hash>());
+
+    return cn::get_block_hashing_blob(m_block, m_blob, m_nonceOffset);
+  }
+
+  bool test()
+  {
+    crypto::Hash hash;
+    for (size_t i = 0; i < hashes_per_call; ++i)
+    {
+      ++m_block.nonce;
+      if (patched)
+      {
+        memcpy(m_blob.data() + m_nonceOffset, &m_block.nonce, sizeof(m_block.nonce));
+        cn::get_block_longhash(m_context, m_block.majorVersion, m_blob, hash);
+      }
+      else if (!cn::get_block_longhash(m_context, m_block, hash))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+private:
+  cn::Block m_block;
+  cn::BinaryArray m_blob;
+  size_t m_nonceOffset;
+  crypto::cn_context m_context;
+};
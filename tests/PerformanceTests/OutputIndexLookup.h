@@ -0,0 +1,133 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "CryptoNoteCore/AmountOutputs.h"
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "CryptoNoteCore/SwappedVector.h"
+#include "Serialization/SerializationOverloads.h"
+
+// Ring member resolution for one amount: the former index of transaction positions, which loads the
+// transaction of every member from the block storage, against the columnar AmountOutputs
+template<bool columnar>
+class test_output_index_lookup
+{
+public:
+  static const size_t loop_count = 10;
+  static const uint32_t block_count = 20000;
+  static const uint16_t outputs_per_block = 10;
+  static const size_t blocks_cache_size = 1024;
+  static const size_t ring_size = 11;
+  static const size_t rings_per_call = 1000;
+
+  struct transaction_index_t
+  {
+    uint32_t block;
+    uint16_t transaction;
+  };
+
+  struct block_t
+  {
+    std::vector<cn::Transaction> transactions;
+
+    void serialize(cn::ISerializer &s)
+    {
+      s(transactions, "transactions");
+    }
+  };
+
+  ~test_output_index_lookup()
+  {
+    m_blocks.close();
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+  bool init()
+  {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    if (!boost::filesystem::create_directories(m_directory))
+      return false;
+
+    if (!m_blocks.open((m_directory / "blocks.bin").string(), (m_directory / "blockindexes.bin").string(), blocks_cache_size, true))
+      return false;
+
+    block_t block;
+    block.transactions.resize(1);
+    cn::Transaction &tx = block.transactions[0];
+    tx.version = 1;
+    tx.unlockTime = 0;
+    tx.outputs.resize(outputs_per_block);
+    for (uint32_t b = 0; b < block_count; ++b)
+    {
+      for (uint16_t o = 0; o < outputs_per_block; ++o)
+      {
+        uint32_t seed = b * outputs_per_block + o;
+        cn::KeyOutput out;
+        crypto::cn_fast_hash(&seed, sizeof(seed), reinterpret_cast<crypto::Hash &>(out.key));
+        tx.outputs[o].amount = 1000;
+        tx.outputs[o].target = out;
+
+        if (columnar)
+          m_columns.push(b, 0, o, out.key, tx.unlockTime);
+        else
+          m_positions.push_back(std::make_pair(transaction_index_t{b, 0}, o));
+      }
+
+      m_blocks.push_back(block);
+    }
+
+    size_t outputCount = static_cast<size_t>(block_count) * outputs_per_block;
+    size_t footprint = columnar ? m_columns.memoryUsage() : m_positions.capacity() * sizeof(m_positions[0]);
+    std::cout << (columnar ? "Columnar" : "Legacy") << " output index: " << footprint << " bytes, " << footprint / static_cast<double>(outputCount) << " bytes per output" << std::endl;
+
+    m_generator.seed(0);
+    return true;
+  }
+
+  bool test()
+  {
+    std::uniform_int_distribution<uint32_t> distribution(0, block_count * outputs_per_block - 1);
+    for (size_t r = 0; r < rings_per_call; ++r)
+    {
+      crypto::PublicKey keys[ring_size];
+      uint64_t unlockTime = 0;
+      for (size_t k = 0; k < ring_size; ++k)
+      {
+        uint32_t i = distribution(m_generator);
+        if (columnar)
+        {
+          keys[k] = m_columns.key(i);
+          unlockTime |= m_columns.unlockTime(i);
+        }
+        else
+        {
+          const cn::Transaction &tx = m_blocks[m_positions[i].first.block].transactions[m_positions[i].first.transaction];
+          keys[k] = boost::get<cn::KeyOutput>(tx.outputs[m_positions[i].second].target).key;
+          unlockTime |= tx.unlockTime;
+        }
+      }
+
+      if (unlockTime != 0 || keys[0] == crypto::PublicKey())
+        return false;
+    }
+
+    return true;
+  }
+
+private:
+  boost::filesystem::path m_directory;
+  SwappedVector<block_t> m_blocks;
+  std::vector<std::pair<transaction_index_t, uint16_t>> m_positions;
+  cn::AmountOutputs m_columns;
+  std::mt19937 m_generator;
+};
@@ -0,0 +1,130 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "Common/StringTools.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteCore/VerificationContext.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+#include "Logging/LoggerGroup.h"
+
+#include "../TestGenerator/TestGenerator.h"
+
+// One /queryblocks.bin response of blocks_per_call blocks, served from the stored blobs or, as
+// before, by decoding the blocks and transactions and encoding them again
+template<bool verbatim>
+class test_query_blocks
+{
+public:
+  static const size_t loop_count = 100;
+  static const size_t blocks_per_call = cn::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
+
+  test_query_blocks() : m_currency(cn::CurrencyBuilder(m_logger).currency()), m_generator(m_currency)
+  {
+  }
+
+  ~test_query_blocks()
+  {
+    if (m_core)
+    {
+      m_core->deinit();
+      m_core.reset();
+    }
+
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+  bool init()
+  {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    if (!boost::filesystem::create_directories(m_directory))
+      return false;
+
+    cn::CoreConfig coreConfig;
+    coreConfig.configFolder = m_directory.string();
+    m_core.reset(new cn::core(m_currency, nullptr, m_logger));
+    if (!m_core->init(coreConfig, cn::MinerConfig(), false))
+      return false;
+
+    m_miner.generate();
+    cn::Block previous = m_currency.genesisBlock();
+    std::vector<size_t> blockSizes;
+    m_generator.addBlock(previous, 0, 0, blockSizes, 0);
+    for (size_t i = 1; i < blocks_per_call; ++i)
+    {
+      uint32_t height = cn::get_block_height(previous) + 1;
+      uint8_t majorVersion = height > m_currency.upgradeHeight(cn::BLOCK_MAJOR_VERSION_2) ? cn::BLOCK_MAJOR_VERSION_2 : cn::BLOCK_MAJOR_VERSION_1;
+      cn::Block block;
+      if (!m_generator.constructBlockManually(block, previous, m_miner, test_generator::bf_major_ver, majorVersion))
+        return false;
+
+      cn::block_verification_context bvc = boost::value_initialized<cn::block_verification_context>();
+      if (!m_core->handle_incoming_block_blob(cn::toBinaryArray(block), bvc, false, false) || !bvc.m_added_to_main_chain)
+        return false;
+
+      previous = block;
+    }
+
+    m_lastBlock = common::asString(cn::toBinaryArray(previous));
+    m_knownBlockIds.push_back(m_currency.genesisBlockHash());
+    return true;
+  }
+
+  bool test()
+  {
+    std::vector<cn::BlockFullInfo> entries;
+    if (verbatim)
+    {
+      uint32_t startHeight;
+      uint32_t currentHeight;
+      uint32_t fullOffset;
+      if (!m_core->queryBlocks(m_knownBlockIds, 0, startHeight, currentHeight, fullOffset, entries))
+        return false;
+    }
+    else
+    {
+      std::list<cn::Block> blocks;
+      m_core->get_blocks(0, static_cast<uint32_t>(blocks_per_call), blocks);
+      for (const auto &block : blocks)
+      {
+        std::list<cn::Transaction> txs;
+        std::list<crypto::Hash> missedTxs;
+        m_core->getTransactions(block.transactionHashes, txs, missedTxs);
+
+        cn::BlockFullInfo item;
+        item.block_id = cn::get_block_hash(block);
+        item.block = common::asString(cn::toBinaryArray(block));
+        for (const auto &tx : txs)
+          item.txs.push_back(common::asString(cn::toBinaryArray(tx)));
+        entries.push_back(std::move(item));
+      }
+    }
+
+    return entries.size() == blocks_per_call && entries.back().block == m_lastBlock;
+  }
+
+private:
+  logging::LoggerGroup m_logger;
+  cn::Currency m_currency;
+  test_generator m_generator;
+  cn::AccountBase m_miner;
+  std::unique_ptr<cn::core> m_core;
+  boost::filesystem::path m_directory;
+  std::vector<crypto::Hash> m_knownBlockIds;
+  std::string m_lastBlock;
+};
@@ -0,0 +1,49 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include "Common/StringTools.h"
+#include "crypto/crypto.h"
+#include "crypto/scratchpad_pool.hpp"
+
+// A slow hash in a fresh context, the way wallets and miner calls use them, with the scratchpad pool
+// handing out huge pages or heap pages
+template<bool huge_pages>
+class test_scratchpad_pool
+{
+public:
+  static const size_t loop_count = 10;
+
+  ~test_scratchpad_pool()
+  {
+    crypto::scratchpad_pool::instance().set_huge_pages(m_huge_pages);
+  }
+
+  bool init()
+  {
+    m_huge_pages = crypto::scratchpad_pool::instance().huge_pages();
+    crypto::scratchpad_pool::instance().set_huge_pages(huge_pages);
+
+    size_t size;
+    if (!common::fromHex("63617665617420656d70746f72", m_data, sizeof(m_data), size) || size != sizeof(m_data))
+      return false;
+
+    return common::fromHex("bbec2cacf69866a8e740380fe7b818fc78f8571221742d729d9d02d7f8989b87", &m_expected_hash, sizeof(m_expected_hash), size) &&
+      size == sizeof(m_expected_hash);
+  }
+
+  bool test()
+  {
+    crypto::cn_context context;
+    crypto::Hash hash;
+    crypto::cn_slow_hash_v0(context, m_data, sizeof(m_data), hash);
+    return hash == m_expected_hash;
+  }
+
+private:
+  char m_data[13];
+  crypto::Hash m_expected_hash;
+  bool m_huge_pages;
+};
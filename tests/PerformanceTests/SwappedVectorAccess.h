@@ -0,0 +1,84 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "CryptoNoteCore/SwappedVector.h"
+#include "Serialization/SerializationOverloads.h"
+#include "crypto/hash.h"
+
+// Random height access to a block storage bigger than its cache, through the fstream or the mapped file
+template<bool memory_mapped>
+class test_swapped_vector_random_access
+{
+public:
+  static const size_t loop_count = 10;
+  static const size_t item_count = 20000;
+  static const size_t pool_size = 1024;
+  static const size_t accesses_per_call = 10000;
+
+  struct item_t
+  {
+    uint32_t height;
+    std::vector<crypto::Hash> hashes;
+
+    void serialize(cn::ISerializer &s)
+    {
+      s(height, "height");
+      s(hashes, "hashes");
+    }
+  };
+
+  ~test_swapped_vector_random_access()
+  {
+    m_items.close();
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+  bool init()
+  {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    if (!boost::filesystem::create_directories(m_directory))
+      return false;
+
+    if (!m_items.open((m_directory / "blocks.bin").string(), (m_directory / "blockindexes.bin").string(), pool_size, memory_mapped))
+      return false;
+
+    item_t item;
+    item.hashes.resize(64);
+    for (uint32_t i = 0; i < item_count; ++i)
+    {
+      item.height = i;
+      crypto::cn_fast_hash(&i, sizeof(i), item.hashes[i % item.hashes.size()]);
+      m_items.push_back(item);
+    }
+
+    m_generator.seed(0);
+    return true;
+  }
+
+  bool test()
+  {
+    std::uniform_int_distribution<uint32_t> distribution(0, item_count - 1);
+    for (size_t i = 0; i < accesses_per_call; ++i)
+    {
+      uint32_t height = distribution(m_generator);
+      if (m_items[height].height != height)
+        return false;
+    }
+
+    return true;
+  }
+
+private:
+  boost::filesystem::path m_directory;
+  SwappedVector<item_t> m_items;
+  std::mt19937 m_generator;
+};
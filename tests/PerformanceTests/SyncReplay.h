@@ -0,0 +1,136 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "Common/StringTools.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "Logging/LoggerGroup.h"
+#include "P2p/LevinProtocol.h"
+#include "System/Dispatcher.h"
+
+#include "../TestGenerator/TestGenerator.h"
+
+// Local replay of a synchronization: each call hands one NOTIFY_RESPONSE_GET_OBJECTS batch of
+// blocks_per_call blocks to the protocol handler, blocks/second = blocks_per_call * 1000 / time per call
+class test_sync_replay
+{
+public:
+  static const size_t loop_count = 5;
+  static const size_t blocks_per_call = cn::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
+
+  test_sync_replay() : m_currency(cn::CurrencyBuilder(m_logger).currency()), m_generator(m_currency), m_replayed(0), m_startHeight(0)
+  {
+  }
+
+  ~test_sync_replay()
+  {
+    m_handler.reset();
+    if (m_core)
+    {
+      m_core->deinit();
+      m_core.reset();
+    }
+
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+  bool init()
+  {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    if (!boost::filesystem::create_directories(m_directory))
+      return false;
+
+    cn::CoreConfig coreConfig;
+    coreConfig.configFolder = m_directory.string();
+    m_core.reset(new cn::core(m_currency, nullptr, m_logger));
+    if (!m_core->init(coreConfig, cn::MinerConfig(), false))
+      return false;
+
+    m_handler.reset(new cn::CryptoNoteProtocolHandler(m_currency, m_dispatcher, *m_core, nullptr, m_logger));
+
+    m_miner.generate();
+    cn::Block previous = m_currency.genesisBlock();
+    std::vector<size_t> blockSizes;
+    m_generator.addBlock(previous, 0, 0, blockSizes, 0);
+    std::vector<crypto::Hash> hashes;
+    for (size_t i = 0; i < loop_count; ++i)
+    {
+      cn::NOTIFY_RESPONSE_GET_OBJECTS::request response;
+      for (size_t j = 0; j < blocks_per_call; ++j)
+      {
+        uint32_t height = cn::get_block_height(previous) + 1;
+        uint8_t majorVersion = height > m_currency.upgradeHeight(cn::BLOCK_MAJOR_VERSION_2) ? cn::BLOCK_MAJOR_VERSION_2 : cn::BLOCK_MAJOR_VERSION_1;
+        cn::Block block;
+        if (!m_generator.constructBlockManually(block, previous, m_miner, test_generator::bf_major_ver, majorVersion))
+          return false;
+
+        cn::block_complete_entry entry;
+        entry.block = common::asString(cn::toBinaryArray(block));
+        response.blocks.push_back(entry);
+        hashes.push_back(cn::get_block_hash(block));
+        previous = block;
+      }
+
+      m_responses.push_back(response);
+    }
+
+    uint32_t topHeight = static_cast<uint32_t>(hashes.size());
+    for (auto &response : m_responses)
+    {
+      response.current_blockchain_height = topHeight + 1;
+      m_batches.push_back(cn::LevinProtocol::encode(response));
+    }
+
+    // the state the handler leaves after NOTIFY_RESPONSE_CHAIN_ENTRY, with the first batch requested
+    m_context.m_state = cn::CryptoNoteConnectionContext::state_synchronizing;
+    m_context.m_remote_blockchain_height = topHeight + 1;
+    m_context.m_last_response_height = topHeight;
+    m_context.m_requested_objects.insert(hashes.begin(), hashes.begin() + blocks_per_call);
+    m_context.m_needed_objects.assign(hashes.begin() + blocks_per_call, hashes.end());
+    m_startHeight = m_core->get_current_blockchain_height();
+
+    return true;
+  }
+
+  bool test()
+  {
+    cn::BinaryArray out;
+    bool handled = false;
+    m_handler->handleCommand(true, cn::NOTIFY_RESPONSE_GET_OBJECTS::ID, m_batches[m_replayed++], out, m_context, handled);
+
+    // a batch is committed while the next one is parsed, only the last call waits for its own batch
+    size_t committed = m_replayed == m_batches.size() ? m_replayed : m_replayed - 1;
+    return handled && m_context.m_state != cn::CryptoNoteConnectionContext::state_shutdown &&
+      m_core->get_current_blockchain_height() >= m_startHeight + committed * blocks_per_call;
+  }
+
+private:
+  logging::LoggerGroup m_logger;
+  cn::Currency m_currency;
+  test_generator m_generator;
+  cn::AccountBase m_miner;
+  platform_system::Dispatcher m_dispatcher;
+  std::unique_ptr<cn::core> m_core;
+  std::unique_ptr<cn::CryptoNoteProtocolHandler> m_handler;
+  boost::filesystem::path m_directory;
+  std::vector<cn::NOTIFY_RESPONSE_GET_OBJECTS::request> m_responses;
+  std::vector<cn::BinaryArray> m_batches;
+  size_t m_replayed;
+  uint32_t m_startHeight;
+  cn::CryptoNoteConnectionContext m_context;
+};
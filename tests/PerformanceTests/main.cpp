@@ -7,15 +7,26 @@
 #include "PerformanceUtils.h"
 
 // tests
+#include "BlockchainContention.h"
 #include "ConstructTransaction.h"
 #include "CheckRingSignature.h"
 #include "CryptoNoteSlowHash.h"
 #include "DerivePublicKey.h"
 #include "DeriveSecretKey.h"
+#ifdef __linux__
+#include "DispatcherRoundTrip.h"
+#endif
 #include "GenerateKeyDerivation.h"
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
+#include "HttpRoundTrip.h"
 #include "IsOutToAccount.h"
+#include "MinerHashing.h"
+#include "OutputIndexLookup.h"
+#include "QueryBlocks.h"
+#include "ScratchpadPool.h"
+#include "SwappedVectorAccess.h"
+#include "SyncReplay.h"
 
 int main(int argc, char** argv)
 {
@@ -51,6 +62,15 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE1(test_check_ring_signature, 10);
   TEST_PERFORMANCE1(test_check_ring_signature, 100);
 
+  TEST_PERFORMANCE2(test_check_ring_signatures, 1, false);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 1, true);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 2, false);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 2, true);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 10, false);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 10, true);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 100, false);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 100, true);
+
   TEST_PERFORMANCE0(test_is_out_to_acc);
   TEST_PERFORMANCE0(test_generate_key_image_helper);
   TEST_PERFORMANCE0(test_generate_key_derivation);
@@ -59,6 +79,34 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_derive_secret_key);
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
+  TEST_PERFORMANCE1(test_scratchpad_pool, false);
+  TEST_PERFORMANCE1(test_scratchpad_pool, true);
+
+  TEST_PERFORMANCE1(test_miner_hashing, false);
+  TEST_PERFORMANCE1(test_miner_hashing, true);
+
+  TEST_PERFORMANCE1(test_swapped_vector_random_access, false);
+  TEST_PERFORMANCE1(test_swapped_vector_random_access, true);
+
+  TEST_PERFORMANCE1(test_output_index_lookup, false);
+  TEST_PERFORMANCE1(test_output_index_lookup, true);
+
+  TEST_PERFORMANCE1(test_blockchain_contention, 1);
+  TEST_PERFORMANCE1(test_blockchain_contention, 4);
+  TEST_PERFORMANCE1(test_blockchain_contention, 16);
+
+  TEST_PERFORMANCE0(test_sync_replay);
+
+  TEST_PERFORMANCE1(test_query_blocks, false);
+  TEST_PERFORMANCE1(test_query_blocks, true);
+
+  TEST_PERFORMANCE1(test_http_round_trip, false);
+  TEST_PERFORMANCE1(test_http_round_trip, true);
+
+#ifdef __linux__
+  TEST_PERFORMANCE1(test_dispatcher_round_trip, false);
+  TEST_PERFORMANCE1(test_dispatcher_round_trip, true);
+#endif
 
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
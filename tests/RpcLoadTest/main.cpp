@@ -0,0 +1,119 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Drives many concurrent keep-alive connections against a running daemon and reports
+// the latency percentiles of /getinfo and /getblocks.bin
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Common/StringTools.h"
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+#include "Rpc/HttpClient.h"
+#include "System/ContextGroup.h"
+#include "System/Dispatcher.h"
+
+using namespace std;
+
+namespace {
+
+struct Latencies {
+  vector<double> getInfo;
+  vector<double> getBlocks;
+  size_t errors = 0;
+};
+
+void printPercentiles(const string& name, vector<double>& samples) {
+  if (samples.empty()) {
+    cout << name << ": no successful requests" << endl;
+    return;
+  }
+
+  sort(samples.begin(), samples.end());
+  double p50 = samples[samples.size() * 50 / 100];
+  double p99 = samples[min(samples.size() - 1, samples.size() * 99 / 100)];
+  cout << fixed << setprecision(2) << name << ": " << samples.size() << " requests, p50 " << p50 << " ms, p99 " << p99 << " ms" << endl;
+}
+
+void runClient(platform_system::Dispatcher& dispatcher, const string& host, uint16_t port, size_t requests, const crypto::Hash& genesis, Latencies& latencies) {
+  cn::HttpClient client(dispatcher, host, port);
+  for (size_t i = 0; i < requests; ++i) {
+    auto start = chrono::steady_clock::now();
+    try {
+      if (i % 2 == 0) {
+        cn::COMMAND_RPC_GET_INFO::request req;
+        cn::COMMAND_RPC_GET_INFO::response res;
+        cn::invokeJsonCommand(client, "/getinfo", req, res);
+      } else {
+        cn::COMMAND_RPC_GET_BLOCKS_FAST::request req;
+        cn::COMMAND_RPC_GET_BLOCKS_FAST::response res;
+        req.block_ids.push_back(genesis);
+        cn::invokeBinaryCommand(client, "/getblocks.bin", req, res);
+      }
+    } catch (exception&) {
+      ++latencies.errors;
+      continue;
+    }
+
+    double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    (i % 2 == 0 ? latencies.getInfo : latencies.getBlocks).push_back(elapsed);
+  }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3 || argc > 5) {
+    cerr << "Usage: " << argv[0] << " <host> <port> [clients=1000] [requests per client=20]" << endl;
+    return 1;
+  }
+
+  string host = argv[1];
+  uint16_t port = static_cast<uint16_t>(stoul(argv[2]));
+  size_t clients = argc > 3 ? stoul(argv[3]) : 1000;
+  size_t requests = argc > 4 ? stoul(argv[4]) : 20;
+
+  platform_system::Dispatcher dispatcher;
+
+  crypto::Hash genesis;
+  try {
+    cn::HttpClient client(dispatcher, host, port);
+    cn::COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::request req;
+    cn::COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::response res;
+    req.height = 0;
+    cn::invokeJsonRpcCommand(client, "getblockheaderbyheight", req, res);
+    if (!common::podFromHex(res.block_header.hash, genesis)) {
+      cerr << "Unexpected genesis block hash " << res.block_header.hash << endl;
+      return 1;
+    }
+  } catch (exception& e) {
+    cerr << "Failed to query the genesis block: " << e.what() << endl;
+    return 1;
+  }
+
+  Latencies latencies;
+  auto start = chrono::steady_clock::now();
+  {
+    platform_system::ContextGroup group(dispatcher);
+    for (size_t i = 0; i < clients; ++i) {
+      group.spawn([&] { runClient(dispatcher, host, port, requests, genesis, latencies); });
+    }
+
+    group.wait();
+  }
+
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  size_t total = latencies.getInfo.size() + latencies.getBlocks.size();
+
+  cout << clients << " clients, " << total << " requests in " << fixed << setprecision(2) << seconds << " s, "
+       << total / seconds << " requests/s, " << latencies.errors << " errors" << endl;
+  printPercentiles("/getinfo", latencies.getInfo);
+  printPercentiles("/getblocks.bin", latencies.getBlocks);
+  return latencies.errors == 0 ? 0 : 1;
+}
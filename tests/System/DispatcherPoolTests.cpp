@@ -0,0 +1,157 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <System/Dispatcher.h>
+#include <System/DispatcherPool.h>
+#include <System/InterruptedException.h>
+#include <System/Timer.h>
+#include <gtest/gtest.h>
+
+using namespace platform_system;
+
+TEST(DispatcherPoolTests, runsProceduresOnPoolThreads) {
+  const size_t PROCEDURES = 20;
+  DispatcherPool pool(2);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  std::atomic<size_t> done(0);
+  std::promise<void> allDone;
+  for (size_t i = 0; i < PROCEDURES; ++i) {
+    pool.spawn([&](Dispatcher&) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+      }
+
+      // holds the thread, so the procedures queued meanwhile go to the other dispatcher
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if (++done == PROCEDURES) {
+        allDone.set_value();
+      }
+    });
+  }
+
+  allDone.get_future().wait();
+  ASSERT_EQ(0, threads.count(std::this_thread::get_id()));
+  ASSERT_EQ(2u, threads.size());
+}
+
+TEST(DispatcherPoolTests, procedureStaysOnItsDispatcher) {
+  const size_t PROCEDURES = 8;
+  DispatcherPool pool(4);
+  std::atomic<size_t> moved(0);
+  std::atomic<size_t> done(0);
+  std::promise<void> allDone;
+  for (size_t i = 0; i < PROCEDURES; ++i) {
+    pool.spawn([&](Dispatcher& dispatcher) {
+      auto thread = std::this_thread::get_id();
+      for (int j = 0; j < 5; ++j) {
+        Timer(dispatcher).sleep(std::chrono::milliseconds(1));
+        if (std::this_thread::get_id() != thread) {
+          ++moved;
+        }
+      }
+
+      if (++done == PROCEDURES) {
+        allDone.set_value();
+      }
+    });
+  }
+
+  allDone.get_future().wait();
+  ASSERT_EQ(0, moved);
+}
+
+TEST(DispatcherPoolTests, idleDispatcherTakesQueuedProcedure) {
+  DispatcherPool pool(2);
+  std::promise<std::thread::id> blockingStarted;
+  std::promise<void> sleepingStarted;
+  std::atomic<bool> blocking(true);
+
+  // blocks the thread of the first dispatcher
+  pool.spawn([&](Dispatcher&) {
+    blockingStarted.set_value(std::this_thread::get_id());
+    while (blocking) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  auto blockedThread = blockingStarted.get_future().get();
+
+  // gives the second dispatcher the same load while leaving its thread free
+  pool.spawn([&](Dispatcher& dispatcher) {
+    sleepingStarted.set_value();
+    Timer(dispatcher).sleep(std::chrono::seconds(1));
+  });
+
+  sleepingStarted.get_future().wait();
+
+  // queued on the blocked dispatcher as the first of the equally loaded ones
+  std::promise<std::thread::id> queuedDone;
+  pool.spawn([&](Dispatcher&) {
+    queuedDone.set_value(std::this_thread::get_id());
+  });
+
+  auto result = queuedDone.get_future();
+  bool ready = result.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+  blocking = false;
+  ASSERT_TRUE(ready);
+  ASSERT_NE(blockedThread, result.get());
+}
+
+TEST(DispatcherPoolTests, proceduresBeyondQueueCapacityRun) {
+  const size_t PROCEDURES = 5000;
+  DispatcherPool pool(1);
+  std::atomic<size_t> done(0);
+  std::promise<void> allDone;
+  std::promise<void> blockingStarted;
+  std::atomic<bool> blocking(true);
+
+  // keeps the procedures queued until all are spawned
+  pool.spawn([&](Dispatcher&) {
+    blockingStarted.set_value();
+    while (blocking) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  blockingStarted.get_future().wait();
+  for (size_t i = 0; i < PROCEDURES; ++i) {
+    pool.spawn([&](Dispatcher&) {
+      if (++done == PROCEDURES) {
+        allDone.set_value();
+      }
+    });
+  }
+
+  blocking = false;
+  ASSERT_EQ(std::future_status::ready, allDone.get_future().wait_for(std::chrono::seconds(10)));
+}
+
+TEST(DispatcherPoolTests, destructionInterruptsRunningProcedures) {
+  std::atomic<bool> interrupted(false);
+  std::promise<void> started;
+  auto begin = std::chrono::steady_clock::now();
+  {
+    DispatcherPool pool(2);
+    pool.spawn([&](Dispatcher& dispatcher) {
+      started.set_value();
+      try {
+        Timer(dispatcher).sleep(std::chrono::seconds(10));
+      } catch (InterruptedException&) {
+        interrupted = true;
+      }
+    });
+
+    started.get_future().wait();
+  }
+
+  ASSERT_TRUE(interrupted);
+  ASSERT_GT(std::chrono::seconds(5), std::chrono::steady_clock::now() - begin);
+}
@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <future>
+#include <iostream>
 #include <thread>
 #include <System/Context.h>
 #include <System/Dispatcher.h>
@@ -375,3 +376,51 @@ TEST_F(DispatcherTests, yieldExecutesIoOnItsFront) {
   dispatcher.yield();
   ASSERT_TRUE(spawnDone);
 }
+
+TEST_F(DispatcherTests, contextSwitchRate) {
+  const size_t ROUNDS = 500000;
+  auto mainContext = dispatcher.getCurrentContext();
+  NativeContext* workerContext = nullptr;
+  Context<> context(dispatcher, [&]() {
+    workerContext = dispatcher.getCurrentContext();
+    for (size_t i = 0; i < ROUNDS; ++i) {
+      dispatcher.pushContext(mainContext);
+      dispatcher.dispatch();
+    }
+  });
+
+  dispatcher.dispatch();
+  ASSERT_NE(nullptr, workerContext);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 1; i < ROUNDS; ++i) {
+    dispatcher.pushContext(workerContext);
+    dispatcher.dispatch();
+  }
+
+  auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  dispatcher.pushContext(workerContext);
+  context.wait();
+  std::cout << "context switches per second: " << 2 * (ROUNDS - 1) * 1000000000ull / std::max<uint64_t>(duration.count(), 1) << std::endl;
+}
+
+TEST_F(DispatcherTests, spawnedContextCanUseDeepStack) {
+  const size_t DEPTH = 256;
+  std::function<size_t(size_t)> recurse = [&](size_t depth) -> size_t {
+    volatile uint8_t frame[1024]; // about 256 KB in total
+    frame[0] = static_cast<uint8_t>(depth);
+    return depth == 0 ? 0 : recurse(depth - 1) + frame[0];
+  };
+
+  size_t expected = 0;
+  for (size_t depth = 1; depth <= DEPTH; ++depth) {
+    expected += static_cast<uint8_t>(depth);
+  }
+
+  size_t result = 0;
+  Context<> context(dispatcher, [&]() {
+    result = recurse(DEPTH);
+  });
+
+  context.wait();
+  ASSERT_EQ(expected, result);
+}
@@ -3,6 +3,7 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <iostream>
 #include <System/Dispatcher.h>
 #include <System/ContextGroup.h>
 #include <System/Event.h>
@@ -263,6 +264,47 @@ TEST_F(TcpConnectionTests, sendBigChunk) {
   ASSERT_EQ(buf, incoming);
 }
 
+TEST_F(TcpConnectionTests, sendHeaderAndBigChunk) {
+  connect();
+
+  const size_t headsize = 33;
+  const size_t bufsize = 15 * 1024 * 1024; // 15MB
+  std::vector<uint8_t> buf;
+  buf.resize(headsize + bufsize);
+  fillRandomBuf(buf);
+
+  std::vector<uint8_t> incoming;
+  Event readComplete(dispatcher);
+
+  contextGroup.spawn([&]{
+    uint8_t readBuf[1024];
+    size_t readSize;
+    while ((readSize = connection2.read(readBuf, sizeof(readBuf))) > 0) {
+      incoming.insert(incoming.end(), readBuf, readBuf + readSize);
+    }
+
+    readComplete.set();
+  });
+
+  contextGroup.spawn([&]{
+    size_t offset = 0;
+    while (offset < headsize) {
+      offset += connection1.write(&buf[offset], headsize - offset, &buf[headsize], bufsize);
+    }
+
+    while (offset < buf.size()) {
+      offset += connection1.write(&buf[offset], buf.size() - offset);
+    }
+
+    connection1 = TcpConnection(); // close connection
+  });
+
+  readComplete.wait();
+
+  ASSERT_EQ(buf.size(), incoming.size());
+  ASSERT_EQ(buf, incoming);
+}
+
 TEST_F(TcpConnectionTests, writeWhenReadWaiting) {
   connect();
 
@@ -352,3 +394,37 @@ TEST_F(TcpConnectionTests, sendBigChunkThruTcpStream) {
     ASSERT_EQ(buf[i], incoming[i]); //for better output.
   }
 }
+
+TEST_F(TcpConnectionTests, requestRoundTripRate) {
+  const size_t ROUNDS = 20000;
+  const size_t MESSAGE_SIZE = 64;
+  connect();
+
+  contextGroup.spawn([&] {
+    uint8_t request[MESSAGE_SIZE];
+    size_t received;
+    while ((received = connection2.read(request, sizeof(request))) > 0) {
+      connection2.write(request, received);
+    }
+  });
+
+  uint8_t request[MESSAGE_SIZE] = {};
+  uint8_t response[MESSAGE_SIZE];
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ROUNDS; ++i) {
+    size_t sent = 0;
+    while (sent < sizeof(request)) {
+      sent += connection1.write(request + sent, sizeof(request) - sent);
+    }
+
+    size_t received = 0;
+    while (received < sizeof(response)) {
+      received += connection1.read(response + received, sizeof(response) - received);
+    }
+  }
+
+  auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  connection1 = TcpConnection();
+  contextGroup.wait();
+  std::cout << "request round trips per second: " << ROUNDS * 1000000000ull / std::max<uint64_t>(duration.count(), 1) << std::endl;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include "CryptoNoteCore/BlockCacheJournal.h"
+
+namespace {
+class BlockCacheJournalTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    m_filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    ASSERT_TRUE(m_journal.open(m_filename));
+  }
+
+  void TearDown() override {
+    m_journal.close();
+    boost::system::error_code ignore;
+    boost::filesystem::remove(m_filename, ignore);
+  }
+
+  cn::BlockCacheJournal::Record makeRecord(uint32_t height) {
+    cn::BlockCacheJournal::Record record;
+    record.height = height;
+    record.blockHash = crypto::Hash();
+    record.blockHash.data[0] = static_cast<uint8_t>(height);
+    record.block = std::string(100 + height, static_cast<char>(height));
+    return record;
+  }
+
+protected:
+  std::string m_filename;
+  cn::BlockCacheJournal m_journal;
+};
+}
+
+TEST_F(BlockCacheJournalTest, loadsAppendedRecordsInOrder) {
+  ASSERT_TRUE(m_journal.append(makeRecord(5)));
+  ASSERT_TRUE(m_journal.append(makeRecord(4)));
+
+  std::vector<cn::BlockCacheJournal::Record> records;
+  ASSERT_TRUE(m_journal.load(records));
+  ASSERT_EQ(2, records.size());
+  ASSERT_EQ(5, records[0].height);
+  ASSERT_EQ(makeRecord(5).blockHash, records[0].blockHash);
+  ASSERT_EQ(makeRecord(5).block, records[0].block);
+  ASSERT_EQ(4, records[1].height);
+}
+
+TEST_F(BlockCacheJournalTest, clearDropsRecords) {
+  ASSERT_TRUE(m_journal.append(makeRecord(5)));
+  ASSERT_TRUE(m_journal.clear());
+  ASSERT_TRUE(m_journal.append(makeRecord(7)));
+
+  std::vector<cn::BlockCacheJournal::Record> records;
+  ASSERT_TRUE(m_journal.load(records));
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ(7, records[0].height);
+}
+
+TEST_F(BlockCacheJournalTest, tornRecordEndsReplay) {
+  ASSERT_TRUE(m_journal.append(makeRecord(5)));
+  ASSERT_TRUE(m_journal.append(makeRecord(4)));
+  m_journal.close();
+
+  boost::filesystem::resize_file(m_filename, boost::filesystem::file_size(m_filename) - 10);
+
+  std::vector<cn::BlockCacheJournal::Record> records;
+  ASSERT_TRUE(m_journal.load(records));
+  ASSERT_EQ(1, records.size());
+  ASSERT_EQ(5, records[0].height);
+}
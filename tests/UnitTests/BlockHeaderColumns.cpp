@@ -0,0 +1,217 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include "Common/VectorOutputStream.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/BlockHeaderColumns.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteCore/VerificationContext.h"
+#include "Logging/LoggerGroup.h"
+#include "Serialization/BinaryOutputStreamSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+
+#include "../TestGenerator/TestGenerator.h"
+
+namespace {
+cn::BlockHeaderColumns::Header makeHeader(uint32_t value) {
+  cn::BlockHeaderColumns::Header header;
+  header.timestamp = 1000 + value;
+  header.cumulativeDifficulty = 2000 + value;
+  header.cumulativeSize = 3000 + value;
+  header.alreadyGeneratedCoins = 4000 + value;
+  header.reward = 5000 + value;
+  header.nonce = 6000 + value;
+  header.majorVersion = static_cast<uint8_t>(value);
+  header.minorVersion = static_cast<uint8_t>(value + 1);
+  return header;
+}
+
+void checkHeader(const cn::BlockHeaderColumns::Header& expected, const cn::BlockHeaderColumns::Header& header) {
+  ASSERT_EQ(expected.timestamp, header.timestamp);
+  ASSERT_EQ(expected.cumulativeDifficulty, header.cumulativeDifficulty);
+  ASSERT_EQ(expected.cumulativeSize, header.cumulativeSize);
+  ASSERT_EQ(expected.alreadyGeneratedCoins, header.alreadyGeneratedCoins);
+  ASSERT_EQ(expected.reward, header.reward);
+  ASSERT_EQ(expected.nonce, header.nonce);
+  ASSERT_EQ(expected.majorVersion, header.majorVersion);
+  ASSERT_EQ(expected.minorVersion, header.minorVersion);
+}
+
+// A core with a few generated blocks, its header columns have to describe the stored blocks
+class BlockHeaderColumnsCore : public ::testing::Test {
+public:
+  BlockHeaderColumnsCore() : m_currency(cn::CurrencyBuilder(m_logger).currency()), m_generator(m_currency) {
+  }
+
+  void SetUp() override {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    ASSERT_TRUE(boost::filesystem::create_directories(m_directory));
+
+    m_miner.generate();
+    m_tail = m_currency.genesisBlock();
+    std::vector<size_t> blockSizes;
+    m_generator.addBlock(m_tail, 0, 0, blockSizes, 0);
+  }
+
+  void TearDown() override {
+    stopCore();
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+protected:
+  bool startCore() {
+    cn::CoreConfig coreConfig;
+    coreConfig.configFolder = m_directory.string();
+    m_core.reset(new cn::core(m_currency, nullptr, m_logger));
+    return m_core->init(coreConfig, cn::MinerConfig(), true);
+  }
+
+  void stopCore() {
+    if (m_core) {
+      m_core->deinit();
+      m_core.reset();
+    }
+  }
+
+  void addBlocks(uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t height = cn::get_block_height(m_tail) + 1;
+      uint8_t majorVersion = height > m_currency.upgradeHeight(cn::BLOCK_MAJOR_VERSION_2) ? cn::BLOCK_MAJOR_VERSION_2 : cn::BLOCK_MAJOR_VERSION_1;
+      cn::Block block;
+      ASSERT_TRUE(m_generator.constructBlockManually(block, m_tail, m_miner, test_generator::bf_major_ver, majorVersion));
+
+      cn::block_verification_context bvc = boost::value_initialized<cn::block_verification_context>();
+      m_core->handle_incoming_block_blob(cn::toBinaryArray(block), bvc, false, false);
+      ASSERT_TRUE(bvc.m_added_to_main_chain);
+      m_tail = block;
+    }
+  }
+
+  void checkHeadersMatchBlocks() {
+    uint32_t height = m_core->get_current_blockchain_height();
+    for (uint32_t i = 0; i < height; ++i) {
+      crypto::Hash hash = m_core->getBlockIdByHeight(i);
+      cn::Block block;
+      ASSERT_TRUE(m_core->getBlockByHash(hash, block));
+
+      uint64_t reward = 0;
+      for (const auto& output : block.baseTransaction.outputs) {
+        reward += output.amount;
+      }
+
+      uint64_t coins;
+      ASSERT_TRUE(m_core->getAlreadyGeneratedCoins(hash, coins));
+
+      cn::BlockHeaderColumns::Header header;
+      ASSERT_TRUE(m_core->getBlockHeader(i, header));
+      ASSERT_EQ(block.timestamp, header.timestamp);
+      ASSERT_EQ(block.nonce, header.nonce);
+      ASSERT_EQ(block.majorVersion, header.majorVersion);
+      ASSERT_EQ(block.minorVersion, header.minorVersion);
+      ASSERT_EQ(reward, header.reward);
+      ASSERT_EQ(coins, header.alreadyGeneratedCoins);
+    }
+
+    cn::BlockHeaderColumns::Header header;
+    ASSERT_FALSE(m_core->getBlockHeader(height, header));
+  }
+
+  logging::LoggerGroup m_logger;
+  cn::Currency m_currency;
+  test_generator m_generator;
+  cn::AccountBase m_miner;
+  cn::Block m_tail;
+  boost::filesystem::path m_directory;
+  std::unique_ptr<cn::core> m_core;
+};
+}
+
+TEST(BlockHeaderColumns, keepsHeadersByHeight) {
+  cn::BlockHeaderColumns columns;
+  for (uint32_t i = 0; i < 3; ++i) {
+    columns.push(makeHeader(i));
+  }
+
+  ASSERT_EQ(3, columns.size());
+  checkHeader(makeHeader(1), columns.header(1));
+  ASSERT_EQ(makeHeader(2).timestamp, columns.timestamp(2));
+  ASSERT_EQ(makeHeader(2).cumulativeDifficulty, columns.cumulativeDifficulty(2));
+  ASSERT_EQ(makeHeader(2).majorVersion, columns.majorVersion(2));
+
+  columns.setAlreadyGeneratedCoins(1, 42);
+  ASSERT_EQ(42, columns.alreadyGeneratedCoins(1));
+
+  columns.pop();
+  ASSERT_EQ(2, columns.size());
+  columns.push(makeHeader(7));
+  checkHeader(makeHeader(7), columns.header(2));
+
+  columns.clear();
+  ASSERT_TRUE(columns.empty());
+}
+
+TEST(BlockHeaderColumns, serializationRoundTrip) {
+  cn::BlockHeaderColumns columns;
+  for (uint32_t i = 0; i < 5; ++i) {
+    columns.push(makeHeader(i));
+  }
+
+  cn::BlockHeaderColumns loaded;
+  ASSERT_TRUE(cn::fromBinaryArray(loaded, cn::toBinaryArray(columns)));
+  ASSERT_EQ(columns.size(), loaded.size());
+  for (uint32_t i = 0; i < 5; ++i) {
+    checkHeader(columns.header(i), loaded.header(i));
+  }
+}
+
+TEST(BlockHeaderColumns, refusesColumnsOfDifferentLengths) {
+  std::vector<uint64_t> full = { 1, 2, 3 };
+  std::vector<uint64_t> shorter = { 1, 2 };
+  std::vector<uint32_t> nonces = { 1, 2, 3 };
+  std::vector<uint8_t> versions = { 1, 1, 1 };
+
+  cn::BinaryArray data;
+  {
+    common::VectorOutputStream stream(data);
+    cn::BinaryOutputStreamSerializer s(stream);
+    cn::serializeAsBinary(full, "timestamps", s);
+    cn::serializeAsBinary(full, "cumulative_difficulties", s);
+    cn::serializeAsBinary(full, "cumulative_sizes", s);
+    cn::serializeAsBinary(shorter, "already_generated_coins", s);
+    cn::serializeAsBinary(full, "rewards", s);
+    cn::serializeAsBinary(nonces, "nonces", s);
+    cn::serializeAsBinary(versions, "major_versions", s);
+    cn::serializeAsBinary(versions, "minor_versions", s);
+  }
+
+  cn::BlockHeaderColumns loaded;
+  ASSERT_FALSE(cn::fromBinaryArray(loaded, data));
+}
+
+TEST_F(BlockHeaderColumnsCore, describeStoredBlocks) {
+  ASSERT_TRUE(startCore());
+  addBlocks(10);
+
+  checkHeadersMatchBlocks();
+}
+
+TEST_F(BlockHeaderColumnsCore, areLoadedWithCache) {
+  ASSERT_TRUE(startCore());
+  addBlocks(10);
+  ASSERT_TRUE(m_core->saveBlockchain());
+  stopCore();
+
+  ASSERT_TRUE(startCore());
+  checkHeadersMatchBlocks();
+}
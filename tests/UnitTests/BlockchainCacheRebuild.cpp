@@ -0,0 +1,166 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <memory>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteCore/VerificationContext.h"
+#include "Logging/LoggerGroup.h"
+#include "Logging/StreamLogger.h"
+
+#include "../TestGenerator/TestGenerator.h"
+
+namespace {
+const uint32_t PROGRESS_BLOCKS = 5;
+const uint32_t CHAIN_BLOCKS = 10;
+
+// A chain whose blocks are stored with a regular cache at its tail and a rebuild progress that stopped
+// PROGRESS_BLOCKS in, then the regular cache is lost so the next start has to rebuild
+class BlockchainCacheRebuild : public ::testing::Test {
+public:
+  BlockchainCacheRebuild() : m_currency(cn::CurrencyBuilder(m_logger).currency()), m_generator(m_currency), m_log(m_output, logging::INFO) {
+    m_logger.addLogger(m_log);
+  }
+
+  void SetUp() override {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    ASSERT_TRUE(boost::filesystem::create_directories(m_directory));
+
+    m_miner.generate();
+    m_tail = m_currency.genesisBlock();
+    std::vector<size_t> blockSizes;
+    m_generator.addBlock(m_tail, 0, 0, blockSizes, 0);
+
+    ASSERT_TRUE(startCore());
+    addBlocks(PROGRESS_BLOCKS);
+    ASSERT_TRUE(m_core->saveBlockchain());
+    copy(cacheFile(""), cacheFile(".rebuild"));
+    copy(cacheFile("transactionsmap.dat"), cacheFile(".rebuild.transactionsmap.dat"));
+    copy(cacheFile("spentkeys.dat"), cacheFile(".rebuild.spentkeys.dat"));
+
+    addBlocks(CHAIN_BLOCKS - PROGRESS_BLOCKS);
+    ASSERT_TRUE(m_core->saveBlockchain());
+    stopCore();
+
+    boost::filesystem::remove(cacheFile(""));
+    m_output.str("");
+  }
+
+  void TearDown() override {
+    stopCore();
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+protected:
+  bool startCore() {
+    cn::CoreConfig coreConfig;
+    coreConfig.configFolder = m_directory.string();
+    m_core.reset(new cn::core(m_currency, nullptr, m_logger));
+    return m_core->init(coreConfig, cn::MinerConfig(), true);
+  }
+
+  void stopCore() {
+    if (m_core) {
+      m_core->deinit();
+      m_core.reset();
+    }
+  }
+
+  void addBlocks(uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t height = cn::get_block_height(m_tail) + 1;
+      uint8_t majorVersion = height > m_currency.upgradeHeight(cn::BLOCK_MAJOR_VERSION_2) ? cn::BLOCK_MAJOR_VERSION_2 : cn::BLOCK_MAJOR_VERSION_1;
+      cn::Block block;
+      ASSERT_TRUE(m_generator.constructBlockManually(block, m_tail, m_miner, test_generator::bf_major_ver, majorVersion));
+
+      cn::block_verification_context bvc = boost::value_initialized<cn::block_verification_context>();
+      m_core->handle_incoming_block_blob(cn::toBinaryArray(block), bvc, false, false);
+      ASSERT_TRUE(bvc.m_added_to_main_chain);
+      m_tail = block;
+      m_coinbases.push_back(cn::getObjectHash(block.baseTransaction));
+    }
+  }
+
+  // blockscache.dat followed by suffix in the data directory, side files of the regular cache have no dot
+  std::string cacheFile(const std::string& suffix) const {
+    if (!suffix.empty() && suffix[0] != '.') {
+      return (m_directory / suffix).string();
+    }
+
+    return (m_directory / (m_currency.blocksCacheFileName() + suffix)).string();
+  }
+
+  void copy(const std::string& from, const std::string& to) {
+    boost::filesystem::remove(to);
+    boost::filesystem::copy_file(from, to);
+  }
+
+  bool resumed() const {
+    return m_output.str().find("Resuming cache rebuild from height " + std::to_string(PROGRESS_BLOCKS + 1)) != std::string::npos;
+  }
+
+  void checkRebuiltChain() {
+    ASSERT_EQ(CHAIN_BLOCKS + 1, m_core->get_current_blockchain_height());
+    ASSERT_EQ(cn::get_block_hash(m_tail), m_core->get_tail_id());
+    for (const auto& hash : m_coinbases) {
+      cn::Transaction transaction;
+      ASSERT_TRUE(m_core->getTransaction(hash, transaction));
+    }
+
+    ASSERT_TRUE(boost::filesystem::exists(cacheFile("")));
+    ASSERT_FALSE(boost::filesystem::exists(cacheFile(".rebuild")));
+    ASSERT_FALSE(boost::filesystem::exists(cacheFile(".rebuild.transactionsmap.dat")));
+    ASSERT_FALSE(boost::filesystem::exists(cacheFile(".rebuild.spentkeys.dat")));
+  }
+
+  logging::LoggerGroup m_logger;
+  cn::Currency m_currency;
+  test_generator m_generator;
+  std::ostringstream m_output;
+  logging::StreamLogger m_log;
+  cn::AccountBase m_miner;
+  cn::Block m_tail;
+  std::vector<crypto::Hash> m_coinbases;
+  boost::filesystem::path m_directory;
+  std::unique_ptr<cn::core> m_core;
+};
+}
+
+TEST_F(BlockchainCacheRebuild, resumesFromProgressWithItsOwnSideFiles) {
+  ASSERT_TRUE(startCore());
+
+  ASSERT_TRUE(resumed());
+  checkRebuiltChain();
+}
+
+TEST_F(BlockchainCacheRebuild, rebuildsFromScratchWhenSideFileHasAnotherTail) {
+  // the transaction map of the regular cache ends with the chain, not with the progress
+  copy(cacheFile("transactionsmap.dat"), cacheFile(".rebuild.transactionsmap.dat"));
+
+  ASSERT_TRUE(startCore());
+
+  ASSERT_FALSE(resumed());
+  checkRebuiltChain();
+}
+
+TEST_F(BlockchainCacheRebuild, rebuildsFromScratchWithoutProgressSideFiles) {
+  // progress side files used to share the names of the regular ones
+  boost::filesystem::remove(cacheFile(".rebuild.transactionsmap.dat"));
+  boost::filesystem::remove(cacheFile(".rebuild.spentkeys.dat"));
+
+  ASSERT_TRUE(startCore());
+
+  ASSERT_FALSE(resumed());
+  checkRebuiltChain();
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "HTTP/HttpParser.h"
+#include "HTTP/HttpParserErrorCodes.h"
+
+namespace {
+// Serves the data in reads of at most chunkSize bytes and records the body capacity seen by each read
+class StringReader {
+public:
+  StringReader(const std::string& data, size_t chunkSize) : m_data(data), m_position(0), m_chunkSize(chunkSize) {
+  }
+
+  size_t read(char* data, size_t size) {
+    m_largestRead = std::max(m_largestRead, size);
+    size_t count = std::min(std::min(size, m_chunkSize), m_data.size() - m_position);
+    std::memcpy(data, m_data.data() + m_position, count);
+    m_position += count;
+    return count;
+  }
+
+  size_t position() const {
+    return m_position;
+  }
+
+  size_t largestRead() const {
+    return m_largestRead;
+  }
+
+private:
+  std::string m_data;
+  size_t m_position;
+  size_t m_chunkSize;
+  size_t m_largestRead = 0;
+};
+
+std::string makeRequest(const std::string& contentLength, const std::string& body) {
+  return "POST /json_rpc HTTP/1.1\r\nContent-Length: " + contentLength + "\r\n\r\n" + body;
+}
+}
+
+TEST(HttpParser, readsBodyArrivingInPieces) {
+  std::string body(200000, 'x');
+  StringReader reader(makeRequest(std::to_string(body.size()), body), 1000);
+  cn::HttpInputBuffer input([&reader](char* data, size_t size) { return reader.read(data, size); });
+  cn::HttpRequest request;
+  cn::HttpParser().receiveRequest(input, request);
+  ASSERT_EQ(body, request.getBody());
+}
+
+TEST(HttpParser, bodyGrowsWithArrivingData) {
+  // the peer announces far more than it sends, the body is not sized to the announcement
+  StringReader reader(makeRequest("100000000000", std::string(100, 'x')), 1000);
+  cn::HttpInputBuffer input([&reader](char* data, size_t size) { return reader.read(data, size); });
+  cn::HttpRequest request;
+  ASSERT_THROW(cn::HttpParser().receiveRequest(input, request), std::system_error);
+  ASSERT_GE(65536, reader.largestRead());
+}
+
+TEST(HttpParser, rejectsBodyAboveLimitBeforeReadingIt) {
+  std::string data = makeRequest("100000000000", std::string(100, 'x'));
+  StringReader reader(data, data.size());
+  cn::HttpInputBuffer input([&reader](char* data, size_t size) { return reader.read(data, size); });
+  cn::HttpRequest request;
+  try {
+    cn::HttpParser().receiveRequest(input, request, 1024 * 1024);
+    FAIL();
+  } catch (std::system_error& e) {
+    ASSERT_EQ(make_error_code(cn::error::HttpParserErrorCodes::BODY_TOO_LARGE), e.code());
+  }
+
+  ASSERT_TRUE(request.getBody().empty());
+}
@@ -0,0 +1,191 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Timer.h>
+
+#include "Logging/LoggerGroup.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/HttpServer.h"
+
+namespace {
+const uint16_t HTTP_PORT = 32482;
+const std::chrono::milliseconds HANDLER_DURATION(50);
+
+// /concurrent is handled through runConcurrently, waiting on the dispatcher it gets; /direct inline
+class TestServer : public cn::HttpServer {
+public:
+  TestServer(platform_system::Dispatcher& dispatcher, logging::ILogger& log) : HttpServer(dispatcher, log) {
+  }
+
+  void processRequest(const cn::HttpRequest& request, cn::HttpResponse& response) override {
+    if (request.getUrl() == "/direct") {
+      record(m_dispatcher);
+      response.setBody("direct");
+      return;
+    }
+
+    if (request.getUrl() != "/concurrent") {
+      response.setStatus(cn::HttpResponse::STATUS_404);
+      return;
+    }
+
+    runConcurrently([&](platform_system::Dispatcher& dispatcher) {
+      record(dispatcher);
+      enter();
+      platform_system::Timer(dispatcher).sleep(HANDLER_DURATION);
+      leave();
+      response.setBody(request.getBody());
+    });
+  }
+
+  std::vector<std::pair<platform_system::Dispatcher*, std::thread::id>> handlers() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_handlers;
+  }
+
+  // most concurrent handlers running at once
+  size_t peak() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_peak;
+  }
+
+private:
+  void record(platform_system::Dispatcher& dispatcher) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_handlers.emplace_back(&dispatcher, std::this_thread::get_id());
+  }
+
+  void enter() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peak = std::max(m_peak, ++m_running);
+  }
+
+  void leave() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --m_running;
+  }
+
+  std::mutex m_mutex;
+  std::vector<std::pair<platform_system::Dispatcher*, std::thread::id>> m_handlers;
+  size_t m_running = 0;
+  size_t m_peak = 0;
+};
+
+class HttpServerTest : public ::testing::Test {
+public:
+  HttpServerTest() : m_server(m_dispatcher, m_logger) {
+  }
+
+  void TearDown() override {
+    m_server.stop();
+  }
+
+protected:
+  cn::HttpResponse request(const std::string& url, const std::string& body = std::string()) {
+    cn::HttpRequest req;
+    req.setUrl(url);
+    req.setBody(body);
+    cn::HttpResponse res;
+    cn::HttpClient client(m_dispatcher, "127.0.0.1", HTTP_PORT);
+    client.request(req, res);
+    return res;
+  }
+
+  // sends the requests at once from contexts of their own, answers in the order of the requests
+  std::vector<cn::HttpResponse> requestAtOnce(const std::string& url, size_t count) {
+    std::vector<cn::HttpResponse> responses(count);
+    platform_system::ContextGroup clients(m_dispatcher);
+    for (size_t i = 0; i < count; ++i) {
+      clients.spawn([&, i] { responses[i] = request(url, std::to_string(i)); });
+    }
+
+    clients.wait();
+    return responses;
+  }
+
+  platform_system::Dispatcher m_dispatcher;
+  logging::LoggerGroup m_logger;
+  TestServer m_server;
+};
+}
+
+TEST_F(HttpServerTest, runsConcurrentHandlersOnPoolDispatchers) {
+  m_server.setWorkerThreads(2);
+  m_server.start("127.0.0.1", HTTP_PORT);
+
+  auto responses = requestAtOnce("/concurrent", 4);
+  for (size_t i = 0; i < responses.size(); ++i) {
+    ASSERT_EQ(cn::HttpResponse::STATUS_200, responses[i].getStatus());
+    ASSERT_EQ(std::to_string(i), responses[i].getBody());
+  }
+
+  auto handlers = m_server.handlers();
+  ASSERT_EQ(4, handlers.size());
+  for (const auto& handler : handlers) {
+    ASSERT_NE(&m_dispatcher, handler.first);
+    ASSERT_NE(std::this_thread::get_id(), handler.second);
+  }
+
+  ASSERT_GE(m_server.peak(), 2);
+}
+
+TEST_F(HttpServerTest, runsOtherHandlersOnServerDispatcher) {
+  m_server.setWorkerThreads(2);
+  m_server.start("127.0.0.1", HTTP_PORT);
+
+  auto response = request("/direct");
+  ASSERT_EQ("direct", response.getBody());
+  ASSERT_EQ(cn::HttpResponse::STATUS_404, request("/unknown").getStatus());
+
+  auto handlers = m_server.handlers();
+  ASSERT_EQ(1, handlers.size());
+  ASSERT_EQ(&m_dispatcher, handlers[0].first);
+  ASSERT_EQ(std::this_thread::get_id(), handlers[0].second);
+}
+
+TEST_F(HttpServerTest, runsConcurrentHandlersOnServerDispatcherWithoutPool) {
+  m_server.setWorkerThreads(0);
+  m_server.start("127.0.0.1", HTTP_PORT);
+
+  auto responses = requestAtOnce("/concurrent", 2);
+  ASSERT_EQ("0", responses[0].getBody());
+  ASSERT_EQ("1", responses[1].getBody());
+
+  for (const auto& handler : m_server.handlers()) {
+    ASSERT_EQ(&m_dispatcher, handler.first);
+    ASSERT_EQ(std::this_thread::get_id(), handler.second);
+  }
+}
+
+TEST_F(HttpServerTest, limitsConcurrentHandlers) {
+  m_server.setWorkerThreads(2);
+  m_server.setMaxConcurrentRequests(1);
+  m_server.start("127.0.0.1", HTTP_PORT);
+
+  auto responses = requestAtOnce("/concurrent", 3);
+  for (size_t i = 0; i < responses.size(); ++i) {
+    ASSERT_EQ(std::to_string(i), responses[i].getBody());
+  }
+
+  ASSERT_EQ(1, m_server.peak());
+}
+
+TEST_F(HttpServerTest, refusesTooLargeBody) {
+  m_server.setMaxRequestBodySize(16);
+  m_server.start("127.0.0.1", HTTP_PORT);
+
+  ASSERT_EQ(cn::HttpResponse::STATUS_413, request("/concurrent", std::string(100, 'x')).getStatus());
+  ASSERT_EQ("small", request("/concurrent", "small").getBody());
+  ASSERT_EQ(1, m_server.handlers().size());
+}
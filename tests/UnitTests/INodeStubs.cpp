@@ -150,6 +150,37 @@ void INodeTrivialRefreshStub::doGetTransactionOutsGlobalIndices(const crypto::Ha
   }
 }
 
+void INodeTrivialRefreshStub::getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback)
+{
+  m_asyncCounter.addAsyncContext();
+  std::unique_lock<std::mutex> lock(m_walletLock);
+  calls_getTransactionOutsGlobalIndices.insert(calls_getTransactionOutsGlobalIndices.end(), transactionHashes.begin(), transactionHashes.end());
+  std::thread task(&INodeTrivialRefreshStub::doGetTransactionsOutsGlobalIndices, this, transactionHashes, std::ref(outsGlobalIndices), callback);
+  task.detach();
+}
+
+void INodeTrivialRefreshStub::doGetTransactionsOutsGlobalIndices(std::vector<crypto::Hash> transactionHashes, std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) {
+  ContextCounterHolder counterHolder(m_asyncCounter);
+  outsGlobalIndices.resize(transactionHashes.size());
+
+  for (size_t i = 0; i < transactionHashes.size(); ++i) {
+    std::unique_lock<std::mutex> lock(m_walletLock);
+    bool success = m_blockchainGenerator.getTransactionGlobalIndexesByHash(transactionHashes[i], outsGlobalIndices[i]);
+    lock.unlock();
+
+    if (consumerTests) {
+      outsGlobalIndices[i].clear();
+      outsGlobalIndices[i].resize(20);
+      getGlobalOutsFunctor(transactionHashes[i], outsGlobalIndices[i]);
+    } else if (!success) {
+      callback(std::make_error_code(std::errc::invalid_argument));
+      return;
+    }
+  }
+
+  callback(std::error_code());
+}
+
 void INodeTrivialRefreshStub::relayTransaction(const Transaction& transaction, const Callback& callback)
 {
   m_asyncCounter.addAsyncContext();
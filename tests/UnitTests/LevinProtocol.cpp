@@ -0,0 +1,41 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "P2p/LevinProtocol.h"
+
+using namespace cn;
+
+namespace {
+// offsets of the body size, the return code and the flags in the packed header
+const size_t BODY_SIZE_OFFSET = 8;
+const size_t RETURN_CODE_OFFSET = 21;
+const size_t FLAGS_OFFSET = 25;
+
+template <typename T>
+T readField(const LevinProtocol::Packet& packet, size_t offset) {
+  T value;
+  std::memcpy(&value, packet.header.data() + offset, sizeof(value));
+  return value;
+}
+}
+
+TEST(LevinProtocol, messageHeaderDescribesBody) {
+  auto packet = LevinProtocol::makeMessage(1001, BinaryArray(100, 7), true);
+
+  ASSERT_EQ(100, packet->body.size());
+  ASSERT_EQ(100, readField<uint64_t>(*packet, BODY_SIZE_OFFSET));
+  ASSERT_EQ(1, readField<uint32_t>(*packet, FLAGS_OFFSET));
+}
+
+TEST(LevinProtocol, replyHeaderCarriesReturnCode) {
+  auto packet = LevinProtocol::makeReply(1001, BinaryArray(10, 7), -6);
+
+  ASSERT_EQ(10, readField<uint64_t>(*packet, BODY_SIZE_OFFSET));
+  ASSERT_EQ(-6, readField<int32_t>(*packet, RETURN_CODE_OFFSET));
+  ASSERT_EQ(2, readField<uint32_t>(*packet, FLAGS_OFFSET));
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "CryptoNoteCore/LongHashPool.h"
+
+namespace {
+crypto::Hash makeHash(uint8_t value) {
+  crypto::Hash hash = crypto::Hash();
+  hash.data[0] = value;
+  return hash;
+}
+}
+
+TEST(LongHashPool, takeForgetsTheHash) {
+  cn::LongHashPool pool(10, 1);
+  cn::Block block = cn::Block();
+  pool.compute(block, makeHash(1));
+
+  crypto::Hash longHash;
+  ASSERT_TRUE(pool.take(makeHash(1), longHash));
+  ASSERT_FALSE(pool.take(makeHash(1), longHash));
+}
+
+TEST(LongHashPool, evictsOldestAtCapacity) {
+  cn::LongHashPool pool(2, 1);
+  cn::Block block = cn::Block();
+  pool.compute(block, makeHash(1));
+  pool.compute(block, makeHash(2));
+  pool.compute(block, makeHash(3));
+
+  crypto::Hash longHash;
+  ASSERT_FALSE(pool.take(makeHash(1), longHash));
+  ASSERT_TRUE(pool.take(makeHash(2), longHash));
+  ASSERT_TRUE(pool.take(makeHash(3), longHash));
+}
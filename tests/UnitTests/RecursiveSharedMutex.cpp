@@ -0,0 +1,148 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/RecursiveSharedMutex.h"
+
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+bool tryLockOnOtherThread(tools::RecursiveSharedMutex& mutex) {
+  bool locked = false;
+  std::thread other([&mutex, &locked] {
+    locked = mutex.try_lock();
+    if (locked) {
+      mutex.unlock();
+    }
+  });
+
+  other.join();
+  return locked;
+}
+}
+
+TEST(RecursiveSharedMutex, sharedOwnershipIsRecursive) {
+  tools::RecursiveSharedMutex mutex;
+  mutex.lock_shared();
+  mutex.lock_shared();
+  mutex.lock_shared();
+  mutex.unlock_shared();
+  mutex.unlock_shared();
+  ASSERT_FALSE(tryLockOnOtherThread(mutex));
+
+  mutex.unlock_shared();
+  ASSERT_TRUE(tryLockOnOtherThread(mutex));
+}
+
+TEST(RecursiveSharedMutex, exclusiveOwnershipIsRecursive) {
+  tools::RecursiveSharedMutex mutex;
+  mutex.lock();
+  mutex.lock();
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+  mutex.unlock();
+  ASSERT_FALSE(tryLockOnOtherThread(mutex));
+
+  mutex.unlock();
+  ASSERT_TRUE(tryLockOnOtherThread(mutex));
+}
+
+TEST(RecursiveSharedMutex, sharedInsideExclusiveKeepsExclusiveOwnership) {
+  tools::RecursiveSharedMutex mutex;
+  mutex.lock();
+  mutex.lock_shared();
+  mutex.unlock_shared();
+  ASSERT_FALSE(tryLockOnOtherThread(mutex));
+
+  mutex.unlock();
+  ASSERT_TRUE(tryLockOnOtherThread(mutex));
+
+  // nothing of the shared lock is left behind, the thread may lock exclusively again
+  mutex.lock();
+  mutex.unlock();
+}
+
+TEST(RecursiveSharedMutex, upgradeThrows) {
+  tools::RecursiveSharedMutex mutex;
+  mutex.lock_shared();
+  ASSERT_THROW(mutex.lock(), std::logic_error);
+  mutex.unlock_shared();
+
+  ASSERT_TRUE(tryLockOnOtherThread(mutex));
+  mutex.lock();
+  mutex.unlock();
+}
+
+TEST(RecursiveSharedMutex, waitingWriterBlocksNewReadersOnly) {
+  tools::RecursiveSharedMutex mutex;
+  std::vector<char> order;
+  std::mutex orderMutex;
+  auto record = [&order, &orderMutex](char who) {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    order.push_back(who);
+  };
+
+  mutex.lock_shared();
+  std::thread writer([&] {
+    mutex.lock();
+    record('w');
+    mutex.unlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  std::thread reader([&] {
+    mutex.lock_shared();
+    record('r');
+    mutex.unlock_shared();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  // the thread that already reads re-enters despite the waiting writer
+  mutex.lock_shared();
+  mutex.unlock_shared();
+  {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    ASSERT_TRUE(order.empty());
+  }
+
+  mutex.unlock_shared();
+  writer.join();
+  reader.join();
+  ASSERT_EQ((std::vector<char>{ 'w', 'r' }), order);
+}
+
+TEST(RecursiveSharedMutex, tracksSharedDepthPerMutex) {
+  tools::RecursiveSharedMutex first;
+  tools::RecursiveSharedMutex second;
+  tools::RecursiveSharedMutex third;
+  first.lock_shared();
+  first.lock_shared();
+  second.lock_shared();
+  third.lock_shared();
+
+  third.unlock_shared();
+  ASSERT_TRUE(tryLockOnOtherThread(third));
+  ASSERT_FALSE(tryLockOnOtherThread(first));
+  ASSERT_FALSE(tryLockOnOtherThread(second));
+
+  first.unlock_shared();
+  ASSERT_FALSE(tryLockOnOtherThread(first));
+  second.unlock_shared();
+  ASSERT_TRUE(tryLockOnOtherThread(second));
+
+  first.unlock_shared();
+  ASSERT_TRUE(tryLockOnOtherThread(first));
+
+  // no depth is left for any of them, each one may be locked exclusively
+  first.lock();
+  second.lock();
+  third.lock();
+  third.unlock();
+  second.unlock();
+  first.unlock();
+}
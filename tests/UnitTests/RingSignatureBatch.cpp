@@ -0,0 +1,129 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "crypto/crypto.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+// bytes that do not decode to a curve point
+template <typename T>
+T makeInvalidPoint() {
+  T value;
+  do {
+    value = crypto::rand<T>();
+  } while (crypto::check_key(reinterpret_cast<const crypto::PublicKey&>(value)));
+
+  return value;
+}
+
+enum class Kind {
+  valid,
+  forged,
+  wrongPrefix,
+  invalidImage,
+  invalidKey
+};
+
+struct Ring {
+  crypto::Hash prefixHash;
+  crypto::KeyImage image;
+  std::vector<crypto::PublicKey> keys;
+  std::vector<const crypto::PublicKey*> pubs;
+  std::vector<crypto::Signature> sigs;
+  Kind kind;
+};
+
+std::unique_ptr<Ring> makeRing(size_t size, Kind kind, const std::vector<crypto::PublicKey>& decoys) {
+  std::unique_ptr<Ring> ring(new Ring());
+  ring->kind = kind;
+  ring->prefixHash = crypto::rand<crypto::Hash>();
+
+  crypto::SecretKey secretKey;
+  size_t realIndex = size / 2;
+  for (size_t i = 0; i < size; ++i) {
+    if (i == realIndex) {
+      crypto::PublicKey publicKey;
+      crypto::generate_keys(publicKey, secretKey);
+      ring->keys.push_back(publicKey);
+    } else {
+      // decoys are shared by several rings, as outputs are used by several transactions of a block
+      ring->keys.push_back(decoys[i % decoys.size()]);
+    }
+  }
+
+  crypto::generate_key_image(ring->keys[realIndex], secretKey, ring->image);
+  for (const auto& key : ring->keys) {
+    ring->pubs.push_back(&key);
+  }
+
+  ring->sigs.resize(size);
+  crypto::generate_ring_signature(ring->prefixHash, ring->image, ring->pubs.data(), size, secretKey, realIndex, ring->sigs.data());
+
+  switch (kind) {
+  case Kind::forged:
+    ring->sigs[0].data[0] ^= 1;
+    break;
+  case Kind::wrongPrefix:
+    ring->prefixHash = crypto::rand<crypto::Hash>();
+    break;
+  case Kind::invalidImage:
+    ring->image = makeInvalidPoint<crypto::KeyImage>();
+    break;
+  case Kind::invalidKey:
+    ring->keys[0] = makeInvalidPoint<crypto::PublicKey>();
+    break;
+  default:
+    break;
+  }
+
+  return ring;
+}
+
+}
+
+TEST(RingSignatureBatch, matchesSingleChecks) {
+  std::vector<crypto::PublicKey> decoys(8);
+  for (auto& decoy : decoys) {
+    crypto::SecretKey secretKey;
+    crypto::generate_keys(decoy, secretKey);
+  }
+
+  const size_t sizes[] = { 1, 2, 3, 5, 11 };
+  const Kind kinds[] = { Kind::valid, Kind::forged, Kind::valid, Kind::wrongPrefix, Kind::invalidImage, Kind::invalidKey, Kind::valid };
+  std::vector<std::unique_ptr<Ring>> rings;
+  for (size_t size : sizes) {
+    for (Kind kind : kinds) {
+      rings.push_back(makeRing(size, kind, decoys));
+    }
+  }
+
+  std::vector<crypto::RingSignatureBatchItem> items;
+  for (const auto& ring : rings) {
+    items.push_back(crypto::RingSignatureBatchItem{ &ring->prefixHash, &ring->image, ring->pubs.data(), ring->pubs.size(), ring->sigs.data() });
+  }
+
+  std::unique_ptr<bool[]> batchResults(new bool[items.size()]);
+  crypto::check_ring_signatures(items.data(), items.size(), batchResults.get());
+
+  for (size_t i = 0; i < rings.size(); ++i) {
+    const Ring& ring = *rings[i];
+    if (ring.kind == Kind::invalidKey) {
+      // check_ring_signature requires valid keys, the batch only fails the ring using the invalid one
+      ASSERT_FALSE(batchResults[i]) << "ring " << i;
+      continue;
+    }
+
+    bool single = crypto::check_ring_signature(ring.prefixHash, ring.image, ring.pubs.data(), ring.pubs.size(), ring.sigs.data());
+    ASSERT_EQ(ring.kind == Kind::valid, single) << "ring " << i;
+    ASSERT_EQ(single, batchResults[i]) << "ring " << i;
+  }
+}
+
+TEST(RingSignatureBatch, acceptsEmptyBatch) {
+  crypto::check_ring_signatures(nullptr, 0, nullptr);
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "CryptoNoteCore/RingSignatureCache.h"
+
+namespace {
+crypto::Hash makeHash(uint8_t value) {
+  crypto::Hash hash = crypto::Hash();
+  hash.data[0] = value;
+  return hash;
+}
+}
+
+TEST(RingSignatureCache, hitsOnlyWithSameRings) {
+  cn::RingSignatureCache cache(10);
+  ASSERT_FALSE(cache.contains(makeHash(1), makeHash(100), true));
+
+  cache.insert(makeHash(1), makeHash(100));
+  ASSERT_TRUE(cache.contains(makeHash(1), makeHash(100), true));
+  ASSERT_FALSE(cache.contains(makeHash(1), makeHash(101), true));
+  ASSERT_FALSE(cache.contains(makeHash(2), makeHash(100), true));
+
+  ASSERT_EQ(1, cache.hits());
+  ASSERT_EQ(3, cache.misses());
+}
+
+TEST(RingSignatureCache, countsOnlyCountedLookups) {
+  cn::RingSignatureCache cache(10);
+  cache.insert(makeHash(1), makeHash(100));
+  ASSERT_TRUE(cache.contains(makeHash(1), makeHash(100)));
+  ASSERT_FALSE(cache.contains(makeHash(2), makeHash(100)));
+  ASSERT_EQ(0, cache.hits());
+  ASSERT_EQ(0, cache.misses());
+
+  ASSERT_TRUE(cache.contains(makeHash(1), makeHash(100), true));
+  ASSERT_EQ(1, cache.hits());
+  ASSERT_EQ(0, cache.misses());
+}
+
+TEST(RingSignatureCache, evictsLeastRecentlyUsed) {
+  cn::RingSignatureCache cache(2);
+  cache.insert(makeHash(1), makeHash(100));
+  cache.insert(makeHash(2), makeHash(100));
+  ASSERT_TRUE(cache.contains(makeHash(1), makeHash(100)));
+
+  cache.insert(makeHash(3), makeHash(100));
+  ASSERT_EQ(2, cache.size());
+  ASSERT_TRUE(cache.contains(makeHash(1), makeHash(100)));
+  ASSERT_FALSE(cache.contains(makeHash(2), makeHash(100)));
+  ASSERT_TRUE(cache.contains(makeHash(3), makeHash(100)));
+}
+
+TEST(RingSignatureCache, disabledWithoutCapacity) {
+  cn::RingSignatureCache cache(0);
+  cache.insert(makeHash(1), makeHash(100));
+  ASSERT_EQ(0, cache.size());
+  ASSERT_FALSE(cache.contains(makeHash(1), makeHash(100)));
+}
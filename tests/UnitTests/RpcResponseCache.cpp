@@ -0,0 +1,76 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Rpc/RpcResponseCache.h"
+
+using cn::RpcResponseCache;
+
+TEST(RpcResponseCache, hitsUntilChainChanges) {
+  RpcResponseCache cache(1024 * 1024);
+  std::string response;
+  ASSERT_FALSE(cache.find("getlastblockheader\n", response));
+
+  cache.insert("getlastblockheader\n", "{\"height\":1}", RpcResponseCache::CHAIN, cache.version());
+  cache.insert("getcurrencyid\n", "{\"id\":1}", RpcResponseCache::STATIC, cache.version());
+  ASSERT_TRUE(cache.find("getlastblockheader\n", response));
+  ASSERT_EQ("{\"height\":1}", response);
+
+  cache.poolUpdated();
+  ASSERT_TRUE(cache.find("getlastblockheader\n", response));
+
+  cache.chainUpdated();
+  ASSERT_FALSE(cache.find("getlastblockheader\n", response));
+  ASSERT_TRUE(cache.find("getcurrencyid\n", response));
+
+  ASSERT_EQ(3, cache.hits());
+  ASSERT_EQ(2, cache.misses());
+}
+
+TEST(RpcResponseCache, nodeStateFollowsPool) {
+  RpcResponseCache cache(1024 * 1024);
+  std::string response;
+  cache.insert("/getinfo\n", "{}", RpcResponseCache::NODE_STATE, cache.version());
+  ASSERT_TRUE(cache.find("/getinfo\n", response));
+
+  cache.poolUpdated();
+  ASSERT_FALSE(cache.find("/getinfo\n", response));
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST(RpcResponseCache, dropsAnswersComputedAcrossUpdate) {
+  RpcResponseCache cache(1024 * 1024);
+  std::string response;
+  RpcResponseCache::Version version = cache.version();
+  cache.chainUpdated();
+
+  cache.insert("f_block_json\n{}", "{}", RpcResponseCache::CHAIN, version);
+  ASSERT_FALSE(cache.find("f_block_json\n{}", response));
+}
+
+TEST(RpcResponseCache, evictsLeastRecentlyUsedBeyondMemoryLimit) {
+  std::string answer(1000, 'x');
+  RpcResponseCache cache(2 * answer.size() + 1000);
+  cache.insert("a", answer, RpcResponseCache::STATIC, cache.version());
+  cache.insert("b", answer, RpcResponseCache::STATIC, cache.version());
+
+  std::string response;
+  ASSERT_TRUE(cache.find("a", response));
+
+  cache.insert("c", answer, RpcResponseCache::STATIC, cache.version());
+  ASSERT_EQ(2, cache.size());
+  ASSERT_LE(cache.memoryUsage(), 2 * answer.size() + 1000);
+  ASSERT_TRUE(cache.find("a", response));
+  ASSERT_FALSE(cache.find("b", response));
+  ASSERT_TRUE(cache.find("c", response));
+}
+
+TEST(RpcResponseCache, disabledWithoutMemory) {
+  RpcResponseCache cache(0);
+  cache.insert("a", "{}", RpcResponseCache::STATIC, cache.version());
+
+  std::string response;
+  ASSERT_EQ(0, cache.size());
+  ASSERT_FALSE(cache.find("a", response));
+}
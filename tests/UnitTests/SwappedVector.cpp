@@ -0,0 +1,123 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include "CryptoNoteCore/SwappedVector.h"
+
+namespace {
+struct Item {
+  static size_t alive;
+
+  Item() {
+    ++alive;
+  }
+
+  Item(const Item& other) : value(other.value) {
+    ++alive;
+  }
+
+  ~Item() {
+    --alive;
+  }
+
+  Item& operator=(const Item& other) = default;
+
+  uint64_t value = 0;
+
+  void serialize(cn::ISerializer& s) {
+    s(value, "value");
+  }
+};
+
+size_t Item::alive = 0;
+
+class SwappedVectorTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    m_itemsFilename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    m_indexesFilename = m_itemsFilename + ".indexes";
+  }
+
+  void TearDown() override {
+    boost::system::error_code ignore;
+    boost::filesystem::remove(m_itemsFilename, ignore);
+    boost::filesystem::remove(m_indexesFilename, ignore);
+  }
+
+  void fill(SwappedVector<Item>& vector, uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+      Item item;
+      item.value = i;
+      vector.push_back(item);
+    }
+  }
+
+protected:
+  std::string m_itemsFilename;
+  std::string m_indexesFilename;
+};
+}
+
+TEST_F(SwappedVectorTest, evictedItemOutlivesReadersThatMaySeeIt) {
+  SwappedVector<Item> vector;
+  ASSERT_TRUE(vector.open(m_itemsFilename, m_indexesFilename, 1));
+  fill(vector, 3);
+
+  uint64_t first = vector.addReader();
+  const Item& item = vector[0];
+  vector[1];
+  ASSERT_EQ(0, item.value);
+
+  uint64_t second = vector.addReader();
+  vector[2];
+  ASSERT_EQ(0, item.value);
+  ASSERT_EQ(4, Item::alive);
+
+  // the items evicted before the second reader came go with the first one
+  vector.removeReader(first);
+  ASSERT_EQ(2, Item::alive);
+
+  vector.removeReader(second);
+  ASSERT_EQ(1, Item::alive);
+}
+
+TEST_F(SwappedVectorTest, overlappingReadersDoNotKeepEvictedItems) {
+  SwappedVector<Item> vector;
+  ASSERT_TRUE(vector.open(m_itemsFilename, m_indexesFilename, 1));
+  fill(vector, 100);
+
+  uint64_t reader = vector.addReader();
+  for (uint64_t i = 0; i < 100; ++i) {
+    uint64_t next = vector.addReader();
+    ASSERT_EQ(i, vector[i].value);
+    vector.removeReader(reader);
+    reader = next;
+  }
+
+  // only the item evicted while the remaining reader is registered is kept
+  ASSERT_EQ(2, Item::alive);
+  vector.removeReader(reader);
+  ASSERT_EQ(1, Item::alive);
+}
+
+TEST_F(SwappedVectorTest, mappedMissesSeeItemsAppendedAfterMapping) {
+  SwappedVector<Item> vector;
+  ASSERT_TRUE(vector.open(m_itemsFilename, m_indexesFilename, 1, true));
+  fill(vector, 10);
+  for (uint64_t i = 0; i < 10; ++i) {
+    ASSERT_EQ(i, vector[i].value);
+  }
+
+  for (uint64_t i = 10; i < 1000; ++i) {
+    Item item;
+    item.value = i;
+    vector.push_back(item);
+  }
+
+  for (uint64_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(i, vector[i].value);
+  }
+}
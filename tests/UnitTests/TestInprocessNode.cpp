@@ -148,6 +148,22 @@ TEST_F(InProcessNodeTests, getTransactionOutsGlobalIndicesFailure) {
   ASSERT_NE(std::error_code(), status.getStatus());
 }
 
+TEST_F(InProcessNodeTests, getTransactionsOutsGlobalIndicesSuccess) {
+  std::vector<crypto::Hash> ignore(3);
+  std::vector<std::vector<uint32_t>> indices;
+  std::vector<uint32_t> expectedIndices = { 10, 11, 12 };
+  coreStub.set_outputs_gindexs(expectedIndices, true);
+
+  CallbackStatus status;
+  node.getTransactionsOutsGlobalIndices(ignore, indices, [&status] (std::error_code ec) { status.setStatus(ec); });
+  ASSERT_TRUE(status.ok());
+
+  ASSERT_EQ(ignore.size(), indices.size());
+  for (const auto& transactionIndices : indices) {
+    ASSERT_EQ(expectedIndices, transactionIndices);
+  }
+}
+
 TEST_F(InProcessNodeTests, getRandomOutsByAmountsSuccess) {
   crypto::PublicKey ignoredPublicKey;
   crypto::SecretKey ignoredSectetKey;
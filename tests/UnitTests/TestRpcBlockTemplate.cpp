@@ -0,0 +1,196 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Timer.h>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteCore/VerificationContext.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "Logging/LoggerGroup.h"
+#include "P2p/NetNode.h"
+#include "Rpc/CoreRpcServerErrorCodes.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/JsonRpc.h"
+#include "Rpc/RpcServer.h"
+
+#include "../TestGenerator/TestGenerator.h"
+
+using namespace cn;
+
+namespace {
+
+const uint16_t RPC_PORT = 32481;
+const std::chrono::milliseconds LONGPOLL_TIMEOUT(300);
+
+class RpcBlockTemplate : public ::testing::Test {
+public:
+  RpcBlockTemplate() : m_currency(CurrencyBuilder(m_logger).testnet(true).currency()), m_generator(m_currency) {
+  }
+
+  void SetUp() override {
+    m_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    ASSERT_TRUE(boost::filesystem::create_directories(m_directory));
+
+    CoreConfig coreConfig;
+    coreConfig.configFolder = m_directory.string();
+    m_core.reset(new core(m_currency, nullptr, m_logger));
+    ASSERT_TRUE(m_core->init(coreConfig, MinerConfig(), false));
+
+    m_protocol.reset(new CryptoNoteProtocolHandler(m_currency, m_dispatcher, *m_core, nullptr, m_logger));
+    m_p2p.reset(new NodeServer(m_dispatcher, *m_protocol, m_logger));
+    m_server.reset(new RpcServer(m_dispatcher, m_logger, *m_core, *m_p2p, *m_protocol));
+    m_server->setBlockTemplateLongPollTimeout(LONGPOLL_TIMEOUT);
+    m_server->start("127.0.0.1", RPC_PORT);
+
+    m_miner.generate();
+    m_address = m_currency.accountAddressAsString(m_miner);
+    m_tail = m_currency.genesisBlock();
+    std::vector<size_t> blockSizes;
+    m_generator.addBlock(m_tail, 0, 0, blockSizes, 0);
+  }
+
+  void TearDown() override {
+    if (m_server) {
+      m_server->stop();
+      m_server.reset();
+    }
+
+    m_p2p.reset();
+    m_protocol.reset();
+    if (m_core) {
+      m_core->deinit();
+      m_core.reset();
+    }
+
+    boost::system::error_code ignore;
+    boost::filesystem::remove_all(m_directory, ignore);
+  }
+
+protected:
+  COMMAND_RPC_GETBLOCKTEMPLATE::response getBlockTemplate(const std::string& templateId = "") {
+    COMMAND_RPC_GETBLOCKTEMPLATE::request req = COMMAND_RPC_GETBLOCKTEMPLATE::request();
+    req.wallet_address = m_address;
+    req.template_id = templateId;
+    COMMAND_RPC_GETBLOCKTEMPLATE::response res;
+    HttpClient client(m_dispatcher, "127.0.0.1", RPC_PORT);
+    JsonRpc::invokeJsonRpcCommand(client, "getblocktemplate", req, res);
+    return res;
+  }
+
+  void submitBlock(const COMMAND_RPC_SUBMITBLOCK::request& req) {
+    COMMAND_RPC_SUBMITBLOCK::response res;
+    HttpClient client(m_dispatcher, "127.0.0.1", RPC_PORT);
+    JsonRpc::invokeJsonRpcCommand(client, "submitblock", req, res);
+  }
+
+  // moves the tip the way a block from a peer does
+  void addBlock() {
+    Block block;
+    uint32_t height = get_block_height(m_tail) + 1;
+    uint8_t majorVersion = height > m_currency.upgradeHeight(BLOCK_MAJOR_VERSION_2) ? BLOCK_MAJOR_VERSION_2 : BLOCK_MAJOR_VERSION_1;
+    ASSERT_TRUE(m_generator.constructBlockManually(block, m_tail, m_miner, test_generator::bf_major_ver, majorVersion));
+
+    block_verification_context bvc = boost::value_initialized<block_verification_context>();
+    m_core->handle_incoming_block_blob(toBinaryArray(block), bvc, false, false);
+    ASSERT_TRUE(bvc.m_added_to_main_chain);
+    m_tail = block;
+  }
+
+  int rpcErrorCode(const std::function<void()>& call) {
+    try {
+      call();
+    } catch (JsonRpc::JsonRpcError& e) {
+      return e.code;
+    }
+
+    return 0;
+  }
+
+  platform_system::Dispatcher m_dispatcher;
+  logging::LoggerGroup m_logger;
+  Currency m_currency;
+  test_generator m_generator;
+  AccountBase m_miner;
+  std::string m_address;
+  Block m_tail;
+  boost::filesystem::path m_directory;
+  std::unique_ptr<core> m_core;
+  std::unique_ptr<CryptoNoteProtocolHandler> m_protocol;
+  std::unique_ptr<NodeServer> m_p2p;
+  std::unique_ptr<RpcServer> m_server;
+};
+}
+
+TEST_F(RpcBlockTemplate, longPollReturnsWhenTipChanges) {
+  auto current = getBlockTemplate();
+
+  bool returned = false;
+  COMMAND_RPC_GETBLOCKTEMPLATE::response next;
+  platform_system::ContextGroup poll(m_dispatcher);
+  poll.spawn([&] {
+    next = getBlockTemplate(current.template_id);
+    returned = true;
+  });
+
+  platform_system::Timer(m_dispatcher).sleep(LONGPOLL_TIMEOUT / 3);
+  ASSERT_FALSE(returned);
+
+  auto start = std::chrono::steady_clock::now();
+  addBlock();
+  poll.wait();
+
+  ASSERT_TRUE(returned);
+  ASSERT_LT(std::chrono::steady_clock::now() - start, LONGPOLL_TIMEOUT / 3);
+  ASSERT_EQ(current.height + 1, next.height);
+  ASSERT_NE(current.template_id, next.template_id);
+}
+
+TEST_F(RpcBlockTemplate, longPollTimesOutWithSameTemplate) {
+  auto current = getBlockTemplate();
+
+  auto start = std::chrono::steady_clock::now();
+  auto next = getBlockTemplate(current.template_id);
+
+  ASSERT_GE(std::chrono::steady_clock::now() - start, LONGPOLL_TIMEOUT);
+  ASSERT_EQ(current.height, next.height);
+  ASSERT_EQ(current.template_id, next.template_id);
+}
+
+TEST_F(RpcBlockTemplate, longPollRejectsUnknownTemplateId) {
+  ASSERT_EQ(CORE_RPC_ERROR_CODE_WRONG_PARAM, rpcErrorCode([&] { getBlockTemplate("unknown"); }));
+}
+
+TEST_F(RpcBlockTemplate, submitBlockRejectsStaleTemplate) {
+  auto stale = getBlockTemplate();
+  addBlock();
+  uint32_t height = m_core->get_current_blockchain_height();
+
+  COMMAND_RPC_SUBMITBLOCK::request req = { stale.blocktemplate_blob, stale.template_id };
+  ASSERT_EQ(CORE_RPC_ERROR_CODE_BLOCK_NOT_ACCEPTED, rpcErrorCode([&] { submitBlock(req); }));
+  ASSERT_EQ(height, m_core->get_current_blockchain_height());
+}
+
+TEST_F(RpcBlockTemplate, submitBlockRejectsUnknownTemplateId) {
+  auto current = getBlockTemplate();
+
+  COMMAND_RPC_SUBMITBLOCK::request req = { current.blocktemplate_blob, "unknown" };
+  ASSERT_EQ(CORE_RPC_ERROR_CODE_WRONG_PARAM, rpcErrorCode([&] { submitBlock(req); }));
+
+  req[1] = current.template_id.substr(0, 2 * sizeof(crypto::Hash));
+  ASSERT_EQ(CORE_RPC_ERROR_CODE_WRONG_PARAM, rpcErrorCode([&] { submitBlock(req); }));
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "Common/StringTools.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "P2p/LevinProtocol.h"
+#include "Logging/LoggerGroup.h"
+#include "System/Dispatcher.h"
+
+#include "ICoreStub.h"
+
+using namespace cn;
+
+namespace {
+
+// holds the proof of work hashing of the first committed block until released
+class BlockingCoreStub : public ICoreStub {
+public:
+  virtual void precomputeProofOfWork(const Block& b, const crypto::Hash& blockHash) override {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (++hashed == 1) {
+      changed.notify_all();
+      if (!changed.wait_for(lock, std::chrono::seconds(10), [this] { return released; })) {
+        timedOut = true;
+      }
+    }
+  }
+
+  void waitHashing() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return hashed != 0; });
+  }
+
+  // false if the hashing gave up waiting before
+  bool release() {
+    std::unique_lock<std::mutex> lock(mutex);
+    released = true;
+    changed.notify_all();
+    return !timedOut;
+  }
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  size_t hashed = 0;
+  bool released = false;
+  bool timedOut = false;
+};
+
+NOTIFY_RESPONSE_GET_OBJECTS::request makeResponse(uint64_t timestamp, crypto::Hash& blockHash) {
+  Block block = Block();
+  block.majorVersion = BLOCK_MAJOR_VERSION_1;
+  block.timestamp = timestamp;
+  blockHash = get_block_hash(block);
+
+  block_complete_entry entry;
+  entry.block = common::asString(toBinaryArray(block));
+
+  NOTIFY_RESPONSE_GET_OBJECTS::request response;
+  response.blocks.push_back(entry);
+  response.current_blockchain_height = 10;
+  return response;
+}
+
+CryptoNoteConnectionContext makeSynchronizingContext(uint8_t id) {
+  CryptoNoteConnectionContext context;
+  context.m_connection_id.data[0] = id;
+  context.m_state = CryptoNoteConnectionContext::state_synchronizing;
+  return context;
+}
+
+}
+
+TEST(SyncPipeline, parsesNextBatchWhileCommittingPrevious) {
+  platform_system::Dispatcher dispatcher;
+  logging::LoggerGroup logger;
+  BlockingCoreStub core;
+  CryptoNoteProtocolHandler handler(core.currency(), dispatcher, core, nullptr, logger);
+
+  // the first batch leaves more blocks to request, so its commit goes on in the background
+  crypto::Hash firstHash;
+  auto first = makeResponse(1, firstHash);
+  CryptoNoteConnectionContext firstContext = makeSynchronizingContext(1);
+  firstContext.m_requested_objects.insert(firstHash);
+  firstContext.m_needed_objects.push_back(crypto::Hash());
+
+  BinaryArray out;
+  bool handled = false;
+  handler.handleCommand(true, NOTIFY_RESPONSE_GET_OBJECTS::ID, LevinProtocol::encode(first), out, firstContext, handled);
+  ASSERT_TRUE(handled);
+  core.waitHashing();
+
+  // a batch of another connection is parsed and queued while the first one is still being hashed
+  crypto::Hash secondHash;
+  auto second = makeResponse(2, secondHash);
+  CryptoNoteConnectionContext secondContext = makeSynchronizingContext(2);
+  secondContext.m_requested_objects.insert(secondHash);
+  secondContext.m_needed_objects.push_back(crypto::Hash());
+  handler.handleCommand(true, NOTIFY_RESPONSE_GET_OBJECTS::ID, LevinProtocol::encode(second), out, secondContext, handled);
+  ASSERT_EQ(CryptoNoteConnectionContext::state_synchronizing, secondContext.m_state);
+  ASSERT_TRUE(core.release());
+
+  // the last batch of the first connection waits for every batch queued before it
+  crypto::Hash lastHash;
+  auto last = makeResponse(3, lastHash);
+  firstContext.m_requested_objects = { lastHash };
+  firstContext.m_needed_objects.clear();
+  handler.handleCommand(true, NOTIFY_RESPONSE_GET_OBJECTS::ID, LevinProtocol::encode(last), out, firstContext, handled);
+  ASSERT_EQ(3, core.hashed);
+}
@@ -403,8 +403,8 @@ TEST_F(TransfersConsumerTest, onNewBlocks_DifferentTimestamps) {
 TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesError) {
   class INodeGlobalIndicesStub: public INodeDummyStub {
   public:
-    virtual void getTransactionOutsGlobalIndices(const crypto::Hash& transactionHash,
-      std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override {
+    virtual void getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+      std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override {
       callback(std::make_error_code(std::errc::operation_canceled));
     };    
   };
@@ -519,14 +519,14 @@ TEST_F(TransfersConsumerTest, onNewBlocks_MultisignatureTransaction) {
 TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesIsProperlyCalled) {
   class INodeGlobalIndicesStub: public INodeDummyStub {
   public:
-    virtual void getTransactionOutsGlobalIndices(const crypto::Hash& transactionHash,
-      std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override {
-      outsGlobalIndices.push_back(3);
-      hash = transactionHash;
+    virtual void getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+      std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override {
+      outsGlobalIndices.assign(transactionHashes.size(), std::vector<uint32_t>(1, 3));
+      hashes = transactionHashes;
       callback(std::error_code());
     };
 
-    crypto::Hash hash;
+    std::vector<crypto::Hash> hashes;
   };
 
   INodeGlobalIndicesStub node;
@@ -549,7 +549,56 @@ TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesIsPrope
   ASSERT_TRUE(consumer.onNewBlocks(&block, 1, 1));
   const crypto::Hash &hash = tx->getTransactionHash();
   const crypto::Hash expectedHash = *reinterpret_cast<const crypto::Hash*>(&hash);
-  ASSERT_EQ(expectedHash, node.hash);
+  ASSERT_EQ(1, node.hashes.size());
+  ASSERT_EQ(expectedHash, node.hashes[0]);
+}
+
+TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesOnceForAllBlocks) {
+  class INodeGlobalIndicesStub: public INodeDummyStub {
+  public:
+    INodeGlobalIndicesStub() : calls(0) {};
+
+    virtual void getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+      std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override {
+      outsGlobalIndices.assign(transactionHashes.size(), std::vector<uint32_t>(1, 3));
+      hashes = transactionHashes;
+      ++calls;
+      callback(std::error_code());
+    };
+
+    size_t calls;
+    std::vector<crypto::Hash> hashes;
+  };
+
+  INodeGlobalIndicesStub node;
+  TransfersConsumer consumer(m_currency, node, m_logger, m_accountKeys.viewSecretKey);
+
+  AccountSubscription subscription = getAccountSubscription(m_accountKeys);
+  subscription.syncStart.height = 0;
+  subscription.syncStart.timestamp = 0;
+  consumer.addSubscription(subscription);
+
+  CompleteBlock blocks[3];
+  // no inputs, an unsigned input would leave every transaction with the same null hash
+  for (auto& block : blocks) {
+    std::shared_ptr<ITransaction> tx(createTransaction());
+    addTestKeyOutput(*tx, 900, 0, m_accountKeys);
+
+    block.block = cn::Block();
+    block.block->timestamp = 0;
+    block.transactions.push_back(tx);
+  }
+
+  std::shared_ptr<ITransaction> foreignTx(createTransaction());
+  addTestKeyOutput(*foreignTx, 900, 0, generateAccount());
+  blocks[1].transactions.push_back(foreignTx);
+
+  ASSERT_TRUE(consumer.onNewBlocks(blocks, 1, 3));
+  ASSERT_EQ(1, node.calls);
+  ASSERT_EQ(3, node.hashes.size());
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(blocks[i].transactions.front()->getTransactionHash(), node.hashes[i]);
+  }
 }
 
 TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesIsNotCalled) {
@@ -557,9 +606,9 @@ TEST_F(TransfersConsumerTest, onNewBlocks_getTransactionOutsGlobalIndicesIsNotCa
   public:
     INodeGlobalIndicesStub() : called(false) {};
 
-    virtual void getTransactionOutsGlobalIndices(const crypto::Hash& transactionHash,
-      std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override {
-      outsGlobalIndices.push_back(3);
+    virtual void getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+      std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override {
+      outsGlobalIndices.assign(transactionHashes.size(), std::vector<uint32_t>(1, 3));
       called = true;
       callback(std::error_code());
     };
@@ -625,9 +674,9 @@ TEST_F(TransfersConsumerTest, onNewBlocks_markTransactionConfirmed) {
 class INodeGlobalIndexStub: public INodeDummyStub {
 public:
 
-  virtual void getTransactionOutsGlobalIndices(const crypto::Hash& transactionHash,
-    std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override {
-    outsGlobalIndices.push_back(globalIndex);
+  virtual void getTransactionsOutsGlobalIndices(const std::vector<crypto::Hash>& transactionHashes,
+    std::vector<std::vector<uint32_t>>& outsGlobalIndices, const Callback& callback) override {
+    outsGlobalIndices.assign(transactionHashes.size(), std::vector<uint32_t>(1, globalIndex));
     callback(std::error_code());
   };
 
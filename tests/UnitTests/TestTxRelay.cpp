@@ -0,0 +1,351 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+
+#include "Common/StringTools.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/VerificationContext.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "Logging/LoggerGroup.h"
+#include "P2p/LevinProtocol.h"
+#include "System/Dispatcher.h"
+
+#include "ICoreStub.h"
+
+using namespace cn;
+
+namespace {
+
+const size_t NODE_COUNT = 8;
+const size_t TX_COUNT = 50;
+const size_t TX_EXTRA_SIZE = 2000;
+
+class RelayCoreStub : public ICoreStub {
+public:
+  virtual bool handle_incoming_tx(BinaryArray const& tx_blob, tx_verification_context& tvc, bool keeped_by_block) override {
+    Transaction tx;
+    if (!fromBinaryArray(tx, tx_blob)) {
+      tvc.m_verification_failed = true;
+      return false;
+    }
+
+    std::list<Transaction> txs;
+    std::list<crypto::Hash> missed;
+    getTransactions({ getObjectHash(tx) }, txs, missed, true);
+    if (missed.empty()) {
+      return true;
+    }
+
+    addTransaction(tx);
+    tvc.m_added_to_pool = true;
+    tvc.m_should_be_relayed = true;
+    ++accepted;
+    return true;
+  }
+
+  size_t accepted = 0;
+};
+
+boost::uuids::uuid connectionId(size_t from, size_t to) {
+  boost::uuids::uuid id = boost::uuids::uuid();
+  id.data[0] = static_cast<uint8_t>(from + 1);
+  id.data[1] = static_cast<uint8_t>(to + 1);
+  return id;
+}
+
+class TestNetwork;
+
+// delivers the messages of one node into the queue of the network
+class TestEndpoint : public IP2pEndpoint {
+public:
+  TestEndpoint(TestNetwork& network, size_t node) : m_network(network), m_node(node) {
+  }
+
+  virtual void relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) override;
+  virtual bool invoke_notify_to_peer(int command, const BinaryArray& req_buff, const CryptoNoteConnectionContext& context) override;
+  virtual uint64_t get_connections_count() override;
+  virtual void for_each_connection(const std::function<void(CryptoNoteConnectionContext&, PeerIdType)>& f) override;
+  virtual void drop_connection(CryptoNoteConnectionContext& context, bool add_fail) override {}
+  virtual void externalRelayNotifyToAll(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) override {
+    relay_notify_to_all(command, data_buff, excludeConnection);
+  }
+  virtual void externalRelayNotifyToList(int command, const BinaryArray& data_buff, const std::list<boost::uuids::uuid>& relayList) override;
+
+private:
+  TestNetwork& m_network;
+  size_t m_node;
+};
+
+struct TestNode {
+  TestNode(TestNetwork& network, size_t index, platform_system::Dispatcher& dispatcher, logging::ILogger& logger) :
+    endpoint(network, index),
+    handler(core.currency(), dispatcher, core, &endpoint, logger) {
+  }
+
+  RelayCoreStub core;
+  TestEndpoint endpoint;
+  CryptoNoteProtocolHandler handler;
+  std::map<size_t, CryptoNoteConnectionContext> peers;
+};
+
+// full mesh of protocol handlers connected by an in memory message queue
+class TestNetwork {
+public:
+  TestNetwork(const std::vector<bool>& announce) {
+    for (size_t i = 0; i < announce.size(); ++i) {
+      nodes.emplace_back(new TestNode(*this, i, m_dispatcher, m_logger));
+    }
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      for (size_t j = 0; j < nodes.size(); ++j) {
+        if (i != j) {
+          CryptoNoteConnectionContext& context = nodes[i]->peers[j];
+          context.version = P2P_CURRENT_VERSION;
+          context.m_connection_id = connectionId(i, j);
+          context.m_state = CryptoNoteConnectionContext::state_normal;
+          context.m_support_flags = announce[i] && announce[j] ? P2P_SUPPORT_FLAG_TX_ANNOUNCE : 0;
+        }
+      }
+    }
+  }
+
+  void send(size_t from, size_t to, int command, const BinaryArray& buffer) {
+    m_messages.push_back(Message{ from, to, command, buffer });
+    bytes += buffer.size() + LevinProtocol::HEADER_SIZE;
+    ++messages[command];
+  }
+
+  // hands the transactions to the first node as if they came from a wallet connected to it
+  void submit(const std::vector<BinaryArray>& txs) {
+    NOTIFY_NEW_TRANSACTIONS::request req;
+    for (const auto& tx : txs) {
+      req.txs.push_back(common::asString(tx));
+    }
+
+    CryptoNoteConnectionContext outside;
+    outside.m_connection_id = connectionId(nodes.size(), 0);
+    outside.m_state = CryptoNoteConnectionContext::state_normal;
+    deliver(0, outside, NOTIFY_NEW_TRANSACTIONS::ID, LevinProtocol::encode(req));
+  }
+
+  void run() {
+    for (;;) {
+      while (!m_messages.empty()) {
+        Message message = std::move(m_messages.front());
+        m_messages.pop_front();
+        if (silent.count(message.to) != 0) {
+          continue;
+        }
+
+        deliver(message.to, nodes[message.to]->peers[message.from], message.command, message.buffer);
+      }
+
+      for (auto& node : nodes) {
+        node->handler.announceTransactions();
+      }
+
+      if (m_messages.empty()) {
+        break;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<TestNode>> nodes;
+  // nodes that receive nothing, so they never answer
+  std::set<size_t> silent;
+  size_t bytes = 0;
+  std::map<int, size_t> messages;
+
+private:
+  struct Message {
+    size_t from;
+    size_t to;
+    int command;
+    BinaryArray buffer;
+  };
+
+  void deliver(size_t to, CryptoNoteConnectionContext& context, int command, const BinaryArray& buffer) {
+    BinaryArray out;
+    bool handled = false;
+    nodes[to]->handler.handleCommand(true, command, buffer, out, context, handled);
+    ASSERT_TRUE(handled);
+  }
+
+  platform_system::Dispatcher m_dispatcher;
+  logging::LoggerGroup m_logger;
+  std::deque<Message> m_messages;
+};
+
+void TestEndpoint::relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) {
+  for (auto& peer : m_network.nodes[m_node]->peers) {
+    if (excludeConnection == nullptr || peer.second.m_connection_id != *excludeConnection) {
+      m_network.send(m_node, peer.first, command, data_buff);
+    }
+  }
+}
+
+bool TestEndpoint::invoke_notify_to_peer(int command, const BinaryArray& req_buff, const CryptoNoteConnectionContext& context) {
+  for (auto& peer : m_network.nodes[m_node]->peers) {
+    if (peer.second.m_connection_id == context.m_connection_id) {
+      m_network.send(m_node, peer.first, command, req_buff);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint64_t TestEndpoint::get_connections_count() {
+  return m_network.nodes[m_node]->peers.size();
+}
+
+void TestEndpoint::for_each_connection(const std::function<void(CryptoNoteConnectionContext&, PeerIdType)>& f) {
+  for (auto& peer : m_network.nodes[m_node]->peers) {
+    f(peer.second, peer.first + 1);
+  }
+}
+
+void TestEndpoint::externalRelayNotifyToList(int command, const BinaryArray& data_buff, const std::list<boost::uuids::uuid>& relayList) {
+  for (auto& peer : m_network.nodes[m_node]->peers) {
+    if (std::find(relayList.begin(), relayList.end(), peer.second.m_connection_id) != relayList.end()) {
+      m_network.send(m_node, peer.first, command, data_buff);
+    }
+  }
+}
+
+std::vector<BinaryArray> createTransactions(size_t count) {
+  std::mt19937 generator(7);
+  std::vector<BinaryArray> txs;
+  for (size_t i = 0; i < count; ++i) {
+    Transaction tx;
+    tx.version = 1;
+    tx.unlockTime = i;
+    tx.inputs.push_back(BaseInput{ static_cast<uint32_t>(i) });
+    tx.signatures.resize(1);
+    tx.extra.resize(TX_EXTRA_SIZE);
+    for (auto& byte : tx.extra) {
+      byte = static_cast<uint8_t>(generator());
+    }
+
+    txs.push_back(toBinaryArray(tx));
+  }
+
+  return txs;
+}
+
+size_t relayedBytes(const std::vector<bool>& announce) {
+  TestNetwork network(announce);
+  network.submit(createTransactions(TX_COUNT));
+  network.run();
+
+  for (auto& node : network.nodes) {
+    EXPECT_EQ(TX_COUNT, node->core.accepted);
+  }
+
+  return network.bytes;
+}
+
+}
+
+TEST(TxRelay, announcementsRelayFewerBytesPerTransaction) {
+  size_t legacyBytes = relayedBytes(std::vector<bool>(NODE_COUNT, false));
+  size_t announceBytes = relayedBytes(std::vector<bool>(NODE_COUNT, true));
+
+  ASSERT_LT(3 * announceBytes, legacyBytes);
+}
+
+TEST(TxRelay, mixedNetworkDeliversToLegacyPeers) {
+  std::vector<bool> announce(NODE_COUNT);
+  for (size_t i = 0; i < announce.size(); ++i) {
+    announce[i] = i % 2 == 0;
+  }
+
+  relayedBytes(announce);
+}
+
+TEST(TxRelay, requestsAnnouncedTransactionOnce) {
+  TestNetwork network({ true, true, true });
+  auto txs = createTransactions(1);
+  tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
+  network.nodes[0]->core.handle_incoming_tx(txs[0], tvc, false);
+  network.nodes[1]->core.handle_incoming_tx(txs[0], tvc, false);
+
+  // both peers announce the transaction, only the first one is asked for it
+  NOTIFY_TX_ANNOUNCE::request announcement;
+  announcement.txs.push_back(getBinaryArrayHash(txs[0]));
+  network.send(0, 2, NOTIFY_TX_ANNOUNCE::ID, LevinProtocol::encode(announcement));
+  network.send(1, 2, NOTIFY_TX_ANNOUNCE::ID, LevinProtocol::encode(announcement));
+  network.run();
+
+  ASSERT_EQ(1, network.nodes[2]->core.accepted);
+  ASSERT_EQ(1, network.messages[static_cast<int>(NOTIFY_REQUEST_TXS::ID)]);
+  ASSERT_EQ(1, network.messages[static_cast<int>(NOTIFY_NEW_TRANSACTIONS::ID)]);
+}
+
+TEST(TxRelay, requestsAnnouncedTransactionFromNextPeerWhenFirstIsSilent) {
+  TestNetwork network({ true, true, true });
+  auto txs = createTransactions(1);
+  tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
+  network.nodes[0]->core.handle_incoming_tx(txs[0], tvc, false);
+  network.nodes[1]->core.handle_incoming_tx(txs[0], tvc, false);
+  network.silent.insert(0);
+
+  NOTIFY_TX_ANNOUNCE::request announcement;
+  announcement.txs.push_back(getBinaryArrayHash(txs[0]));
+  network.send(0, 2, NOTIFY_TX_ANNOUNCE::ID, LevinProtocol::encode(announcement));
+  network.send(1, 2, NOTIFY_TX_ANNOUNCE::ID, LevinProtocol::encode(announcement));
+  network.run();
+  ASSERT_EQ(0, network.nodes[2]->core.accepted);
+  ASSERT_EQ(1, network.messages[static_cast<int>(NOTIFY_REQUEST_TXS::ID)]);
+
+  // once the request to the first announcer timed out the second one is asked
+  network.nodes[2]->handler.announceTransactions(std::chrono::steady_clock::now() + std::chrono::seconds(P2P_TX_REQUEST_TIMEOUT));
+  network.run();
+  ASSERT_EQ(1, network.nodes[2]->core.accepted);
+  ASSERT_EQ(2, network.messages[static_cast<int>(NOTIFY_REQUEST_TXS::ID)]);
+}
+
+TEST(TxRelay, dropsAnnouncementsOverRequestLimitOfPeer) {
+  TestNetwork network({ true, true, true });
+  // the announcers never answer, so every request stays awaited
+  network.silent.insert(0);
+  network.silent.insert(1);
+
+  size_t next = 0;
+  auto announce = [&](size_t from) {
+    NOTIFY_TX_ANNOUNCE::request announcement;
+    for (size_t i = 0; i < P2P_TX_ANNOUNCE_MAX_COUNT; ++i, ++next) {
+      crypto::Hash hash = crypto::Hash();
+      std::memcpy(hash.data, &next, sizeof(next));
+      announcement.txs.push_back(hash);
+    }
+
+    network.send(from, 2, NOTIFY_TX_ANNOUNCE::ID, LevinProtocol::encode(announcement));
+    network.run();
+  };
+
+  for (size_t i = 0; i < P2P_TX_REQUEST_MAX_COUNT_PER_PEER / P2P_TX_ANNOUNCE_MAX_COUNT; ++i) {
+    announce(0);
+  }
+  ASSERT_EQ(P2P_TX_REQUEST_MAX_COUNT_PER_PEER / P2P_TX_ANNOUNCE_MAX_COUNT, network.messages[static_cast<int>(NOTIFY_REQUEST_TXS::ID)]);
+
+  // nothing more is requested from the peer, another peer is still asked
+  announce(0);
+  ASSERT_EQ(P2P_TX_REQUEST_MAX_COUNT_PER_PEER / P2P_TX_ANNOUNCE_MAX_COUNT, network.messages[static_cast<int>(NOTIFY_REQUEST_TXS::ID)]);
+  announce(1);
+  ASSERT_EQ(P2P_TX_REQUEST_MAX_COUNT_PER_PEER / P2P_TX_ANNOUNCE_MAX_COUNT + 1, network.messages[static_cast<int>(NOTIFY_REQUEST_TXS::ID)]);
+
+  // the requests of the silent peer time out and free its share
+  network.nodes[2]->handler.announceTransactions(std::chrono::steady_clock::now() + std::chrono::seconds(P2P_TX_REQUEST_TIMEOUT));
+  announce(0);
+  ASSERT_EQ(P2P_TX_REQUEST_MAX_COUNT_PER_PEER / P2P_TX_ANNOUNCE_MAX_COUNT + 2, network.messages[static_cast<int>(NOTIFY_REQUEST_TXS::ID)]);
+}
@@ -375,6 +375,53 @@ TEST_F(tx_pool, fillblock_same_size)
 }
 
 
+TEST_F(tx_pool, fillblock_follows_pool_changes)
+{
+  TestPool<TransactionValidator, RealTimeProvider> pool(currency, logger);
+  const uint64_t fee = currency.minimumFee();
+
+  Transaction first;
+  GenerateTransaction(currency, first, fee, 1);
+  tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
+  ASSERT_TRUE(pool.add_tx(first, tvc, false, 0));
+
+  Block bl;
+  InitBlock(bl);
+
+  size_t totalSize = 0;
+  uint64_t txFee = 0;
+  uint64_t median = 5000;
+  uint32_t height = 0;
+  ASSERT_TRUE(pool.fill_block_template(bl, median, textMaxCumulativeSize, 0, totalSize, txFee, height));
+  ASSERT_EQ(1, bl.transactionHashes.size());
+
+  // a transaction added on the same tail joins the next template
+  Transaction second;
+  GenerateTransaction(currency, second, fee * 2, 1);
+  tvc = boost::value_initialized<tx_verification_context>();
+  ASSERT_TRUE(pool.add_tx(second, tvc, false, 0));
+
+  ASSERT_TRUE(pool.fill_block_template(bl, median, textMaxCumulativeSize, 0, totalSize, txFee, height));
+  ASSERT_EQ(2, bl.transactionHashes.size());
+  ASSERT_EQ(fee * 3, txFee);
+
+  // and a taken one leaves it
+  Transaction txOut;
+  size_t blobSize;
+  uint64_t takenFee;
+  ASSERT_TRUE(pool.take_tx(getObjectHash(first), txOut, blobSize, takenFee));
+
+  ASSERT_TRUE(pool.fill_block_template(bl, median, textMaxCumulativeSize, 0, totalSize, txFee, height));
+  ASSERT_EQ(1, bl.transactionHashes.size());
+  ASSERT_EQ(getObjectHash(second), bl.transactionHashes.front());
+
+  // a new tail rebuilds the ready set
+  pool.on_blockchain_inc(1, getObjectHash(bl));
+  bl.previousBlockHash = getObjectHash(bl);
+  ASSERT_TRUE(pool.fill_block_template(bl, median, textMaxCumulativeSize, 0, totalSize, txFee, height));
+  ASSERT_EQ(1, bl.transactionHashes.size());
+}
+
 TEST_F(tx_pool, cleanup_stale_tx)
 {
   TestPool<TransactionValidator, FakeTimeProvider> pool(currency, logger);
@@ -0,0 +1,54 @@
+// Copyright (c) 2018-2023 Conceal Network & Conceal Devs
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/WorkerPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(WorkerPool, runsEveryJobOnce) {
+  tools::WorkerPool pool(3);
+  std::vector<std::atomic<int>> calls(1000);
+  for (auto& c : calls) {
+    c = 0;
+  }
+
+  pool.parallelFor(calls.size(), [&calls](size_t i) { ++calls[i]; });
+
+  for (auto& c : calls) {
+    ASSERT_EQ(1, c.load());
+  }
+}
+
+TEST(WorkerPool, runsOnCallerWithoutWorkers) {
+  tools::WorkerPool pool(0);
+  size_t sum = 0;
+  pool.parallelFor(10, [&sum](size_t i) { sum += i; });
+  ASSERT_EQ(45, sum);
+}
+
+TEST(WorkerPool, isReusableAfterBatch) {
+  tools::WorkerPool pool(2);
+  std::atomic<size_t> sum(0);
+  for (size_t batch = 0; batch < 100; ++batch) {
+    pool.parallelFor(10, [&sum](size_t i) { sum += i; });
+  }
+
+  ASSERT_EQ(4500, sum.load());
+}
+
+TEST(WorkerPool, rethrowsJobException) {
+  tools::WorkerPool pool(2);
+  std::atomic<size_t> calls(0);
+  ASSERT_THROW(pool.parallelFor(50, [&calls](size_t i) {
+    ++calls;
+    if (i == 7) {
+      throw std::runtime_error("job failed");
+    }
+  }), std::runtime_error);
+
+  ASSERT_EQ(50, calls.load());
+}